@@ -1,14 +1,16 @@
 #include "camera.h"
 
-#include <openxr/openxr.h>
-
 #include "ARBlueprintLibrary.h"
 #include "ARPin.h"
 
-#include "MicrosoftOpenXR.h"
-
 #include "util.h"
 
+#if (PLATFORMS)
+
+#include <openxr/openxr.h>
+
+#include "MicrosoftOpenXR.h"
+
 /**
  * @struct SAnchorMSFT
  * structure exposing the openxr anchor
@@ -20,6 +22,8 @@ struct SAnchorMSFT
     XrSpace Space;
 };
 
+#endif
+
 #if (PLATFORM_HOLOLENS)
 extern "C"
 WINBASEAPI
@@ -53,6 +57,9 @@ void A_camera::Tick(float DeltaSeconds)
 
 void A_camera::BeginDestroy()
 {
+    stop_replay();
+    recorder.close();
+
 #if (PLATFORMS)
 #if (!PLATFORM_HOLOLENS && !defined(__PARSER__))
     Super::BeginDestroy();
@@ -67,12 +74,13 @@ void A_camera::BeginDestroy()
      */
     auto old_state = state.exchange(camera_state::TERMINATED);
     consent_cv.notify_all();
-    cv.notify_all();
+    pcl_queue.close();
+    raw_queue.close();
     if (worker_thread)
 		worker_thread->join();
+#endif
 	
     Super::BeginDestroy();
-#endif
 }
 
 F_located_point_cloud A_camera::get_u_pcl(int64 max_timestamp)
@@ -83,47 +91,224 @@ F_located_point_cloud A_camera::get_u_pcl(int64 max_timestamp)
     return temp.GetValue();
 }
 
-TOptional<F_located_point_cloud> A_camera::get_pcl(UINT64 max_timestamp)
+F_located_point_cloud A_camera::get_u_pcl_points(TArray<FVector>& points, int64 max_timestamp)
 {
-#if (PLATFORMS)
+    F_located_point_cloud out = get_u_pcl(max_timestamp);
+    points = out.point_cloud.points.to_array();
+    return out;
+}
 
-    std::unique_ptr<std::unique_lock<std::mutex>> lock;
-    if (thread_type == threading::MULTIPLE_CONSUMERS)
-        lock = std::make_unique<std::unique_lock<std::mutex>>(consumer_mutex);
-	
+F_point_buffer_metrics A_camera::get_point_buffer_metrics()
+{
+    const point_buffer_stats stats = point_buffer_pool::get().stats();
+
+    F_point_buffer_metrics out;
+    out.allocations = static_cast<int64>(stats.allocations);
+    out.reuses = static_cast<int64>(stats.reuses);
+    out.bytes_in_use = static_cast<int64>(stats.bytes_in_use);
+    out.bytes_pooled = static_cast<int64>(stats.bytes_pooled);
+    out.last_frame_allocated = last_frame_allocated.load(std::memory_order_relaxed);
+    out.last_frame_bytes = last_frame_bytes.load(std::memory_order_relaxed);
+    return out;
+}
+
+TOptional<F_located_point_cloud> A_camera::get_pcl(uint64 max_timestamp)
+{
     F_located_point_cloud out;
-    if (pcl_queue.Dequeue(out))
-    {
-        cv.notify_all();
+    if (pcl_queue.try_dequeue(out))
+        return out;
+    return TOptional<F_located_point_cloud>();
+}
+
+TOptional<F_located_point_cloud> A_camera::wait_pcl(std::chrono::milliseconds timeout)
+{
+    F_located_point_cloud out;
+    if (pcl_queue.wait_dequeue_for(out, timeout))
         return out;
-    }
-#endif
     return TOptional<F_located_point_cloud>();
 }
 
+void A_camera::set_capture_mode(capture_mode mode)
+{
+    capture = mode;
+}
+
+TOptional<raw_depth_frame> A_camera::wait_depth_frame(std::chrono::milliseconds timeout)
+{
+    raw_depth_frame out;
+    if (raw_queue.wait_dequeue_for(out, timeout))
+        return out;
+    return TOptional<raw_depth_frame>();
+}
+
+std::shared_ptr<const depth_unprojection> A_camera::get_unprojection() const
+{
+    std::unique_lock lock(calibration_mtx);
+    return unprojection;
+}
+
+size_t A_camera::get_queue_depth() const
+{
+    return capture == capture_mode::RAW_DEPTH ? raw_queue.size_approx() : pcl_queue.size_approx();
+}
+
+uint64_t A_camera::get_dropped_frames() const
+{
+    return dropped_frames.load(std::memory_order_relaxed);
+}
+
 void A_camera::clear_queue()
 {
-#if (PLATFORMS)
-    std::unique_ptr<std::unique_lock<std::mutex>> lock;
-    if (thread_type == threading::MULTIPLE_CONSUMERS)
-        lock = std::make_unique<std::unique_lock<std::mutex>>(consumer_mutex);
-	
-    pcl_queue.Empty();
-    cv.notify_all();
-#endif
+    pcl_queue.clear();
+    raw_queue.clear();
 }
 
 FTransform A_camera::get_camera_view_matrix() const
 {
-#if (PLATFORMS)
-    
+    std::unique_lock lock(calibration_mtx);
     return camera_view_matrix;
+}
+
+bool A_camera::start_recording(const FString& path)
+{
+    return recorder.open(path);
+}
+
+void A_camera::stop_recording()
+{
+    recorder.close();
+}
 
-#else
+bool A_camera::start_replay(const FString& path, float rate, bool loop)
+{
+    stop_replay();
 
-    return FMatrix();
+    auto replay = std::make_unique<depth_replay>();
+    if (!replay->open(path) || replay->frame_count() == 0)
+        return false;
 
-#endif
+    replaying = true;
+    replay_thread = std::make_unique<std::thread>(&A_camera::replay_worker, this, std::move(replay), rate, loop);
+    return true;
+}
+
+bool A_camera::is_replaying() const
+{
+    return replaying;
+}
+
+void A_camera::stop_replay()
+{
+    {
+        std::unique_lock lock(replay_mtx);
+        replaying = false;
+    }
+    replay_cv.notify_all();
+
+    if (replay_thread)
+        replay_thread->join();
+    replay_thread.reset();
+}
+
+void A_camera::replay_worker(std::unique_ptr<depth_replay> replay, float rate, bool loop)
+{
+    do
+    {
+        const auto start = std::chrono::steady_clock::now();
+        const int64 first_timestamp = replay->frame(0).abs_timestamp;
+
+        for (size_t i = 0; i < replay->frame_count() && replaying; ++i)
+        {
+            const depth_frame_view frame = replay->frame(i);
+
+            /**
+             * timestamps are in 100 ns
+             */
+            if (rate > 0.f)
+            {
+                const auto offset = std::chrono::nanoseconds(
+                    static_cast<int64>((frame.abs_timestamp - first_timestamp) * 100. / rate));
+
+                std::unique_lock lock(replay_mtx);
+                if (replay_cv.wait_until(lock, start + offset, [this]() { return !replaying; }))
+                    break;
+            }
+
+            {
+                std::unique_lock lock(calibration_mtx);
+                unprojection = replay->rays(i);
+                camera_view_matrix = replay->camera_view(i);
+            }
+
+            deliver(frame, rate <= 0.f);
+        }
+    } while (loop && replaying);
+
+    replaying = false;
+}
+
+void A_camera::deliver(const depth_frame_view& frame, bool wait)
+{
+    const auto rays = get_unprojection();
+    if (!rays || !rays->matches(frame.width, frame.height))
+        return;
+
+    if (recorder.is_open())
+        recorder.write(frame, rays, get_camera_view_matrix());
+
+    const int32 count = static_cast<int32>(rays->pixel_count());
+
+    if (capture == capture_mode::RAW_DEPTH)
+    {
+        raw_depth_frame raw;
+        raw.depth = TArray<uint16>(frame.depth, count);
+        raw.sigma = TArray<uint8>(frame.sigma, count);
+        raw.width = frame.width;
+        raw.height = frame.height;
+        raw.location = frame.location;
+        raw.abs_timestamp = frame.abs_timestamp;
+
+        push(raw_queue, std::move(raw), wait);
+        return;
+    }
+
+    F_located_point_cloud pcl;
+    pcl.location = frame.location;
+    pcl.point_cloud.abs_timestamp = frame.abs_timestamp;
+
+    /**
+     * invalid pixels are overwritten in place, so size
+     * for all pixels and cut off afterwards
+     */
+    point_buffer& points = pcl.point_cloud.points;
+    points.set_num(count);
+    points.set_num(static_cast<int32>(rays->unproject(frame.depth, frame.sigma, points.x(), points.y(), points.z())));
+
+    last_frame_allocated.store(static_cast<int64>(points.allocated_size()), std::memory_order_relaxed);
+    last_frame_bytes.store(static_cast<int64>(points.Num()) * 3 * sizeof(float), std::memory_order_relaxed);
+
+    push(pcl_queue, std::move(pcl), wait);
+}
+
+template<typename T>
+void A_camera::push(bounded_queue<T>& queue, T&& value, bool wait)
+{
+    if (wait)
+    {
+        while (replaying && !queue.wait_enqueue_for(std::move(value), std::chrono::milliseconds(100)))
+        {}
+        return;
+    }
+
+    /**
+     * put frame into queue if possible
+     * otherwise drop it and wait for a consumer
+     */
+    if (!queue.try_enqueue(std::move(value)))
+    {
+        dropped_frames.fetch_add(1, std::memory_order_relaxed);
+        queue.wait_not_full_for(std::chrono::milliseconds(100));
+    }
 }
 
 bool A_camera::is_supported()
@@ -326,80 +511,58 @@ void A_camera::worker()
         if (!location)
             continue;
 
-        F_located_point_cloud pcl;
-    	
-        pcl.point_cloud.abs_timestamp = 
-            winrt::clock::to_file_time(timestamp.TargetTime()).value;
-        pcl.location = convert<FTransform>(location);
-
         winrt::com_ptr<IResearchModeSensorDepthFrame> depth_frame;
         sensor_frame->QueryInterface(IID_PPV_ARGS(depth_frame.put()));
 
-        /**
-         * put processed point cloud into queue if possible
-         */
-        pcl.point_cloud.data = process(depth_frame);
-        if (!pcl_queue.Enqueue(std::move(pcl)))
-        {
-            std::unique_lock lock(mutex);
-            cv.wait(lock);
-        }
+        const BYTE* sigma;
+        const UINT16* depth;
+
+        size_t depth_count = 0;
+        size_t sigma_count = 0;
+
+        //depth data
+        depth_frame->GetBuffer(&depth, &depth_count);
+        //validity data
+        depth_frame->GetSigmaBuffer(&sigma, &sigma_count);
+
+        update_unprojection();
+
+        const size_t pixel_count = static_cast<size_t>(resolution.Width) * resolution.Height;
+        if (depth_count < pixel_count || sigma_count < pixel_count)
+            continue;
+
+        depth_frame_view frame;
+        frame.depth = depth;
+        frame.sigma = sigma;
+        frame.width = resolution.Width;
+        frame.height = resolution.Height;
+        frame.location = convert<FTransform>(location);
+        frame.abs_timestamp = winrt::clock::to_file_time(timestamp.TargetTime()).value;
+
+        deliver(frame, false);
 	}
     lt_sensor->CloseStream();
 }
 
-TArray<FVector> A_camera::process(
-    const winrt::com_ptr<IResearchModeSensorDepthFrame>& depth_frame) const
+void A_camera::update_unprojection()
 {
-    TArray<FVector> out;
-	
-    const BYTE* sigma;
-    const UINT16* depth;
-
-    size_t out_buffer_count = 0;
-
-    //depth data
-    depth_frame->GetBuffer(&depth, &out_buffer_count);
-    //validity data
-    depth_frame->GetSigmaBuffer(&sigma, &out_buffer_count);
-
     /**
-     * reserve only memory for valid points
+     * the sensor maps pixels to rays through a COM call,
+     * do that once per resolution instead of per pixel and frame
      */
-    size_t needed_size = out_buffer_count;
-    for (size_t i = 0; i < out_buffer_count; ++i)
-    {
-        if (sigma[i] & 0x80)
-            --needed_size;
-    }
+    if (const auto current = get_unprojection(); current && current->matches(resolution.Width, resolution.Height))
+        return;
 
-    out.Reserve(needed_size);
-    
-    for (UINT i = 0, index = 0; i < resolution.Height; ++i)
-    {
-        float uv[2];
-        uv[1] = i;// + 0.5f;
-        for (UINT j = 0; j < resolution.Width; ++j, ++index)
+    auto rays = std::make_shared<const depth_unprojection>(resolution.Width, resolution.Height,
+        [this](float (&uv)[2], float (&xy)[2])
         {
-            uv[0] = j;// + 0.5f;
-            //float uv[2] = { static_cast<float>(i), static_cast<float>(j) };
-
-            if (sigma[index] & 0x80)
-                continue;
-
-            float xy[2];
-            if (FAILED(lt_camera_sensor->MapImagePointToCameraUnitPlane(uv, xy)))
-                continue;
-        	
-            auto vertex = FVector(xy[0], xy[1], 1.f);
-            vertex.Normalize();
-            //depth[index] is in mm
-            vertex *= (static_cast<float>(depth[index]) / 10.f);
-        	
-            out.Add(FVector(-vertex.Z, vertex.X, vertex.Y));
-        }
-    }
-    return out;
+            return SUCCEEDED(lt_camera_sensor->MapImagePointToCameraUnitPlane(uv, xy));
+        },
+        //depth is in mm
+        0.1f);
+
+    std::unique_lock lock(calibration_mtx);
+    unprojection = std::move(rays);
 }
 
 void A_camera::on_cam_access_complete(ResearchModeSensorConsent consent)
@@ -0,0 +1,266 @@
+#include "depth_recording.h"
+
+#include "HAL/PlatformFileManager.h"
+#include "Async/MappedFileHandle.h"
+
+#include <cstring>
+
+namespace
+{
+    constexpr size_t alignment = 8;
+
+    size_t padded(size_t size)
+    {
+        return (size + alignment - 1) & ~(alignment - 1);
+    }
+
+    void write_matrix(const FTransform& in, double (&out)[16])
+    {
+        const FMatrix m = in.ToMatrixWithScale();
+        for (int32 row = 0; row < 4; ++row)
+            for (int32 col = 0; col < 4; ++col)
+                out[row * 4 + col] = m.M[row][col];
+    }
+
+    FTransform read_matrix(const uint8* in)
+    {
+        double values[16];
+        std::memcpy(values, in, sizeof(values));
+
+        FMatrix m;
+        for (int32 row = 0; row < 4; ++row)
+            for (int32 col = 0; col < 4; ++col)
+                m.M[row][col] = values[row * 4 + col];
+        return FTransform(m);
+    }
+
+    /**
+     * fixed part of the payloads
+     */
+    constexpr size_t rays_header = 2 * sizeof(uint32) + 16 * sizeof(double);
+    constexpr size_t frame_header = sizeof(int64) + 16 * sizeof(double) + 2 * sizeof(uint32);
+}
+
+depth_recorder::~depth_recorder()
+{
+    close();
+}
+
+bool depth_recorder::open(const FString& path)
+{
+    std::unique_lock lock(mtx);
+
+    file.reset(FPlatformFileManager::Get().GetPlatformFile().OpenWrite(*path));
+    written_rays.reset();
+    if (!file)
+        return false;
+
+    const uint32 header[2] = { depth_recording::magic, depth_recording::version };
+    if (!file->Write(reinterpret_cast<const uint8*>(header), sizeof(header)))
+    {
+        file.reset();
+        return false;
+    }
+    return true;
+}
+
+void depth_recorder::close()
+{
+    std::unique_lock lock(mtx);
+    if (file)
+        file->Flush();
+    file.reset();
+    written_rays.reset();
+}
+
+bool depth_recorder::is_open() const
+{
+    std::unique_lock lock(mtx);
+    return file != nullptr;
+}
+
+bool depth_recorder::write(const depth_frame_view& frame,
+    const std::shared_ptr<const depth_unprojection>& rays, const FTransform& camera_view)
+{
+    std::unique_lock lock(mtx);
+    if (!file || !rays || !rays->matches(frame.width, frame.height))
+        return false;
+
+    const size_t count = static_cast<size_t>(frame.width) * frame.height;
+
+    if (rays != written_rays)
+    {
+        const uint32 size[2] = { frame.width, frame.height };
+        double view[16];
+        write_matrix(camera_view, view);
+
+        if (!write_chunk(depth_recording::rays_tag, {
+            { size, sizeof(size) },
+            { view, sizeof(view) },
+            { rays->ray(0).data(), count * sizeof(float) },
+            { rays->ray(1).data(), count * sizeof(float) },
+            { rays->ray(2).data(), count * sizeof(float) } }))
+            return false;
+
+        written_rays = rays;
+    }
+
+    double location[16];
+    write_matrix(frame.location, location);
+    const uint32 size[2] = { frame.width, frame.height };
+
+    return write_chunk(depth_recording::frame_tag, {
+        { &frame.abs_timestamp, sizeof(int64) },
+        { location, sizeof(location) },
+        { size, sizeof(size) },
+        { frame.depth, count * sizeof(uint16) },
+        { frame.sigma, count * sizeof(uint8) } });
+}
+
+bool depth_recorder::write_chunk(uint32 tag, std::initializer_list<std::pair<const void*, size_t>> parts)
+{
+    size_t size = 0;
+    for (const auto& [data, bytes] : parts)
+        size += bytes;
+
+    const uint32 header[2] = { tag, static_cast<uint32>(size) };
+    if (!file->Write(reinterpret_cast<const uint8*>(header), sizeof(header)))
+        return false;
+
+    for (const auto& [data, bytes] : parts)
+        if (!file->Write(static_cast<const uint8*>(data), bytes))
+            return false;
+
+    static constexpr uint8 zeros[alignment] = {};
+    return file->Write(zeros, padded(size) - size);
+}
+
+depth_replay::depth_replay() = default;
+
+depth_replay::~depth_replay()
+{
+    close();
+}
+
+bool depth_replay::open(const FString& path)
+{
+    close();
+
+    handle.reset(FPlatformFileManager::Get().GetPlatformFile().OpenMapped(*path));
+    if (!handle)
+        return false;
+
+    const int64 file_size = handle->GetFileSize();
+    if (file_size < 8)
+    {
+        close();
+        return false;
+    }
+
+    region.reset(handle->MapRegion(0, file_size));
+    if (!region)
+    {
+        close();
+        return false;
+    }
+
+    const uint8* data = region->GetMappedPtr();
+    const size_t size = static_cast<size_t>(region->GetMappedSize());
+
+    uint32 header[2];
+    std::memcpy(header, data, sizeof(header));
+    if (header[0] != depth_recording::magic || header[1] != depth_recording::version)
+    {
+        close();
+        return false;
+    }
+
+    for (size_t offset = sizeof(header); offset + sizeof(header) <= size;)
+    {
+        uint32 chunk[2];
+        std::memcpy(chunk, data + offset, sizeof(chunk));
+
+        const uint8* payload = data + offset + sizeof(chunk);
+        const size_t payload_size = chunk[1];
+        if (offset + sizeof(chunk) + payload_size > size)
+            break;
+
+        offset += sizeof(chunk) + padded(payload_size);
+
+        if (chunk[0] == depth_recording::rays_tag && payload_size >= rays_header)
+        {
+            uint32 resolution[2];
+            std::memcpy(resolution, payload, sizeof(resolution));
+
+            const size_t count = static_cast<size_t>(resolution[0]) * resolution[1];
+            if (payload_size < rays_header + 3 * count * sizeof(float))
+                continue;
+
+            std::vector<float> axes[3];
+            for (size_t axis = 0; axis < 3; ++axis)
+            {
+                axes[axis].resize(count);
+                std::memcpy(axes[axis].data(), payload + rays_header + axis * count * sizeof(float), count * sizeof(float));
+            }
+
+            ray_entries.push_back({
+                std::make_shared<const depth_unprojection>(resolution[0], resolution[1],
+                    std::move(axes[0]), std::move(axes[1]), std::move(axes[2])),
+                read_matrix(payload + sizeof(resolution)) });
+        }
+        else if (chunk[0] == depth_recording::frame_tag && payload_size >= frame_header && !ray_entries.empty())
+        {
+            uint32 resolution[2];
+            std::memcpy(resolution, payload + frame_header - sizeof(resolution), sizeof(resolution));
+
+            const size_t count = static_cast<size_t>(resolution[0]) * resolution[1];
+            if (payload_size < frame_header + count * (sizeof(uint16) + sizeof(uint8)) ||
+                !ray_entries.back().rays->matches(resolution[0], resolution[1]))
+                continue;
+
+            frames.push_back({ payload, ray_entries.size() - 1 });
+        }
+    }
+    return true;
+}
+
+void depth_replay::close()
+{
+    frames.clear();
+    ray_entries.clear();
+    region.reset();
+    handle.reset();
+}
+
+size_t depth_replay::frame_count() const
+{
+    return frames.size();
+}
+
+depth_frame_view depth_replay::frame(size_t index) const
+{
+    const uint8* payload = frames[index].payload;
+
+    depth_frame_view out;
+    std::memcpy(&out.abs_timestamp, payload, sizeof(int64));
+    out.location = read_matrix(payload + sizeof(int64));
+    std::memcpy(&out.width, payload + frame_header - 2 * sizeof(uint32), sizeof(uint32));
+    std::memcpy(&out.height, payload + frame_header - sizeof(uint32), sizeof(uint32));
+
+    /**
+     * chunks are 8 byte aligned, so is the depth
+     */
+    out.depth = reinterpret_cast<const uint16*>(payload + frame_header);
+    out.sigma = payload + frame_header + static_cast<size_t>(out.width) * out.height * sizeof(uint16);
+    return out;
+}
+
+const std::shared_ptr<const depth_unprojection>& depth_replay::rays(size_t index) const
+{
+    return ray_entries[frames[index].rays].rays;
+}
+
+FTransform depth_replay::camera_view(size_t index) const
+{
+    return ray_entries[frames[index].rays].camera_view;
+}
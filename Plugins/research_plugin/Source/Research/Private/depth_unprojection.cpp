@@ -0,0 +1,72 @@
+#include "depth_unprojection.h"
+
+#include <cmath>
+
+depth_unprojection::depth_unprojection(uint32_t width, uint32_t height,
+    const unit_plane_mapping& map_to_unit_plane, float depth_scale)
+    : width(width), height(height)
+{
+    const size_t count = static_cast<size_t>(width) * height;
+    for (auto& axis : rays)
+        axis.assign(count, 0.f);
+    valid.assign(count, 0);
+
+    for (uint32_t i = 0, index = 0; i < height; ++i)
+    {
+        for (uint32_t j = 0; j < width; ++j, ++index)
+        {
+            float uv[2] = { static_cast<float>(j), static_cast<float>(i) };
+            float xy[2];
+            if (!map_to_unit_plane(uv, xy))
+                continue;
+
+            /**
+             * normalized (x, y, 1) of the sensor
+             * is (-z, x, y) in unreal
+             */
+            const float scale = depth_scale / std::sqrt(xy[0] * xy[0] + xy[1] * xy[1] + 1.f);
+            rays[0][index] = -scale;
+            rays[1][index] = xy[0] * scale;
+            rays[2][index] = xy[1] * scale;
+            valid[index] = 1;
+        }
+    }
+}
+
+depth_unprojection::depth_unprojection(uint32_t width, uint32_t height,
+    std::vector<float> ray_x, std::vector<float> ray_y, std::vector<float> ray_z)
+    : width(width), height(height), rays{ std::move(ray_x), std::move(ray_y), std::move(ray_z) }
+{
+    const size_t count = static_cast<size_t>(width) * height;
+    for (auto& axis : rays)
+        axis.resize(count, 0.f);
+
+    valid.resize(count);
+    for (size_t i = 0; i < count; ++i)
+        valid[i] = rays[0][i] != 0.f || rays[1][i] != 0.f || rays[2][i] != 0.f;
+}
+
+bool depth_unprojection::matches(uint32_t width, uint32_t height) const
+{
+    return this->width == width && this->height == height;
+}
+
+size_t depth_unprojection::pixel_count() const
+{
+    return valid.size();
+}
+
+uint32_t depth_unprojection::get_width() const
+{
+    return width;
+}
+
+uint32_t depth_unprojection::get_height() const
+{
+    return height;
+}
+
+const std::vector<float>& depth_unprojection::ray(size_t axis) const
+{
+    return rays[axis];
+}
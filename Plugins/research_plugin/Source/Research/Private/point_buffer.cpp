@@ -0,0 +1,178 @@
+#include "point_buffer.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace
+{
+    /**
+     * axes start on cache lines
+     */
+    constexpr int32 capacity_granularity = 16;
+    constexpr size_t storage_alignment = 64;
+}
+
+point_buffer_pool& point_buffer_pool::get()
+{
+    static point_buffer_pool pool;
+    return pool;
+}
+
+float* point_buffer_pool::acquire(int32& capacity)
+{
+    capacity = std::max(Align(capacity, capacity_granularity), capacity_granularity);
+    const size_t bytes = 3 * sizeof(float) * static_cast<size_t>(capacity);
+
+    {
+        std::unique_lock lock(mtx);
+
+        /**
+         * smallest pooled storage which suffices
+         */
+        auto best = free.end();
+        for (auto it = free.begin(); it != free.end(); ++it)
+            if (it->second >= capacity && (best == free.end() || it->second < best->second))
+                best = it;
+
+        if (best != free.end())
+        {
+            float* storage = best->first;
+            capacity = best->second;
+            *best = free.back();
+            free.pop_back();
+
+            const size_t reused = 3 * sizeof(float) * static_cast<size_t>(capacity);
+            ++counters.reuses;
+            counters.bytes_pooled -= reused;
+            counters.bytes_in_use += reused;
+            return storage;
+        }
+
+        ++counters.allocations;
+        counters.bytes_in_use += bytes;
+    }
+
+    return static_cast<float*>(FMemory::Malloc(bytes, storage_alignment));
+}
+
+void point_buffer_pool::release(float* storage, int32 capacity)
+{
+    const size_t bytes = 3 * sizeof(float) * static_cast<size_t>(capacity);
+
+    {
+        std::unique_lock lock(mtx);
+        counters.bytes_in_use -= bytes;
+
+        if (free.size() < max_pooled)
+        {
+            free.emplace_back(storage, capacity);
+            counters.bytes_pooled += bytes;
+            return;
+        }
+    }
+
+    FMemory::Free(storage);
+}
+
+point_buffer_stats point_buffer_pool::stats() const
+{
+    std::unique_lock lock(mtx);
+    return counters;
+}
+
+point_buffer::~point_buffer()
+{
+    release();
+}
+
+point_buffer::point_buffer(const point_buffer& other)
+{
+    *this = other;
+}
+
+point_buffer& point_buffer::operator=(const point_buffer& other)
+{
+    if (this == &other)
+        return *this;
+
+    set_num(other.count);
+    std::memcpy(x(), other.x(), count * sizeof(float));
+    std::memcpy(y(), other.y(), count * sizeof(float));
+    std::memcpy(z(), other.z(), count * sizeof(float));
+    return *this;
+}
+
+point_buffer::point_buffer(point_buffer&& other) noexcept
+    : storage(other.storage), capacity(other.capacity), count(other.count)
+{
+    other.storage = nullptr;
+    other.capacity = 0;
+    other.count = 0;
+}
+
+point_buffer& point_buffer::operator=(point_buffer&& other) noexcept
+{
+    if (this == &other)
+        return *this;
+
+    release();
+    std::swap(storage, other.storage);
+    std::swap(capacity, other.capacity);
+    std::swap(count, other.count);
+    return *this;
+}
+
+void point_buffer::reserve(int32 num)
+{
+    if (num <= capacity)
+        return;
+
+    release();
+    storage = point_buffer_pool::get().acquire(num);
+    capacity = num;
+}
+
+void point_buffer::set_num(int32 num)
+{
+    reserve(num);
+    count = num;
+}
+
+void point_buffer::append(const TArray<FVector>& points)
+{
+    /**
+     * growing drops the points, so keep them aside
+     */
+    if (count + points.Num() > capacity)
+    {
+        point_buffer grown;
+        grown.set_num(count + points.Num());
+        std::memcpy(grown.x(), x(), count * sizeof(float));
+        std::memcpy(grown.y(), y(), count * sizeof(float));
+        std::memcpy(grown.z(), z(), count * sizeof(float));
+        grown.count = count;
+        *this = std::move(grown);
+    }
+
+    for (const FVector& p : points)
+        set(count++, p);
+}
+
+TArray<FVector> point_buffer::to_array() const
+{
+    TArray<FVector> out;
+    out.SetNumUninitialized(count);
+    for (int32 i = 0; i < count; ++i)
+        out[i] = get(i);
+    return out;
+}
+
+void point_buffer::release()
+{
+    if (storage)
+        point_buffer_pool::get().release(storage, capacity);
+
+    storage = nullptr;
+    capacity = 0;
+    count = 0;
+}
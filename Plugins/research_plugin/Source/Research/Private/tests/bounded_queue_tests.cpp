@@ -0,0 +1,218 @@
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+#include "bounded_queue.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    typedef std::chrono::steady_clock steady;
+
+    constexpr size_t capacity = 4;
+
+    /**
+     * the queue the camera used before, a deque behind a mutex
+     * and a condition variable notified on every push
+     */
+    class locked_queue final
+    {
+    public:
+
+        bool try_enqueue(steady::time_point value)
+        {
+            {
+                std::unique_lock lock(mtx);
+                if (queue.size() >= capacity)
+                    return false;
+                queue.push_back(value);
+            }
+            cv.notify_one();
+            return true;
+        }
+
+        template<typename Rep, typename Period>
+        bool wait_dequeue_for(steady::time_point& out, const std::chrono::duration<Rep, Period>& timeout)
+        {
+            std::unique_lock lock(mtx);
+            if (!cv.wait_for(lock, timeout, [this]() { return !queue.empty(); }))
+                return false;
+            out = queue.front();
+            queue.pop_front();
+            return true;
+        }
+
+    private:
+
+        std::mutex mtx;
+        std::condition_variable cv;
+        std::deque<steady::time_point> queue;
+    };
+
+    struct handoff_result
+    {
+        double mean_us = 0.;
+        double p99_us = 0.;
+        size_t received = 0;
+        size_t dropped = 0;
+    };
+
+    /**
+     * one producer enqueues its send time every period,
+     * one blocked consumer records how late it got it
+     */
+    template<typename Queue>
+    handoff_result measure(Queue& queue, size_t count, std::chrono::microseconds period)
+    {
+        std::vector<double> latencies;
+        latencies.reserve(count);
+
+        std::atomic_bool produced = false;
+        std::thread consumer([&]()
+            {
+                steady::time_point sent;
+                for (;;)
+                {
+                    const bool last = produced.load();
+                    if (queue.wait_dequeue_for(sent, std::chrono::milliseconds(10)))
+                        latencies.push_back(std::chrono::duration<double, std::micro>(steady::now() - sent).count());
+                    else if (last)
+                        break;
+                }
+            });
+
+        handoff_result result;
+        for (size_t i = 0; i < count; ++i)
+        {
+            if (!queue.try_enqueue(steady::now()))
+                ++result.dropped;
+            std::this_thread::sleep_for(period);
+        }
+
+        produced = true;
+        consumer.join();
+
+        result.received = latencies.size();
+        if (latencies.empty())
+            return result;
+
+        for (double latency : latencies)
+            result.mean_us += latency;
+        result.mean_us /= latencies.size();
+
+        const auto p99 = latencies.begin() + latencies.size() * 99 / 100;
+        std::nth_element(latencies.begin(), p99, latencies.end());
+        result.p99_us = *p99;
+        return result;
+    }
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(F_bounded_queue_order_test, "Research.bounded_queue.order",
+    EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool F_bounded_queue_order_test::RunTest(const FString& Parameters)
+{
+    constexpr int32 count = 100000;
+    bounded_queue<int32> queue(capacity);
+
+    std::thread producer([&]()
+        {
+            for (int32 i = 0; i < count; ++i)
+                while (!queue.wait_enqueue_for(i, std::chrono::seconds(1)))
+                {}
+        });
+
+    int32 expected = 0;
+    int32 value;
+    while (expected < count && queue.wait_dequeue_for(value, std::chrono::seconds(1)))
+    {
+        if (value != expected)
+            break;
+        ++expected;
+    }
+    producer.join();
+
+    TestEqual(TEXT("received in order"), expected, count);
+    TestEqual(TEXT("queue drained"), static_cast<int64>(queue.size_approx()), int64(0));
+    return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(F_bounded_queue_close_test, "Research.bounded_queue.close",
+    EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool F_bounded_queue_close_test::RunTest(const FString& Parameters)
+{
+    bounded_queue<int32> queue(capacity);
+    int32 value;
+
+    /**
+     * closing before anybody waits must not be lost
+     */
+    queue.close();
+    const auto start = steady::now();
+    TestFalse(TEXT("wait on closed queue"), queue.wait_dequeue(value));
+    TestTrue(TEXT("returned immediately"), steady::now() - start < std::chrono::seconds(1));
+
+    TestTrue(TEXT("enqueue on closed queue"), queue.try_enqueue(1));
+    TestTrue(TEXT("drain closed queue"), queue.wait_dequeue(value) && value == 1);
+
+    queue.reopen();
+    std::thread waiter([&]()
+        {
+            queue.wait_dequeue(value);
+        });
+    FPlatformProcess::Sleep(0.05f);
+    queue.close();
+    waiter.join();
+
+    queue.reopen();
+    TestFalse(TEXT("times out after reopen"), queue.wait_dequeue_for(value, std::chrono::milliseconds(10)));
+    return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(F_bounded_queue_latency_test, "Research.bounded_queue.handoff_latency",
+    EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::PerfFilter)
+
+bool F_bounded_queue_latency_test::RunTest(const FString& Parameters)
+{
+    /**
+     * depth frames at 45 Hz up to a rate beyond any sensor
+     */
+    const std::pair<const TCHAR*, std::chrono::microseconds> rates[] = {
+        { TEXT("45 Hz"), std::chrono::microseconds(22222) },
+        { TEXT("1 kHz"), std::chrono::microseconds(1000) },
+        { TEXT("10 kHz"), std::chrono::microseconds(100) }
+    };
+
+    for (const auto& [name, period] : rates)
+    {
+        const size_t count = period.count() > 10000 ? 200 : 20000;
+
+        bounded_queue<steady::time_point> lock_free(capacity);
+        const handoff_result a = measure(lock_free, count, period);
+
+        locked_queue locked;
+        const handoff_result b = measure(locked, count, period);
+
+        for (const auto& [queue, result] : { std::make_pair(TEXT("bounded_queue"), &a), std::make_pair(TEXT("mutex queue"), &b) })
+        {
+            AddInfo(FString::Printf(TEXT("%s %s: mean %.1f us, p99 %.1f us, %llu received, %llu dropped"),
+                queue, name, result->mean_us, result->p99_us,
+                static_cast<uint64>(result->received), static_cast<uint64>(result->dropped)));
+        }
+
+        TestEqual(TEXT("nothing lost"), static_cast<int64>(a.received + a.dropped), static_cast<int64>(count));
+    }
+
+    return true;
+}
+
+#endif
@@ -0,0 +1,111 @@
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+#include "depth_unprojection.h"
+
+#include <cmath>
+
+namespace
+{
+    constexpr uint32_t width = 64;
+    constexpr uint32_t height = 48;
+    constexpr float depth_scale = 0.1f;
+
+    const pinhole_intrinsics intrinsics{ 50.f, 45.f, 31.5f, 23.5f };
+
+    /**
+     * pixels outside the circle around the principal point have no ray
+     */
+    bool inside(uint32_t column, uint32_t row)
+    {
+        const float u = column - intrinsics.cx;
+        const float v = row - intrinsics.cy;
+        return u * u + v * v < 22.f * 22.f;
+    }
+
+    /**
+     * unprojection of a single pixel straight from the camera model
+     */
+    FVector reference(uint32_t column, uint32_t row, uint16_t depth)
+    {
+        const double x = (column - intrinsics.cx) / intrinsics.fx;
+        const double y = (row - intrinsics.cy) / intrinsics.fy;
+        const double scale = depth * depth_scale / std::sqrt(x * x + y * y + 1.);
+        return FVector(-scale, x * scale, y * scale);
+    }
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(F_depth_unprojection_test, "Research.depth_unprojection.pinhole",
+    EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool F_depth_unprojection_test::RunTest(const FString& Parameters)
+{
+    const depth_unprojection table(width, height,
+        [](float (&uv)[2], float (&xy)[2])
+        {
+            if (!inside(static_cast<uint32_t>(uv[0]), static_cast<uint32_t>(uv[1])))
+                return false;
+            return intrinsics(uv, xy);
+        }, depth_scale);
+
+    TestTrue(TEXT("resolution"), table.matches(width, height));
+    TestEqual(TEXT("pixels"), static_cast<int64>(table.pixel_count()), static_cast<int64>(width * height));
+
+    /**
+     * every seventh pixel is flagged invalid, depth varies per pixel
+     */
+    std::vector<uint16_t> depth(table.pixel_count());
+    std::vector<uint8_t> sigma(table.pixel_count());
+    TArray<FVector> expected;
+    for (uint32_t row = 0, i = 0; row < height; ++row)
+    {
+        for (uint32_t column = 0; column < width; ++column, ++i)
+        {
+            depth[i] = static_cast<uint16_t>(200 + (i * 37) % 3000);
+            sigma[i] = i % 7 == 0 ? 0x80 | (i & 0x7F) : i & 0x7F;
+
+            if (!(sigma[i] & 0x80) && inside(column, row))
+                expected.Add(reference(column, row, depth[i]));
+        }
+    }
+
+    TArray<FVector> points;
+    points.SetNumUninitialized(table.pixel_count());
+    const size_t count = table.unproject(depth.data(), sigma.data(), points.GetData());
+
+    if (!TestEqual(TEXT("points"), static_cast<int64>(count), static_cast<int64>(expected.Num())))
+        return false;
+
+    for (int32 i = 0; i < expected.Num(); ++i)
+    {
+        if (!points[i].Equals(expected[i], 1e-3 * expected[i].Size()))
+        {
+            AddError(FString::Printf(TEXT("point %d is %s instead of %s"),
+                i, *points[i].ToString(), *expected[i].ToString()));
+            return false;
+        }
+    }
+
+    /**
+     * the axes overload writes the same points
+     */
+    std::vector<float> x(table.pixel_count()), y(table.pixel_count()), z(table.pixel_count());
+    TestEqual(TEXT("axes points"),
+        static_cast<int64>(table.unproject(depth.data(), sigma.data(), x.data(), y.data(), z.data())), static_cast<int64>(count));
+    for (size_t i = 0; i < count; ++i)
+        if (FVector(x[i], y[i], z[i]) != points[i])
+        {
+            AddError(FString::Printf(TEXT("axes point %llu differs"), static_cast<uint64>(i)));
+            return false;
+        }
+
+    /**
+     * pixels without ray stay zero
+     */
+    TestEqual(TEXT("no ray"), table.ray(0)[0], 0.f);
+
+    return true;
+}
+
+#endif
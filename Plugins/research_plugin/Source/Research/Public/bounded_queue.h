@@ -0,0 +1,346 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <new>
+
+/**
+ * @class event_count
+ * lets threads sleep until a condition they polled lock free
+ * may have changed without missing a wake up
+ *
+ * waiter: key = prepare_wait(), re-check condition,
+ * then cancel_wait() or wait_until(key, ...)
+ * notifier: change condition, then notify()
+ *
+ * notify costs a fence and a load while nobody waits
+ */
+class event_count final
+{
+public:
+
+    uint32_t prepare_wait()
+    {
+        const uint64_t prev = state.fetch_add(1, std::memory_order_seq_cst);
+        return static_cast<uint32_t>(prev >> epoch_shift);
+    }
+
+    void cancel_wait()
+    {
+        state.fetch_sub(1, std::memory_order_seq_cst);
+    }
+
+    /**
+     * @returns false on timeout
+     */
+    template<typename Clock, typename Duration>
+    bool wait_until(uint32_t key, const std::chrono::time_point<Clock, Duration>& deadline)
+    {
+        bool notified;
+        {
+            std::unique_lock lock(mtx);
+            notified = cv.wait_until(lock, deadline, [this, key]()
+                {
+                    return epoch() != key;
+                });
+        }
+        state.fetch_sub(1, std::memory_order_seq_cst);
+        return notified;
+    }
+
+    void wait(uint32_t key)
+    {
+        {
+            std::unique_lock lock(mtx);
+            cv.wait(lock, [this, key]()
+                {
+                    return epoch() != key;
+                });
+        }
+        state.fetch_sub(1, std::memory_order_seq_cst);
+    }
+
+    void notify()
+    {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if ((state.load(std::memory_order_relaxed) & waiter_mask) == 0)
+            return;
+
+        state.fetch_add(uint64_t(1) << epoch_shift, std::memory_order_seq_cst);
+
+        /**
+         * a waiter between its check of the epoch
+         * and sleeping holds the mutex
+         */
+        {
+            std::unique_lock lock(mtx);
+        }
+        cv.notify_all();
+    }
+
+private:
+
+    uint32_t epoch() const
+    {
+        return static_cast<uint32_t>(state.load(std::memory_order_acquire) >> epoch_shift);
+    }
+
+    inline static constexpr int epoch_shift = 32;
+    inline static constexpr uint64_t waiter_mask = (uint64_t(1) << epoch_shift) - 1;
+
+    /**
+     * epoch in the upper, waiters in the lower half
+     */
+    std::atomic_uint64_t state = 0;
+
+    std::mutex mtx;
+    std::condition_variable cv;
+};
+
+/**
+ * @class bounded_queue
+ * lock free bounded multi producer multi consumer queue
+ * see https://www.1024cores.net/home/lock-free-algorithms/queues/bounded-mpmc-queue
+ *
+ * the non blocking functions never take a lock, the wait functions
+ * sleep on an @ref{event_count} if the queue is empty respectively full
+ * until an element respectively space is available or the queue is closed
+ *
+ * @attend T has to be default constructible and move assignable
+ */
+template<typename T>
+class bounded_queue final
+{
+public:
+
+    explicit bounded_queue(size_t capacity)
+        : size(capacity > 0 ? capacity : 1),
+        cells(std::make_unique<cell[]>(size))
+    {
+        for (size_t i = 0; i < size; ++i)
+            cells[i].sequence.store(i, std::memory_order_relaxed);
+    }
+
+    bounded_queue(const bounded_queue&) = delete;
+    bounded_queue& operator=(const bounded_queue&) = delete;
+
+    /**
+     * @returns false if the queue is full
+     * value is only moved from on success
+     */
+    template<typename U>
+    bool try_enqueue(U&& value)
+    {
+        size_t pos = enqueue_pos.load(std::memory_order_relaxed);
+        cell* c;
+        for (;;)
+        {
+            c = &cells[pos % size];
+            const size_t seq = c->sequence.load(std::memory_order_acquire);
+            const auto diff = static_cast<std::intptr_t>(seq) - static_cast<std::intptr_t>(pos);
+
+            if (diff == 0)
+            {
+                if (enqueue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                    break;
+            }
+            else if (diff < 0)
+                return false;
+            else
+                pos = enqueue_pos.load(std::memory_order_relaxed);
+        }
+
+        c->data = std::forward<U>(value);
+        c->sequence.store(pos + 1, std::memory_order_release);
+
+        not_empty.notify();
+        return true;
+    }
+
+    /**
+     * @returns false if the queue is empty
+     */
+    bool try_dequeue(T& out)
+    {
+        size_t pos = dequeue_pos.load(std::memory_order_relaxed);
+        cell* c;
+        for (;;)
+        {
+            c = &cells[pos % size];
+            const size_t seq = c->sequence.load(std::memory_order_acquire);
+            const auto diff = static_cast<std::intptr_t>(seq) - static_cast<std::intptr_t>(pos + 1);
+
+            if (diff == 0)
+            {
+                if (dequeue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                    break;
+            }
+            else if (diff < 0)
+                return false;
+            else
+                pos = dequeue_pos.load(std::memory_order_relaxed);
+        }
+
+        out = std::move(c->data);
+        c->sequence.store(pos + size, std::memory_order_release);
+
+        not_full.notify();
+        return true;
+    }
+
+    /**
+     * blocks until an element was dequeued
+     * @returns false if interrupted by @ref{close}
+     */
+    bool wait_dequeue(T& out)
+    {
+        return wait_dequeue_until(out, std::chrono::steady_clock::time_point::max());
+    }
+
+    /**
+     * @returns false on timeout or if interrupted by @ref{close}
+     */
+    template<typename Rep, typename Period>
+    bool wait_dequeue_for(T& out, const std::chrono::duration<Rep, Period>& timeout)
+    {
+        return wait_dequeue_until(out, std::chrono::steady_clock::now() + timeout);
+    }
+
+    /**
+     * @returns false on timeout or if interrupted by @ref{close}
+     * value is only moved from on success
+     */
+    template<typename U, typename Rep, typename Period>
+    bool wait_enqueue_for(U&& value, const std::chrono::duration<Rep, Period>& timeout)
+    {
+        return wait_until(not_full, std::chrono::steady_clock::now() + timeout, [&]()
+            {
+                return try_enqueue(std::forward<U>(value));
+            });
+    }
+
+    /**
+     * waits until there is space without enqueuing anything
+     * @returns false on timeout or if interrupted by @ref{close}
+     */
+    template<typename Rep, typename Period>
+    bool wait_not_full_for(const std::chrono::duration<Rep, Period>& timeout)
+    {
+        return wait_until(not_full, std::chrono::steady_clock::now() + timeout, [this]()
+            {
+                return size_approx() < size;
+            });
+    }
+
+    /**
+     * dequeues all elements present at the time of the call
+     */
+    void clear()
+    {
+        T temp;
+        while (try_dequeue(temp))
+        {}
+    }
+
+    /**
+     * interrupts all threads blocked in a wait function, wait functions
+     * called later return false as well instead of blocking until @ref{reopen}
+     * the non blocking functions keep working, so consumers may drain the queue
+     */
+    void close()
+    {
+        closed.store(true, std::memory_order_seq_cst);
+
+        not_empty.notify();
+        not_full.notify();
+    }
+
+    /**
+     * lets the wait functions block again after @ref{close}
+     */
+    void reopen()
+    {
+        closed.store(false, std::memory_order_seq_cst);
+    }
+
+    /**
+     * @attend only a snapshot while other threads operate on the queue
+     */
+    size_t size_approx() const
+    {
+        const size_t tail = enqueue_pos.load(std::memory_order_acquire);
+        const size_t head = dequeue_pos.load(std::memory_order_acquire);
+        return tail > head ? tail - head : 0;
+    }
+
+    size_t capacity() const
+    {
+        return size;
+    }
+
+private:
+
+    /**
+     * separate cache lines to avoid false sharing
+     * between neighbouring producers and consumers
+     */
+    struct alignas(64) cell
+    {
+        std::atomic_size_t sequence;
+        T data;
+    };
+
+    bool wait_dequeue_until(T& out, std::chrono::steady_clock::time_point deadline)
+    {
+        return wait_until(not_empty, deadline, [&]()
+            {
+                return try_dequeue(out);
+            });
+    }
+
+    /**
+     * polls attempt and sleeps on events in between
+     */
+    template<typename F>
+    bool wait_until(event_count& events, std::chrono::steady_clock::time_point deadline, F&& attempt)
+    {
+        for (;;)
+        {
+            if (attempt())
+                return true;
+
+            const uint32_t key = events.prepare_wait();
+            if (attempt())
+            {
+                events.cancel_wait();
+                return true;
+            }
+
+            if (closed.load(std::memory_order_seq_cst))
+            {
+                events.cancel_wait();
+                return false;
+            }
+
+            if (deadline == std::chrono::steady_clock::time_point::max())
+                events.wait(key);
+            else if (!events.wait_until(key, deadline))
+                return attempt();
+        }
+    }
+
+    const size_t size;
+    std::unique_ptr<cell[]> cells;
+
+    alignas(64) std::atomic_size_t enqueue_pos = 0;
+    alignas(64) std::atomic_size_t dequeue_pos = 0;
+
+    std::atomic_bool closed = false;
+
+    event_count not_empty;
+    event_count not_full;
+};
@@ -6,7 +6,15 @@
 
 #include "ARTypes.h"
 
+#include <chrono>
+#include <condition_variable>
+#include <thread>
+
 #include "pch.h"
+#include "bounded_queue.h"
+#include "depth_unprojection.h"
+#include "depth_recording.h"
+#include "point_buffer.h"
 
 #include "camera.generated.h"
 
@@ -27,12 +35,48 @@ struct F_point_cloud
 {
 	GENERATED_BODY()
 
-    UPROPERTY()
-        TArray<FVector> data;
+    /**
+     * not exposed to blueprints, see @ref{A_camera::get_u_pcl}
+     */
+    point_buffer points;
     UPROPERTY()
         int64 abs_timestamp = 0;
 };
 
+/**
+ * @struct F_point_buffer_metrics
+ * memory of the point clouds of all cameras
+ */
+USTRUCT(BlueprintType)
+struct RESEARCH_API F_point_buffer_metrics
+{
+    GENERATED_BODY()
+
+    /**
+     * storage allocated from the heap, all other frames reused storage
+     */
+    UPROPERTY(BlueprintReadOnly)
+    int64 allocations = 0;
+
+    UPROPERTY(BlueprintReadOnly)
+    int64 reuses = 0;
+
+    UPROPERTY(BlueprintReadOnly)
+    int64 bytes_in_use = 0;
+
+    UPROPERTY(BlueprintReadOnly)
+    int64 bytes_pooled = 0;
+
+    /**
+     * storage of the last point cloud and the bytes its points occupy
+     */
+    UPROPERTY(BlueprintReadOnly)
+    int64 last_frame_allocated = 0;
+
+    UPROPERTY(BlueprintReadOnly)
+    int64 last_frame_bytes = 0;
+};
+
 /**
  * @struct F_located_point_cloud
  * wrapper for a point cloud with a position
@@ -49,6 +93,17 @@ struct F_located_point_cloud
         F_point_cloud point_cloud;
 };
 
+/**
+ * @enum capture_mode
+ * output of the camera worker
+ */
+UENUM()
+enum class capture_mode : uint8
+{
+    POINT_CLOUD,
+    RAW_DEPTH
+};
+
 /**
  * @enum threading
  * enum denoting the thread mode of consumption
@@ -96,6 +151,8 @@ public:
     /**
      * denotes if point clouds are extracted by a single consumer
      * or multiple
+     *
+     * @attend the buffer is lock free for both
      */
     UPROPERTY(BlueprintReadWrite, Category="HoloLens|PCL")
     threading thread_type = threading::SINGLE_CONSUMER;
@@ -103,6 +160,15 @@ public:
     UFUNCTION(BlueprintCallable, Category = "HoloLens|PCL")
     F_located_point_cloud get_u_pcl(int64 max_timestamp = -1);
 
+    /**
+     * like @ref{get_u_pcl} with the points converted for blueprints
+     */
+    UFUNCTION(BlueprintCallable, Category = "HoloLens|PCL")
+    F_located_point_cloud get_u_pcl_points(TArray<FVector>& points, int64 max_timestamp = -1);
+
+    UFUNCTION(BlueprintCallable, Category = "HoloLens|PCL")
+    static F_point_buffer_metrics get_point_buffer_metrics();
+
     /**
      * tries to get point cloud from camera
      *
@@ -110,7 +176,85 @@ public:
      *
      * @attend takes point clouds out of the buffer
      */
-	TOptional<F_located_point_cloud> get_pcl(UINT64 max_timestamp = 0);
+	TOptional<F_located_point_cloud> get_pcl(uint64 max_timestamp = 0);
+
+    /**
+     * waits for a point cloud from camera
+     *
+     * @returns empty optional if none arrived within timeout
+     * or the camera is destroyed
+     *
+     * @attend takes point clouds out of the buffer
+     */
+    TOptional<F_located_point_cloud> wait_pcl(std::chrono::milliseconds timeout);
+
+    /**
+     * selects whether the worker unprojects frames into point clouds
+     * (@ref{wait_pcl}) or passes them on unprocessed (@ref{wait_depth_frame})
+     */
+    void set_capture_mode(capture_mode mode);
+
+    /**
+     * waits for an unprocessed depth frame, only produced in
+     * @ref{capture_mode::RAW_DEPTH}
+     *
+     * @returns empty optional if none arrived within timeout
+     * or the camera is destroyed
+     */
+    TOptional<raw_depth_frame> wait_depth_frame(std::chrono::milliseconds timeout);
+
+    /**
+     * @returns unit rays of the sensor, nullptr until the
+     * first frame arrived, replaced if the resolution changes
+     */
+    std::shared_ptr<const depth_unprojection> get_unprojection() const;
+
+    /**
+     * records all frames delivered by the sensor or a replay to path
+     * see @ref{depth_recording} for the format
+     *
+     * @returns false if the file can't be created
+     */
+    UFUNCTION(BlueprintCallable, Category = "HoloLens|PCL")
+    bool start_recording(const FString& path);
+
+    UFUNCTION(BlueprintCallable, Category = "HoloLens|PCL")
+    void stop_recording();
+
+    /**
+     * feeds the frames of a recording into the buffers as if they came
+     * from the sensor, works on all platforms and without init
+     *
+     * @param rate speed relative to the recording, if <= 0 frames are
+     * delivered as fast as they are consumed and never dropped,
+     * only a single consumer takes them in the recorded order
+     * @param loop restarts at the first frame after the last one
+     * @returns false if the file is no recording or holds no frames
+     *
+     * @attend the frames keep the timestamps of the recording
+     */
+    UFUNCTION(BlueprintCallable, Category = "HoloLens|PCL")
+    bool start_replay(const FString& path, float rate = 1.f, bool loop = false);
+
+    UFUNCTION(BlueprintCallable, Category = "HoloLens|PCL")
+    void stop_replay();
+
+    /**
+     * @returns true until the replay ended or was stopped
+     */
+    UFUNCTION(BlueprintCallable, Category = "HoloLens|PCL")
+    bool is_replaying() const;
+
+    /**
+     * @returns number of point clouds waiting in the buffer
+     */
+    size_t get_queue_depth() const;
+
+    /**
+     * @returns number of point clouds dropped because
+     * the buffer stayed full
+     */
+    uint64_t get_dropped_frames() const;
 
     /**
      * clears all the point clouds from the buffer
@@ -140,6 +284,51 @@ public:
 private:
         
     static const bool supported = PLATFORM_HOLOLENS;
+
+    /**
+     * records the frame and puts it into the buffer of the capture mode
+     * unprojected respectively copied
+     *
+     * @param wait blocks while the buffer is full instead of dropping the frame
+     * as long as a replay is running
+     */
+    void deliver(const depth_frame_view& frame, bool wait);
+
+    template<typename T>
+    void push(bounded_queue<T>& queue, T&& value, bool wait);
+
+    /**
+     * delivers the frames of replay until the end or @ref{stop_replay}
+     */
+    void replay_worker(std::unique_ptr<depth_replay> replay, float rate, bool loop);
+
+    /**
+     * unit rays of the sensor, replaced by the worker or a replay
+     */
+    std::shared_ptr<const depth_unprojection> unprojection;
+    FTransform camera_view_matrix;
+    mutable std::mutex calibration_mtx;
+
+    std::atomic<capture_mode> capture = capture_mode::POINT_CLOUD;
+
+    /**
+     * limited buffer for point clouds
+     */
+    bounded_queue<F_located_point_cloud> pcl_queue =
+        bounded_queue<F_located_point_cloud>(5);
+    bounded_queue<raw_depth_frame> raw_queue =
+        bounded_queue<raw_depth_frame>(5);
+    std::atomic_uint64_t dropped_frames = 0;
+
+    inline static std::atomic_int64_t last_frame_allocated = 0;
+    inline static std::atomic_int64_t last_frame_bytes = 0;
+
+    depth_recorder recorder;
+
+    std::atomic_bool replaying = false;
+    std::mutex replay_mtx;
+    std::condition_variable replay_cv;
+    std::unique_ptr<std::thread> replay_thread;
 	
 #if (PLATFORMS)    
 
@@ -159,14 +348,6 @@ private:
      */
     void worker();
 
-    /**
-     * processes a depth frame from the sensor into a point cloud
-     *
-     * @attend must be called on same thread as @ref{OpenStream}
-     */
-    TArray<FVector> process(
-        const winrt::com_ptr<IResearchModeSensorDepthFrame>& depth_frame) const;
-
     /**
      * sets the queried camera access consent and notifies listeners
      */
@@ -175,10 +356,6 @@ private:
     Spatial::SpatialLocator locator = nullptr;
     Spatial::SpatialCoordinateSystem coord_system { nullptr };
     
-    std::condition_variable cv;
-    std::mutex mutex;
-    std::mutex consumer_mutex;
-
     /**
      * variables to wait for consent
      */
@@ -195,15 +372,14 @@ private:
     ResearchModeSensorResolution resolution;
 
     /**
-     * limited buffer for point clouds
+     * rebuilds @ref{unprojection} if the resolution changed
+     *
+     * @attend must be called on same thread as @ref{OpenStream}
      */
-    TCircularQueue<F_located_point_cloud> pcl_queue =
-        TCircularQueue<F_located_point_cloud>(5 + 1);
+    void update_unprojection();
     
     std::atomic<camera_state> state = camera_state::INIT;
     std::unique_ptr<std::thread> worker_thread;
 	
-    FTransform camera_view_matrix;
-	
 #endif	
 };
\ No newline at end of file
@@ -0,0 +1,162 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GenericPlatform/GenericPlatformFile.h"
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "depth_unprojection.h"
+
+class IMappedFileHandle;
+class IMappedFileRegion;
+
+/**
+ * @struct raw_depth_frame
+ * unprocessed long throw depth frame with its location
+ * pixels with bit 0x80 set in sigma are invalid
+ */
+struct raw_depth_frame
+{
+    TArray<uint16> depth;
+    TArray<uint8> sigma;
+    uint32 width = 0;
+    uint32 height = 0;
+
+    FTransform location = {};
+    int64 abs_timestamp = 0;
+};
+
+/**
+ * @struct depth_frame_view
+ * non owning view of a depth frame e.g. into the buffers
+ * of the sensor or a memory mapped recording
+ */
+struct depth_frame_view
+{
+    const uint16* depth = nullptr;
+    const uint8* sigma = nullptr;
+    uint32 width = 0;
+    uint32 height = 0;
+
+    FTransform location = {};
+    int64 abs_timestamp = 0;
+};
+
+/**
+ * layout of depth recordings, all values little endian
+ *
+ * file    := "DREC" version:u32 chunk*
+ * chunk   := tag:u32 size:u32 payload[size] padding to 8 bytes
+ * RAYS    := width:u32 height:u32 camera_view:f64[16] ray_x:f32[n] ray_y:f32[n] ray_z:f32[n]
+ * FRAM    := timestamp:i64 location:f64[16] width:u32 height:u32 depth:u16[n] sigma:u8[n]
+ *
+ * n = width * height, matrices are row major FMatrix of the FTransform,
+ * a RAYS chunk applies to all following frames, readers skip unknown tags
+ */
+namespace depth_recording
+{
+    constexpr uint32 version = 1;
+    constexpr uint32 magic = 'D' | 'R' << 8 | 'E' << 16 | 'C' << 24;
+    constexpr uint32 rays_tag = 'R' | 'A' << 8 | 'Y' << 16 | 'S' << 24;
+    constexpr uint32 frame_tag = 'F' | 'R' << 8 | 'A' << 16 | 'M' << 24;
+}
+
+/**
+ * @class depth_recorder
+ * appends depth frames to a recording
+ *
+ * @attend thread safe
+ */
+class RESEARCH_API depth_recorder final
+{
+public:
+
+    depth_recorder() = default;
+    ~depth_recorder();
+
+    /**
+     * truncates path and writes the file header
+     * @returns false if the file can't be created
+     */
+    bool open(const FString& path);
+
+    void close();
+
+    bool is_open() const;
+
+    /**
+     * writes a frame, preceded by the rays if they
+     * differ from the last written ones
+     *
+     * @returns false if the recording is closed or writing failed
+     */
+    bool write(const depth_frame_view& frame,
+        const std::shared_ptr<const depth_unprojection>& rays, const FTransform& camera_view);
+
+private:
+
+    bool write_chunk(uint32 tag, std::initializer_list<std::pair<const void*, size_t>> parts);
+
+    mutable std::mutex mtx;
+    std::unique_ptr<IFileHandle> file;
+    std::shared_ptr<const depth_unprojection> written_rays;
+};
+
+/**
+ * @class depth_replay
+ * random access to the frames of a memory mapped recording
+ * frames are views into the mapping, nothing is copied
+ */
+class RESEARCH_API depth_replay final
+{
+public:
+
+    depth_replay();
+    ~depth_replay();
+
+    /**
+     * maps path and indexes its chunks
+     * @returns false if the file can't be mapped or is no recording,
+     * a truncated last chunk is ignored
+     */
+    bool open(const FString& path);
+
+    void close();
+
+    size_t frame_count() const;
+
+    /**
+     * @returns view valid until the replay is closed
+     */
+    depth_frame_view frame(size_t index) const;
+
+    /**
+     * @returns rays of the sensor while recording the frame
+     */
+    const std::shared_ptr<const depth_unprojection>& rays(size_t index) const;
+
+    FTransform camera_view(size_t index) const;
+
+private:
+
+    struct ray_entry
+    {
+        std::shared_ptr<const depth_unprojection> rays;
+        FTransform camera_view;
+    };
+
+    struct frame_entry
+    {
+        const uint8* payload;
+        size_t rays;
+    };
+
+    std::unique_ptr<IMappedFileHandle> handle;
+    std::unique_ptr<IMappedFileRegion> region;
+
+    std::vector<ray_entry> ray_entries;
+    std::vector<frame_entry> frames;
+};
@@ -0,0 +1,134 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+/**
+ * @struct pinhole_intrinsics
+ * synthetic camera model mapping image points to the unit plane
+ * allows building a @ref{depth_unprojection} without a sensor
+ */
+struct pinhole_intrinsics
+{
+    float fx = 1.f;
+    float fy = 1.f;
+    float cx = 0.f;
+    float cy = 0.f;
+
+    bool operator()(float (&uv)[2], float (&xy)[2]) const
+    {
+        xy[0] = (uv[0] - cx) / fx;
+        xy[1] = (uv[1] - cy) / fy;
+        return true;
+    }
+};
+
+/**
+ * @class depth_unprojection
+ * lookup table of the unit ray of every pixel of a depth sensor
+ *
+ * rays are stored per axis, already in unreal axis order
+ * and scaled from depth units to output units, so unprojecting
+ * a pixel is a multiplication of its ray by its depth
+ */
+class RESEARCH_API depth_unprojection final
+{
+public:
+
+    typedef std::function<bool(float (&uv)[2], float (&xy)[2])> unit_plane_mapping;
+
+    depth_unprojection() = default;
+
+    /**
+     * @param map_to_unit_plane maps a pixel (column, row) to the unit plane z = 1
+     * e.g. IResearchModeCameraSensor::MapImagePointToCameraUnitPlane
+     * or @ref{pinhole_intrinsics}, pixels it fails for are skipped
+     * @param depth_scale output units per depth unit e.g. 0.1 for mm to cm
+     */
+    depth_unprojection(uint32_t width, uint32_t height, const unit_plane_mapping& map_to_unit_plane, float depth_scale);
+
+    /**
+     * rebuilds a table from the rays of another one e.g. received
+     * with a raw depth stream, serves as reference unprojection
+     * of transmitted depth frames
+     *
+     * @param ray_x, ray_y, ray_z scaled rays per pixel as returned by @ref{ray},
+     * pixels whose rays are zero are skipped
+     */
+    depth_unprojection(uint32_t width, uint32_t height,
+        std::vector<float> ray_x, std::vector<float> ray_y, std::vector<float> ray_z);
+
+    /**
+     * @returns true if the table was built for the resolution
+     */
+    bool matches(uint32_t width, uint32_t height) const;
+
+    size_t pixel_count() const;
+
+    uint32_t get_width() const;
+    uint32_t get_height() const;
+
+    /**
+     * @param axis 0, 1 or 2 for x, y and z in unreal axis order
+     * @returns scaled rays of all pixels, zero for pixels without ray
+     */
+    const std::vector<float>& ray(size_t axis) const;
+
+    /**
+     * unprojects all pixels with a valid ray and without the invalid bit 0x80
+     * in sigma in a single branch free sweep, points keep the pixel order
+     *
+     * @param depth, sigma buffers of the frame with @ref{pixel_count} elements
+     * @param out has to hold @ref{pixel_count} elements
+     * @returns number of points written to out
+     */
+    template<typename Vector>
+    size_t unproject(const uint16_t* depth, const uint8_t* sigma, Vector* out) const
+    {
+        const float* ray_x = rays[0].data();
+        const float* ray_y = rays[1].data();
+        const float* ray_z = rays[2].data();
+        const uint8_t* ray_valid = valid.data();
+
+        size_t count = 0;
+        for (size_t i = 0; i < valid.size(); ++i)
+        {
+            const float d = static_cast<float>(depth[i]);
+            out[count] = Vector(ray_x[i] * d, ray_y[i] * d, ray_z[i] * d);
+            count += ((sigma[i] >> 7) ^ 1) & ray_valid[i];
+        }
+        return count;
+    }
+
+    /**
+     * like @ref{unproject} but writes the axes into separate arrays
+     */
+    size_t unproject(const uint16_t* depth, const uint8_t* sigma, float* out_x, float* out_y, float* out_z) const
+    {
+        const float* ray_x = rays[0].data();
+        const float* ray_y = rays[1].data();
+        const float* ray_z = rays[2].data();
+        const uint8_t* ray_valid = valid.data();
+
+        size_t count = 0;
+        for (size_t i = 0; i < valid.size(); ++i)
+        {
+            const float d = static_cast<float>(depth[i]);
+            out_x[count] = ray_x[i] * d;
+            out_y[count] = ray_y[i] * d;
+            out_z[count] = ray_z[i] * d;
+            count += ((sigma[i] >> 7) ^ 1) & ray_valid[i];
+        }
+        return count;
+    }
+
+private:
+
+    uint32_t width = 0;
+    uint32_t height = 0;
+
+    std::vector<float> rays[3];
+    std::vector<uint8_t> valid;
+};
@@ -44,9 +44,13 @@ public class Research : ModuleRules
             "Core", "CoreUObject", "GeometryCore", "Engine", "AugmentedReality"
         });
 
-        PrivateDependencyModuleNames.Add("MicrosoftOpenXR");
+        // OpenXR anchors are only used with the sensor, other platforms replay recordings
+        if (Target.Platform == UnrealTargetPlatform.Win64 || Target.Platform == UnrealTargetPlatform.HoloLens)
+        {
+            PrivateDependencyModuleNames.Add("MicrosoftOpenXR");
 
-        PublicIncludePathModuleNames.Add("OpenXR");
+            PublicIncludePathModuleNames.Add("OpenXR");
+        }
         //PrivateIncludePaths.Add(Path.Combine(PluginDirectory, "..", "MicrosoftOpenXR/Source/MicrosoftOpenXR/Private/External"));
 
         // WinRT with Nuget support
@@ -1,22 +1,133 @@
 #include "TransformHelper.h"
 
-#if __cplusplus < 202002L
-namespace detail
+#include <stdexcept>
+
+namespace
 {
-	template<class T, std::size_t N, std::size_t... I>
-	constexpr std::array<std::remove_cv_t<T>, N>
-		to_array_impl(T(&& a)[N], std::index_sequence<I...>)
+	/**
+	 * source column of each output row
+	 */
+	constexpr std::array<std::array<int8_t, 3>, 6> axis_permutations = { {
+		{ 0, 1, 2 },
+		{ 0, 2, 1 },
+		{ 1, 0, 2 },
+		{ 1, 2, 0 },
+		{ 2, 0, 1 },
+		{ 2, 1, 0 }
+	} };
+
+	/**
+	 * Index = 8 * permutation + sign bits, bit i is set if output row i is negated
+	 * source and signs are constants so the kernel is a shuffle and three multiplies
+	 */
+	template<size_t Index>
+	FVector permute_axes(const FVector& in, double scale)
+	{
+		static_assert(sizeof(FVector) == 3 * sizeof(double), "Engine related code changed; Fix this!");
+
+		constexpr auto source = axis_permutations[Index / 8];
+		constexpr double sign_x = (Index & 1) ? -1. : 1.;
+		constexpr double sign_y = (Index & 2) ? -1. : 1.;
+		constexpr double sign_z = (Index & 4) ? -1. : 1.;
+
+		const auto in_c = &in.X;
+		return {
+			in_c[source[0]] * (sign_x * scale),
+			in_c[source[1]] * (sign_y * scale),
+			in_c[source[2]] * (sign_z * scale)
+		};
+	}
+
+	template<size_t... Index>
+	constexpr std::array<Transformation::AxisKernel, sizeof...(Index)> make_axis_kernels(std::index_sequence<Index...>)
 	{
-		return { {std::move(a[I])...} };
+		return { &permute_axes<Index>... };
 	}
-}
 
-template<class T, std::size_t N>
-constexpr std::array<std::remove_cv_t<T>, N> to_array(T(&& a)[N])
-{
-	return detail::to_array_impl(std::move(a), std::make_index_sequence<N>{});
+	constexpr auto axis_kernels = make_axis_kernels(std::make_index_sequence<8 * axis_permutations.size()>{});
+
+	/**
+	 * @returns index into axis_kernels
+	 */
+	size_t kernel_index(const Transformation::SparseAssignments& ttt, bool with_signs)
+	{
+		std::array<int8_t, 3> source = {};
+		size_t signs = 0;
+		for (const auto& [column, row, multiplier] : ttt)
+		{
+			source[row] = column;
+			if (with_signs && multiplier < 0.f)
+				signs |= size_t(1) << row;
+		}
+
+		for (size_t i = 0; i < axis_permutations.size(); ++i)
+		{
+			if (axis_permutations[i] == source)
+				return 8 * i + signs;
+		}
+		throw std::runtime_error("Assignments are no axis permutation!");
+	}
+
+	/**
+	 * runtime form of an axis permutation
+	 * out[row] = in[source[row]] * scale[row]
+	 */
+	struct axis_rows
+	{
+		std::array<int8_t, 3> source;
+		std::array<double, 3> scale;
+	};
+
+	axis_rows make_axis_rows(const Transformation::SparseAssignments& ttt, double scale, bool with_signs)
+	{
+		axis_rows rows = {};
+		for (const auto& [column, row, multiplier] : ttt)
+		{
+			rows.source[row] = column;
+			rows.scale[row] = with_signs ? multiplier * scale : scale;
+		}
+		return rows;
+	}
+
+	constexpr size_t batch_block = 256;
+
+	/**
+	 * gathers blocks of in into one array per axis and
+	 * calls store(index, x, y, z) with the converted values
+	 *
+	 * the messages are scattered on the heap, so only the
+	 * gather is scalar, the loop over the permuted arrays
+	 * vectorizes since source and scale are fixed per block
+	 */
+	template<typename Message, typename Store>
+	void convert_blocks(std::span<const Message* const> in, const axis_rows& rows, Store&& store)
+	{
+		alignas(64) float axes[3][batch_block];
+
+		for (size_t begin = 0; begin < in.size(); begin += batch_block)
+		{
+			const size_t count = std::min(batch_block, in.size() - begin);
+
+			for (size_t i = 0; i < count; ++i)
+			{
+				const Message& message = *in[begin + i];
+				axes[0][i] = static_cast<float>(message.x());
+				axes[1][i] = static_cast<float>(message.y());
+				axes[2][i] = static_cast<float>(message.z());
+			}
+
+			const float* RESTRICT x = axes[rows.source[0]];
+			const float* RESTRICT y = axes[rows.source[1]];
+			const float* RESTRICT z = axes[rows.source[2]];
+			const double scale_x = rows.scale[0];
+			const double scale_y = rows.scale[1];
+			const double scale_z = rows.scale[2];
+
+			for (size_t i = 0; i < count; ++i)
+				store(begin + i, x[i] * scale_x, y[i] * scale_y, z[i] * scale_z);
+		}
+	}
 }
-#endif
 
 namespace Transformation
 {
@@ -25,7 +136,7 @@ namespace Transformation
 		: scale(scale), m_right(right), m_forward(forward), m_up(up)
 	{
 		if (right.axis == forward.axis || forward.axis == up.axis || right.axis == up.axis)
-			throw std::exception("The same axis occurs twice!");
+			throw std::runtime_error("The same axis occurs twice!");
 	}
 
 	TransformationMeta::TransformationMeta(const TransformationMeta& other)
@@ -104,37 +215,14 @@ namespace Transformation
 
 	FQuat TransformationConverter::convert_quaternion(const FQuat& in) const
 	{
-		FQuat out;
-
-		if (hand_changed)
-			out.W = -in.W;
-		else
-			out.W = in.W;
+		const FVector axes = kernel(FVector(in.X, in.Y, in.Z), 1.);
 
-		static_assert(sizeof(FQuat) == 4 * sizeof(double), "Engine related code changed; Fix this!");
-
-		auto coeffs = &out.X;
-		const auto in_c = &in.X;
-
-		for (const auto& [column, row, multiplier] : assignments)
-			coeffs[row] = in_c[column] * multiplier;
-
-		return out;
+		return FQuat(axes.X, axes.Y, axes.Z, hand_changed ? -in.W : in.W);
 	}
 
 	FVector TransformationConverter::convert_point(const FVector& in_f) const
 	{
-		FVector out_f;
-
-		static_assert(sizeof(FVector) == 3 * sizeof(double), "Engine related code changed; Fix this!");
-
-		auto out = &out_f.X;
-		const auto in = &in_f.X;
-
-		for (const auto& [column, row, multiplier] : assignments)
-			out[row] = in[column] * factor * multiplier;
-
-		return out_f;
+		return kernel(in_f, factor);
 	}
 
 	FTransform TransformationConverter::convert_matrix_proto(const generated::Matrix& in) const
@@ -144,92 +232,29 @@ namespace Transformation
 
 	FQuat TransformationConverter::convert_quaternion_proto(const generated::quaternion& in) const
 	{
-		FQuat out;
-
-		if (hand_changed)
-			out.W = -in.w();
-		else
-			out.W = in.w();
-
-		static_assert(sizeof(FQuat) == 4 * sizeof(double), "Engine related code changed; Fix this!");
-
-		auto coeffs = &out.X;
-
-		using namespace std;
-		const auto in_c = to_array<float>({ in.x(), in.y(), in.z() });
-
-		for (const auto& [column, row, multiplier] : assignments)
-			coeffs[row] = in_c[column] * multiplier;
+		const FVector axes = kernel(FVector(in.x(), in.y(), in.z()), 1.);
 
-		return out;
+		return FQuat(axes.X, axes.Y, axes.Z, hand_changed ? -in.w() : in.w());
 	}
 
 	FVector TransformationConverter::convert_point_proto(const generated::vertex_3d& in_f) const
 	{
-		FVector out_f;
-
-		static_assert(sizeof(FVector) == 3 * sizeof(double), "Engine related code changed; Fix this!");
-
-		auto out = &out_f.X;
-
-		using namespace std;
-		const auto in = to_array({ in_f.x(), in_f.y(), in_f.z()});
-
-		for (const auto& [column, row, multiplier] : assignments)
-			out[row] = in[column] * factor * multiplier;
-
-		return out_f;
+		return kernel(FVector(in_f.x(), in_f.y(), in_f.z()), factor);
 	}
 
 	FVector TransformationConverter::convert_point_proto(const generated::vertex_3d_no_scale& in_f) const
 	{
-		FVector out_f;
-
-		static_assert(sizeof(FVector) == 3 * sizeof(double), "Engine related code changed; Fix this!");
-
-		auto out = &out_f.X;
-
-		using namespace std;
-		const auto in = to_array({ in_f.x(), in_f.y(), in_f.z() });
-
-		for (const auto& [column, row, multiplier] : assignments)
-			out[row] = in[column] * multiplier;
-
-		return out_f;
+		return kernel(FVector(in_f.x(), in_f.y(), in_f.z()), 1.);
 	}
 
 	FVector TransformationConverter::convert_index_proto(const generated::index_3d& in_f) const
 	{
-		FVector out_f;
-
-		static_assert(sizeof(FVector) == 3 * sizeof(double), "Engine related code changed; Fix this!");
-
-		auto out = &out_f.X;
-
-		using namespace std;
-		const auto in = to_array({ in_f.x(), in_f.y(), in_f.z() });
-
-		for (const auto& [column, row, multiplier] : assignments)
-			out[row] = static_cast<float>(in[column]) * multiplier;
-
-		return out_f;
+		return kernel(FVector(in_f.x(), in_f.y(), in_f.z()), 1.);
 	}
 
 	FVector TransformationConverter::convert_size_proto(const generated::size_3d& in_f) const
 	{
-		FVector out_f;
-
-		static_assert(sizeof(FVector) == 3 * sizeof(double), "Engine related code changed; Fix this!");
-
-		auto out = &out_f.X;
-
-		using namespace std;
-		const auto in = to_array({ in_f.x(), in_f.y(), in_f.z() });
-
-		for (const auto& [column, row, multiplier] : assignments)
-			out[row] = in[column] * factor;
-
-		return out_f;
+		return unsigned_kernel(FVector(in_f.x(), in_f.y(), in_f.z()), factor);
 	}
 
 	generated::Matrix TransformationConverter::convert_matrix_proto(const FTransform& in) const
@@ -239,47 +264,84 @@ namespace Transformation
 
 	generated::quaternion TransformationConverter::convert_quaternion_proto(const FQuat& in) const
 	{
+		const FVector axes = kernel(FVector(in.X, in.Y, in.Z), 1.);
+
 		generated::quaternion out;
+		out.set_x(axes.X);
+		out.set_y(axes.Y);
+		out.set_z(axes.Z);
+		out.set_w(hand_changed ? -in.W : in.W);
 
-		if (hand_changed)
-			out.set_w(-in.W);
-		else
-			out.set_w(in.W);
+		return out;
+	}
 
-		static_assert(sizeof(FQuat) == 4 * sizeof(double), "Engine related code changed; Fix this!");
+	generated::vertex_3d TransformationConverter::convert_point_proto(const FVector& in_f) const
+	{
+		const FVector out = kernel(in_f, factor);
 
-		using namespace std;
-		auto coeffs = to_array({
-			&generated::quaternion::set_x,
-			&generated::quaternion::set_y,
-			&generated::quaternion::set_z,
-		});
-		const auto in_c = &in.X;
+		generated::vertex_3d out_f;
+		out_f.set_x(out.X);
+		out_f.set_y(out.Y);
+		out_f.set_z(out.Z);
 
-		for (const auto& [column, row, multiplier] : assignments)
-			(out.*coeffs[row])(in_c[column] * multiplier);
+		return out_f;
+	}
 
-		return out;
+	void TransformationConverter::convert_proto_span(std::span<const generated::vertex_3d* const> in, std::span<FVector> out) const
+	{
+		convert_blocks(in, make_axis_rows(assignments, factor, true),
+			[out](size_t i, double x, double y, double z)
+			{
+				out[i] = FVector(x, y, z);
+			});
 	}
 
-	generated::vertex_3d TransformationConverter::convert_point_proto(const FVector& in_f) const
+	void TransformationConverter::convert_proto_span(std::span<const generated::vertex_3d_no_scale* const> in, std::span<FVector> out) const
 	{
-		generated::vertex_3d out_f;
+		convert_blocks(in, make_axis_rows(assignments, 1., true),
+			[out](size_t i, double x, double y, double z)
+			{
+				out[i] = FVector(x, y, z);
+			});
+	}
 
-		static_assert(sizeof(FVector) == 3 * sizeof(double), "Engine related code changed; Fix this!");
+	void TransformationConverter::convert_proto_span(std::span<const generated::index_3d* const> in, std::span<FVector> out) const
+	{
+		convert_blocks(in, make_axis_rows(assignments, 1., true),
+			[out](size_t i, double x, double y, double z)
+			{
+				out[i] = FVector(x, y, z);
+			});
+	}
 
-		using namespace std;
-		auto out = to_array({
-			&generated::vertex_3d::set_x,
-			&generated::vertex_3d::set_y,
-			&generated::vertex_3d::set_z,
+	void TransformationConverter::convert_proto_span(std::span<const generated::size_3d* const> in, std::span<FVector> out) const
+	{
+		convert_blocks(in, make_axis_rows(assignments, factor, false),
+			[out](size_t i, double x, double y, double z)
+			{
+				out[i] = FVector(x, y, z);
 			});
-		const auto in = &in_f.X;
+	}
 
-		for (const auto& [column, row, multiplier] : assignments)
-			(out_f.*out[row])(in[column] * factor * multiplier);
+	void TransformationConverter::convert_proto_span(std::span<const generated::quaternion* const> in, std::span<FQuat> out) const
+	{
+		const double sign_w = hand_changed ? -1. : 1.;
+		convert_blocks(in, make_axis_rows(assignments, 1., true),
+			[in, out, sign_w](size_t i, double x, double y, double z)
+			{
+				out[i] = FQuat(x, y, z, sign_w * in[i]->w());
+			});
+	}
 
-		return out_f;
+	void TransformationConverter::convert_proto_span(std::span<const generated::vertex_3d* const> in, std::span<float> out) const
+	{
+		convert_blocks(in, make_axis_rows(assignments, factor, true),
+			[out](size_t i, double x, double y, double z)
+			{
+				out[3 * i] = static_cast<float>(x);
+				out[3 * i + 1] = static_cast<float>(y);
+				out[3 * i + 2] = static_cast<float>(z);
+			});
 	}
 
 	float TransformationConverter::convert_scale(float scale) const
@@ -430,7 +492,8 @@ namespace Transformation
 	}
 
 	TransformationConverter::TransformationConverter(const TransformationMeta& origin, const TransformationMeta& target)
-		: factor(origin.scale.factor(target.scale)), assignments(compute_assignments(origin, target)), hand_changed(origin.isRightHanded() != target.isRightHanded())
+		: factor(origin.scale.factor(target.scale)), assignments(compute_assignments(origin, target)), hand_changed(origin.isRightHanded() != target.isRightHanded()),
+		kernel(axis_kernels[kernel_index(assignments, true)]), unsigned_kernel(axis_kernels[kernel_index(assignments, false)])
 	{}
 
 	const AxisAlignment& TransformationMeta::right() const
@@ -4,6 +4,7 @@
 #include <ratio>
 #include <tuple>
 #include <array>
+#include <span>
 
 #include "Math/Vector.h"
 #include "Math/TransformVectorized.h"
@@ -75,6 +76,12 @@ namespace Transformation
 	typedef std::tuple<int8_t, int8_t, float> Assignment;
 	typedef std::array<Assignment, 3> SparseAssignments;
 
+	/**
+	 * out[row] = in[column] * multiplier * scale
+	 * specialized for one of the 48 signed axis permutations
+	 */
+	typedef FVector(*AxisKernel)(const FVector& in, double scale);
+
 	class TransformationMeta;
 	static Assignment compute_assignment(AxisAlignment axis, AxisAlignment target_axis);
 	static SparseAssignments compute_assignments(const TransformationMeta& origin, const TransformationMeta& target);
@@ -103,6 +110,25 @@ namespace Transformation
 		[[nodiscard]] generated::quaternion convert_quaternion_proto(const FQuat& in) const;
 		[[nodiscard]] generated::vertex_3d convert_point_proto(const FVector& in) const;
 
+		/**
+		 * bulk versions of the element wise proto conversions
+		 * e.g. for all vertices of a mesh, elements are processed in blocks
+		 * as structure of arrays so the arithmetic runs in SIMD lanes
+		 *
+		 * @attend out has to hold in.size() elements
+		 */
+		void convert_proto_span(std::span<const generated::vertex_3d* const> in, std::span<FVector> out) const;
+		void convert_proto_span(std::span<const generated::vertex_3d_no_scale* const> in, std::span<FVector> out) const;
+		void convert_proto_span(std::span<const generated::index_3d* const> in, std::span<FVector> out) const;
+		void convert_proto_span(std::span<const generated::size_3d* const> in, std::span<FVector> out) const;
+		void convert_proto_span(std::span<const generated::quaternion* const> in, std::span<FQuat> out) const;
+
+		/**
+		 * @param out interleaved x, y, z
+		 * @attend out has to hold 3 * in.size() elements
+		 */
+		void convert_proto_span(std::span<const generated::vertex_3d* const> in, std::span<float> out) const;
+
 
 		[[nodiscard]] float convert_scale(float scale) const;
 
@@ -115,6 +141,13 @@ namespace Transformation
 		float factor;
 		SparseAssignments assignments;
 		bool hand_changed;
+
+		/**
+		 * kernels of assignments, selected once on construction
+		 * unsigned_kernel ignores the multipliers e.g. for sizes
+		 */
+		AxisKernel kernel;
+		AxisKernel unsigned_kernel;
 	};
 
 	class TransformationMeta
@@ -3,4 +3,12 @@
 #include "ar_integration.h"
 #include "Modules/ModuleManager.h"
 
-IMPLEMENT_PRIMARY_GAME_MODULE( FDefaultGameModuleImpl, ar_integration, "ar_integration" );
+#include "stream_executor.h"
+
+void F_ar_integration_module::ShutdownModule()
+{
+	if (!stream_executor::shutdown())
+		UE_LOG(LogTemp, Warning, TEXT("[ar_integration] Streams did not finish, leaking the stream executor"));
+}
+
+IMPLEMENT_PRIMARY_GAME_MODULE( F_ar_integration_module, ar_integration, "ar_integration" );
@@ -2,4 +2,18 @@
 
 #pragma once
 
-#include "CoreMinimal.h"
\ No newline at end of file
+#include "CoreMinimal.h"
+#include "Modules/ModuleManager.h"
+
+/**
+ * @class F_ar_integration_module
+ *
+ * stops the process wide @ref{stream_executor} on shutdown
+ * instead of leaving it to static destruction
+ */
+class F_ar_integration_module : public FDefaultGameModuleImpl
+{
+public:
+
+	virtual void ShutdownModule() override;
+};
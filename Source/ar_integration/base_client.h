@@ -78,28 +78,34 @@ public:
 
 
 /**
- * TODO::
- * remove old dynamic from on_state_change if
- * channel changes in set_channel_Implementation
+ * stubs and streams are created on the channel of TrafficClass
+ * see @ref{traffic_class}, state_change reports the
+ * state of that channel only
  */
-#define BASE_CLIENT_BODY(CreatorFN)									\
+#define BASE_CLIENT_BODY_CLASS(TrafficClass, ...)					\
 	protected:														\
 	UPROPERTY()														\
 	U_grpc_channel* channel = nullptr;								\
 	mutable std::mutex channel_mutex;								\
+	inline static constexpr traffic_class channel_class = TrafficClass;	\
 																	\
 	public:															\
 	void set_channel_Implementation(U_grpc_channel* ch) override	\
 	{																\
-		if (!ch || !ch->channel) return;							\
+		if (!ch || !ch->get_channel(TrafficClass)) return;			\
 		I_Base_Client_Interface::Execute_stop(this);				\
 																	\
 		std::unique_lock lock(channel_mutex);						\
 																	\
-		CreatorFunction creator = CreatorFN;						\
-		creator(ch->channel);										\
+		CreatorFunction creator = __VA_ARGS__;						\
+		creator(ch->get_channel(TrafficClass));						\
 																	\
-		ch->on_state_change.AddDynamic(this, &std::remove_reference_t<decltype(*this)>::state_change);	\
+		if (this->channel)											\
+			this->channel->on_class_state_change(TrafficClass).RemoveDynamic(this, &std::remove_reference_t<decltype(*this)>::state_change);	\
+		ch->on_class_state_change(TrafficClass).AddUniqueDynamic(this, &std::remove_reference_t<decltype(*this)>::state_change);	\
 																	\
 		this->channel = ch;											\
 	}																\
+
+#define BASE_CLIENT_BODY(...)										\
+	BASE_CLIENT_BODY_CLASS(traffic_class::CONTROL, __VA_ARGS__)
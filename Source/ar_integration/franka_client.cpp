@@ -3,6 +3,20 @@
 #include "util.h"
 #include "Franka.h"
 
+namespace
+{
+	/**
+	 * a dropped message may be the only one carrying the
+	 * transformation meta, hand it on to its successor
+	 */
+	template<typename Data>
+	void carry_meta(Data& dropped, Data& incoming)
+	{
+		if (dropped.has_transformation_meta() && !incoming.has_transformation_meta())
+			*incoming.mutable_transformation_meta() = std::move(*dropped.mutable_transformation_meta());
+	}
+}
+
 U_franka_client::~U_franka_client()
 {
 	U_franka_client::stop_Implementation();
@@ -11,45 +25,77 @@ U_franka_client::~U_franka_client()
 void U_franka_client::async_transmit_data()
 {
 	if (!channel ||
-		thread && !thread->done()) return;
+		stream && !stream->done()) return;
+
+	tf_wrapper = TF_Conv_Wrapper();
+	if (!consume_handle.IsValid())
+		consume_handle = FTSTicker::GetCoreTicker().AddTicker(
+			FTickerDelegate::CreateUObject(this, &U_franka_client::consume));
 
-	thread = std::make_unique<stream_thread>(
-		[this](grpc::ClientContext& ctx)
+	constexpr const char* method = "/generated.robot_com/transmit_voxels";
+	stream = std::make_unique<async_stream_reader<generated::Voxel_Transmission>>(
+		[ch = channel->get_channel(channel_class)](grpc::ClientContext& ctx, grpc::CompletionQueue* cq)
+		{
+			ctx.set_compression_algorithm(GRPC_COMPRESS_GZIP);
+			return prepare_stream(ch.get(), method, ctx, google::protobuf::Empty(), cq);
+		},
+		[this](message_pool<generated::Voxel_Transmission>::handle& data)
 		{
-			if (this->transmit_data(ctx).error_code() == grpc::StatusCode::UNKNOWN)
+			/**
+			 * state updates bypass the mailbox but flush it
+			 * first to keep the order of data and state
+			 */
+			if (data->has_state_update())
+			{
+				FFunctionGraphTask::CreateAndDispatchWhenReady([this, state = static_cast<Visual_Change>(data->state_update())]()
+					{
+						consume(0.f);
+						on_visual_change.Broadcast(state);
+					},
+					TStatId{}, nullptr, ENamedThreads::GameThread);
+				return;
+			}
+
+			mailbox.post(std::move(data), [](auto& dropped, auto& incoming)
+				{
+					carry_meta(*dropped->mutable_voxels_data(), *incoming->mutable_voxels_data());
+				});
+		},
+		[this](const grpc::Status& status)
+		{
+			if (status.error_code() == grpc::StatusCode::UNKNOWN)
 				disconnected = true;
-		});
+		},
+		&pool, channel->get_method_stats(method));
 }
 
-grpc::Status U_franka_client::transmit_data(grpc::ClientContext& ctx)
+F_mailbox_stats U_franka_client::get_mailbox_stats() const
 {
-	ctx.set_compression_algorithm(GRPC_COMPRESS_GZIP);
-
-	google::protobuf::Empty empty;
-	const auto stream =
-		stub->transmit_voxels(&ctx, empty);
-	stream->WaitForInitialMetadata();
-
-	TF_Conv_Wrapper tf_wrapper;
-	generated::Voxel_Transmission data;
+	return F_mailbox_stats(mailbox.stats());
+}
 
-	while (stream->Read(&data))
-	{
-		FFunctionGraphTask::CreateAndDispatchWhenReady([this, voxel_data = convert_meta<Voxel_Data>(data, tf_wrapper)]()
-			{
-				if (voxel_data.IsType<F_voxel_data>())
-					on_voxel_data.Broadcast(voxel_data.Get<F_voxel_data>());
-				else
-					on_visual_change.Broadcast(voxel_data.Get<Visual_Change>());
-			},
-			TStatId{}, nullptr, ENamedThreads::GameThread);
-	}
-	return stream->Finish();
+bool U_franka_client::consume(float delta_seconds)
+{
+	message_pool<generated::Voxel_Transmission>::handle data;
+	if (!mailbox.take(data))
+		return true;
+
+	const auto voxel_data = convert_meta<Voxel_Data>(*data, tf_wrapper);
+	if (voxel_data.IsType<F_voxel_data>())
+		on_voxel_data.Broadcast(voxel_data.Get<F_voxel_data>());
+	return true;
 }
 
 void U_franka_client::stop_Implementation()
 {
-	thread.reset();
+	stream.reset();
+
+	if (consume_handle.IsValid())
+	{
+		FTSTicker::GetCoreTicker().RemoveTicker(consume_handle);
+		consume_handle.Reset();
+	}
+	mailbox.clear();
 }
 
 void U_franka_client::state_change_Implementation(connection_state old_state, connection_state new_state)
@@ -74,45 +120,77 @@ U_franka_tcp_client::~U_franka_tcp_client()
 void U_franka_tcp_client::async_transmit_data()
 {
 	if (!channel ||
-		thread && !thread->done()) return;
+		stream && !stream->done()) return;
+
+	tf_wrapper = TF_Conv_Wrapper();
+	if (!consume_handle.IsValid())
+		consume_handle = FTSTicker::GetCoreTicker().AddTicker(
+			FTickerDelegate::CreateUObject(this, &U_franka_tcp_client::consume));
 
-	thread = std::make_unique<stream_thread>(
-		[this](grpc::ClientContext& ctx)
+	constexpr const char* method = "/generated.robot_com/transmit_tcps";
+	stream = std::make_unique<async_stream_reader<generated::Tcps_Transmission>>(
+		[ch = channel->get_channel(channel_class)](grpc::ClientContext& ctx, grpc::CompletionQueue* cq)
+		{
+			ctx.set_compression_algorithm(GRPC_COMPRESS_GZIP);
+			return prepare_stream(ch.get(), method, ctx, google::protobuf::Empty(), cq);
+		},
+		[this](message_pool<generated::Tcps_Transmission>::handle& data)
 		{
-			if (this->transmit_data(ctx).error_code() == grpc::StatusCode::UNKNOWN)
+			/**
+			 * state updates bypass the mailbox but flush it
+			 * first to keep the order of data and state
+			 */
+			if (data->has_state_update())
+			{
+				FFunctionGraphTask::CreateAndDispatchWhenReady([this, state = static_cast<Visual_Change>(data->state_update())]()
+					{
+						consume(0.f);
+						on_visual_change.Broadcast(state);
+					},
+					TStatId{}, nullptr, ENamedThreads::GameThread);
+				return;
+			}
+
+			mailbox.post(std::move(data), [](auto& dropped, auto& incoming)
+				{
+					carry_meta(*dropped->mutable_tcps_data(), *incoming->mutable_tcps_data());
+				});
+		},
+		[this](const grpc::Status& status)
+		{
+			if (status.error_code() == grpc::StatusCode::UNKNOWN)
 				disconnected = true;
-		});
+		},
+		&pool, channel->get_method_stats(method));
 }
 
-grpc::Status U_franka_tcp_client::transmit_data(grpc::ClientContext& ctx)
+F_mailbox_stats U_franka_tcp_client::get_mailbox_stats() const
 {
-	ctx.set_compression_algorithm(GRPC_COMPRESS_GZIP);
-
-	google::protobuf::Empty empty;
-	const auto stream =
-		stub->transmit_tcps(&ctx, empty);
-	stream->WaitForInitialMetadata();
-
-	TF_Conv_Wrapper tf_wrapper;
-	generated::Tcps_Transmission data;
+	return F_mailbox_stats(mailbox.stats());
+}
 
-	while (stream->Read(&data))
-	{
-		FFunctionGraphTask::CreateAndDispatchWhenReady([this, tcp_data = convert_meta<Tcps_Data>(data, tf_wrapper)/*convert_meta<TArray<FVector>>(data, tf_wrapper)*/]()
-			{
-				if (tcp_data.IsType<TArray<FVector>>())
-					on_tcp_data.Broadcast(tcp_data.Get<TArray<FVector>>());
-				else
-					on_visual_change.Broadcast(tcp_data.Get<Visual_Change>());
-			},
-			TStatId{}, nullptr, ENamedThreads::GameThread);
-	}
-	return stream->Finish();
+bool U_franka_tcp_client::consume(float delta_seconds)
+{
+	message_pool<generated::Tcps_Transmission>::handle data;
+	if (!mailbox.take(data))
+		return true;
+
+	const auto tcp_data = convert_meta<Tcps_Data>(*data, tf_wrapper);
+	if (tcp_data.IsType<TArray<FVector>>())
+		on_tcp_data.Broadcast(tcp_data.Get<TArray<FVector>>());
+	return true;
 }
 
 void U_franka_tcp_client::stop_Implementation()
 {
-	thread.reset();
+	stream.reset();
+
+	if (consume_handle.IsValid())
+	{
+		FTSTicker::GetCoreTicker().RemoveTicker(consume_handle);
+		consume_handle.Reset();
+	}
+	mailbox.clear();
 }
 
 void U_franka_tcp_client::state_change_Implementation(connection_state old_state, connection_state new_state)
@@ -132,40 +210,34 @@ void U_franka_tcp_client::state_change_Implementation(connection_state old_state
 void U_franka_joint_client::async_transmit_data()
 {
 	if (!channel ||
-		thread && !thread->done()) return;
+		stream && !stream->done()) return;
 
-	thread = std::make_unique<stream_thread>(
-		[this](grpc::ClientContext& ctx)
+	constexpr const char* method = "/generated.robot_com/transmit_joints";
+	stream = std::make_unique<async_stream_reader<generated::Joints>>(
+		[ch = channel->get_channel(channel_class)](grpc::ClientContext& ctx, grpc::CompletionQueue* cq)
+		{
+			ctx.set_compression_algorithm(GRPC_COMPRESS_GZIP);
+			return prepare_stream(ch.get(), method, ctx, google::protobuf::Empty(), cq);
+		},
+		[this](message_pool<generated::Joints>::handle& data)
+		{
+			FFunctionGraphTask::CreateAndDispatchWhenReady([this, joint_data = convert<FFrankaJoints>(*data)]()
+				{
+					on_joint_data.Broadcast(joint_data);
+				},
+				TStatId{}, nullptr, ENamedThreads::GameThread);
+		},
+		[this](const grpc::Status& status)
 		{
-			if (this->transmit_data(ctx).error_code() == grpc::StatusCode::UNKNOWN)
+			if (status.error_code() == grpc::StatusCode::UNKNOWN)
 				disconnected = true;
-		});
-}
-
-grpc::Status U_franka_joint_client::transmit_data(grpc::ClientContext& ctx)
-{
-	ctx.set_compression_algorithm(GRPC_COMPRESS_GZIP);
-
-	google::protobuf::Empty empty;
-	const auto stream =
-		stub->transmit_joints(&ctx, empty);
-	stream->WaitForInitialMetadata();
-
-	generated::Joints data;
-	while (stream->Read(&data))
-	{
-		FFunctionGraphTask::CreateAndDispatchWhenReady([this, joint_data = convert<FFrankaJoints>(data)]()
-			{
-				on_joint_data.Broadcast(joint_data);
-			},
-			TStatId{}, nullptr, ENamedThreads::GameThread);
-	}
-	return stream->Finish();
+		},
+		&pool, channel->get_method_stats(method));
 }
 
 void U_franka_joint_client::stop_Implementation()
 {
-	thread.reset();
+	stream.reset();
 }
 
 void U_franka_joint_client::state_change_Implementation(connection_state old_state, connection_state new_state)
@@ -188,43 +260,73 @@ U_franka_joint_sync_client::~U_franka_joint_sync_client()
 void U_franka_joint_sync_client::async_transmit_data()
 {
 	if (!channel ||
-		thread && !thread->done()) return;
+		stream && !stream->done()) return;
+
+	if (!consume_handle.IsValid())
+		consume_handle = FTSTicker::GetCoreTicker().AddTicker(
+			FTickerDelegate::CreateUObject(this, &U_franka_joint_sync_client::consume));
 
-	thread = std::make_unique<stream_thread>(
-		[this](grpc::ClientContext& ctx)
+	constexpr const char* method = "/generated.robot_com/transmit_sync_joints";
+	stream = std::make_unique<async_stream_reader<generated::Sync_Joints_Transmission>>(
+		[ch = channel->get_channel(channel_class)](grpc::ClientContext& ctx, grpc::CompletionQueue* cq)
 		{
-			if (this->transmit_data(ctx).error_code() == grpc::StatusCode::UNKNOWN)
+			ctx.set_compression_algorithm(GRPC_COMPRESS_GZIP);
+			return prepare_stream(ch.get(), method, ctx, google::protobuf::Empty(), cq);
+		},
+		[this](message_pool<generated::Sync_Joints_Transmission>::handle& data)
+		{
+			/**
+			 * state updates bypass the mailbox but flush it
+			 * first to keep the order of data and state
+			 */
+			if (data->has_state_update())
+			{
+				FFunctionGraphTask::CreateAndDispatchWhenReady([this, state = static_cast<Visual_Change>(data->state_update())]()
+					{
+						consume(0.f);
+						on_visual_change.Broadcast(state);
+					},
+					TStatId{}, nullptr, ENamedThreads::GameThread);
+				return;
+			}
+
+			mailbox.post(std::move(data));
+		},
+		[this](const grpc::Status& status)
+		{
+			if (status.error_code() == grpc::StatusCode::UNKNOWN)
 				disconnected = true;
-		});
+		},
+		&pool, channel->get_method_stats(method));
 }
 
-grpc::Status U_franka_joint_sync_client::transmit_data(grpc::ClientContext& ctx)
+F_mailbox_stats U_franka_joint_sync_client::get_mailbox_stats() const
 {
-	ctx.set_compression_algorithm(GRPC_COMPRESS_GZIP);
-
-	google::protobuf::Empty empty;
-	const auto stream =
-		stub->transmit_sync_joints(&ctx, empty);
-	stream->WaitForInitialMetadata();
+	return F_mailbox_stats(mailbox.stats());
+}
 
-	generated::Sync_Joints_Transmission data;
-	while (stream->Read(&data))
-	{
-		FFunctionGraphTask::CreateAndDispatchWhenReady([this, sync_joint_data = convert<Sync_Joints_Data>(data)]()
-			{
-				if (sync_joint_data.IsType<TArray<F_joints_synced>>())
-					on_sync_joint_data.Broadcast(sync_joint_data.Get<TArray<F_joints_synced>>());
-				else
-					on_visual_change.Broadcast(sync_joint_data.Get<Visual_Change>());
-			},
-			TStatId{}, nullptr, ENamedThreads::GameThread);
-	}
-	return stream->Finish();
+bool U_franka_joint_sync_client::consume(float delta_seconds)
+{
+	message_pool<generated::Sync_Joints_Transmission>::handle data;
+	if (!mailbox.take(data))
+		return true;
+
+	const auto sync_joint_data = convert<Sync_Joints_Data>(*data);
+	if (sync_joint_data.IsType<TArray<F_joints_synced>>())
+		on_sync_joint_data.Broadcast(sync_joint_data.Get<TArray<F_joints_synced>>());
+	return true;
 }
 
 void U_franka_joint_sync_client::stop_Implementation()
 {
-	thread.reset();
+	stream.reset();
+
+	if (consume_handle.IsValid())
+	{
+		FTSTicker::GetCoreTicker().RemoveTicker(consume_handle);
+		consume_handle.Reset();
+	}
+	mailbox.clear();
 }
 
 void U_franka_joint_sync_client::state_change_Implementation(connection_state old_state, connection_state new_state)
@@ -7,7 +7,11 @@
 #include "grpc_channel.h"
 #include "base_client.h"
 
-#include "stream_thread.h"
+#include "stream_executor.h"
+#include "latest_mailbox.h"
+#include "util.h"
+
+#include "Containers/Ticker.h"
 
 #include "grpc_include_begin.h"
 #include "robot.grpc.pb.h"
@@ -26,6 +30,35 @@ enum class franka_client_status : uint8
 */
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnVisualChange, Visual_Change, new_state);
 
+/**
+ * @struct F_mailbox_stats
+ * counters of the latest value mailbox of a franka client
+ * see @ref{mailbox_stats}
+ */
+USTRUCT(BlueprintType)
+struct F_mailbox_stats
+{
+	GENERATED_BODY()
+
+	UPROPERTY(BlueprintReadOnly)
+	int64 posted = 0;
+
+	UPROPERTY(BlueprintReadOnly)
+	int64 consumed = 0;
+
+	UPROPERTY(BlueprintReadOnly)
+	int64 dropped = 0;
+
+	UPROPERTY(BlueprintReadOnly)
+	int64 stale = 0;
+
+	F_mailbox_stats() = default;
+
+	explicit F_mailbox_stats(const mailbox_stats& stats)
+		: posted(stats.posted), consumed(stats.consumed), dropped(stats.dropped), stale(stats.stale)
+	{}
+};
+
 /*
 #define AUTO_RECONNECT() \
 	void state_change_Implementation(connection_state old_state, connection_state new_state) override	\
@@ -53,7 +86,11 @@ public:
 	UFUNCTION(BlueprintCallable)
 	void async_transmit_data();
 
-	grpc::Status transmit_data(grpc::ClientContext& ctx);
+	/**
+	 * @returns counters of the received data messages
+	 */
+	UFUNCTION(BlueprintCallable)
+	F_mailbox_stats get_mailbox_stats() const;
 
 	void stop_Implementation() override;
 	void state_change_Implementation(connection_state old_state, connection_state new_state) override;
@@ -63,12 +100,24 @@ public:
 
 private:
 
-	bool disconnected = false;
+	std::atomic_bool disconnected = false;
+
+	/**
+	 * emits the newest message of @ref{mailbox} once per frame
+	 * state updates bypass the mailbox
+	 */
+	bool consume(float delta_seconds);
+
+	message_pool<generated::Voxel_Transmission> pool;
+	std::unique_ptr<async_stream_reader<generated::Voxel_Transmission>> stream;
+
+	latest_mailbox<message_pool<generated::Voxel_Transmission>::handle> mailbox;
+	FTSTicker::FDelegateHandle consume_handle;
+	TF_Conv_Wrapper tf_wrapper;
 
-	std::unique_ptr<stream_thread> thread;
 	std::unique_ptr<generated::robot_com::Stub> stub;
 
-	BASE_CLIENT_BODY(
+	BASE_CLIENT_BODY_CLASS(traffic_class::BULK,
 		[this](const std::shared_ptr<grpc::Channel>& ch)
 		{
 			stub = generated::robot_com::NewStub(ch);
@@ -90,7 +139,11 @@ public:
 	UFUNCTION(BlueprintCallable)
 	void async_transmit_data();
 
-	grpc::Status transmit_data(grpc::ClientContext& ctx);
+	/**
+	 * @returns counters of the received data messages
+	 */
+	UFUNCTION(BlueprintCallable)
+	F_mailbox_stats get_mailbox_stats() const;
 
 	void stop_Implementation() override;
 	void state_change_Implementation(connection_state old_state, connection_state new_state) override;
@@ -100,12 +153,24 @@ public:
 
 private:
 
-	bool disconnected = false;
+	std::atomic_bool disconnected = false;
+
+	/**
+	 * emits the newest message of @ref{mailbox} once per frame
+	 * state updates bypass the mailbox
+	 */
+	bool consume(float delta_seconds);
+
+	message_pool<generated::Tcps_Transmission> pool;
+	std::unique_ptr<async_stream_reader<generated::Tcps_Transmission>> stream;
+
+	latest_mailbox<message_pool<generated::Tcps_Transmission>::handle> mailbox;
+	FTSTicker::FDelegateHandle consume_handle;
+	TF_Conv_Wrapper tf_wrapper;
 
-	std::unique_ptr<stream_thread> thread;
 	std::unique_ptr<generated::robot_com::Stub> stub;
 
-	BASE_CLIENT_BODY(
+	BASE_CLIENT_BODY_CLASS(traffic_class::REALTIME,
 		[this](const std::shared_ptr<grpc::Channel>& ch)
 		{
 			stub = generated::robot_com::NewStub(ch);
@@ -126,8 +191,6 @@ public:
 	UFUNCTION(BlueprintCallable)
 	void async_transmit_data();
 
-	grpc::Status transmit_data(grpc::ClientContext& ctx);
-
 	void stop_Implementation() override;
 	void state_change_Implementation(connection_state old_state, connection_state new_state) override;
 
@@ -135,12 +198,13 @@ public:
 
 private:
 
-	bool disconnected = false;
+	std::atomic_bool disconnected = false;
 
-	std::unique_ptr<stream_thread> thread;
+	message_pool<generated::Joints> pool;
+	std::unique_ptr<async_stream_reader<generated::Joints>> stream;
 	std::unique_ptr<generated::robot_com::Stub> stub;
 
-	BASE_CLIENT_BODY(
+	BASE_CLIENT_BODY_CLASS(traffic_class::REALTIME,
 		[this](const std::shared_ptr<grpc::Channel>& ch)
 		{
 			stub = generated::robot_com::NewStub(ch);
@@ -163,7 +227,11 @@ public:
 	UFUNCTION(BlueprintCallable)
 	void async_transmit_data();
 
-	grpc::Status transmit_data(grpc::ClientContext& ctx);
+	/**
+	 * @returns counters of the received data messages
+	 */
+	UFUNCTION(BlueprintCallable)
+	F_mailbox_stats get_mailbox_stats() const;
 
 	void stop_Implementation() override;
 	void state_change_Implementation(connection_state old_state, connection_state new_state) override;
@@ -173,12 +241,23 @@ public:
 
 private:
 
-	bool disconnected = false;
+	std::atomic_bool disconnected = false;
+
+	/**
+	 * emits the newest message of @ref{mailbox} once per frame
+	 * state updates bypass the mailbox
+	 */
+	bool consume(float delta_seconds);
+
+	message_pool<generated::Sync_Joints_Transmission> pool;
+	std::unique_ptr<async_stream_reader<generated::Sync_Joints_Transmission>> stream;
+
+	latest_mailbox<message_pool<generated::Sync_Joints_Transmission>::handle> mailbox;
+	FTSTicker::FDelegateHandle consume_handle;
 
-	std::unique_ptr<stream_thread> thread;
 	std::unique_ptr<generated::robot_com::Stub> stub;
 
-	BASE_CLIENT_BODY(
+	BASE_CLIENT_BODY_CLASS(traffic_class::REALTIME,
 		[this](const std::shared_ptr<grpc::Channel>& ch)
 		{
 			stub = generated::robot_com::NewStub(ch);
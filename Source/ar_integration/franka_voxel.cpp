@@ -2,6 +2,7 @@
 
 #include "grpc_wrapper.h"
 #include "Components/InstancedStaticMeshComponent.h"
+#include "Async/Async.h"
 
 A_franka_voxel::A_franka_voxel()
 {
@@ -34,6 +35,17 @@ A_franka_voxel::A_franka_voxel()
 
 	instanced->AttachToComponent(root,
 		FAttachmentTransformRules::KeepRelativeTransform);
+
+	/**
+	 * setup surface mesh component
+	 */
+	surface = CreateDefaultSubobject<UProceduralMeshComponent>(TEXT("surface_component"));
+	surface->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+	surface->bUseAsyncCooking = true;
+	surface->SetMobility(EComponentMobility::Movable);
+
+	surface->AttachToComponent(root,
+		FAttachmentTransformRules::KeepRelativeTransform);
 }
 
 void A_franka_voxel::Tick(float DeltaSeconds)
@@ -48,26 +60,237 @@ void A_franka_voxel::BeginDestroy()
 
 void A_franka_voxel::set_voxels(const F_voxel_data& data)
 {
-	instanced->ClearInstances();
+	if (render_mode == voxel_render_mode::INSTANCED)
+	{
+		/**
+		 * discards a surface still being built
+		 */
+		++generation;
+		pending.Reset();
+		surface->ClearAllMeshSections();
+		set_instances(data);
+		return;
+	}
+
+	/**
+	 * only the latest voxels are built next
+	 */
+	if (building)
+		pending = data;
+	else
+		build_surface(data);
+}
+
+F_voxel_mesh_metrics A_franka_voxel::get_mesh_metrics() const
+{
+	return metrics;
+}
+
+void A_franka_voxel::set_instances(const F_voxel_data& data)
+{
+	const double start = FPlatformTime::Seconds();
+
 	instanced->SetRelativeTransform(data.robot_origin.Inverse() * FTransform(FQuat(FVector(0., 0., 1.), UE_PI / 2.f)));
 
-	TArray<FTransform> temp;
-	temp.Reserve(data.indices.Num());
+	/**
+	 * every transform changes with the side length
+	 */
+	if (data.voxel_side_length != instance_side_length ||
+		instanced->GetInstanceCount() != instance_voxels.Num())
+	{
+		clear_instances();
+		instance_side_length = data.voxel_side_length;
+	}
 
+	next_voxels.Reset();
+	next_voxels.Reserve(data.indices.Num());
 	for (const auto& p : data.indices)
+		next_voxels.Add(FIntVector(FMath::RoundToInt32(p.X), FMath::RoundToInt32(p.Y), FMath::RoundToInt32(p.Z)));
+
+	removed_slots.Reset();
+	for (int32 slot = 0; slot < instance_voxels.Num(); ++slot)
+		if (!next_voxels.Contains(instance_voxels[slot]))
+			removed_slots.Add(slot);
+
+	added_voxels.Reset();
+	for (const FIntVector& voxel : next_voxels)
+		if (!instance_of.Contains(voxel))
+			added_voxels.Add(voxel);
+
+	int64 moved = 0;
+
+	/**
+	 * added voxels take over the slots of removed ones
+	 */
+	const int32 reused = FMath::Min(removed_slots.Num(), added_voxels.Num());
+	for (int32 i = 0; i < reused; ++i)
+	{
+		const int32 slot = removed_slots[i];
+		const FIntVector& voxel = added_voxels[i];
+
+		instance_of.Remove(instance_voxels[slot]);
+		instance_voxels[slot] = voxel;
+		instance_of.Add(voxel, slot);
+
+		instanced->UpdateInstanceTransform(slot, instance_transform(voxel, instance_side_length), false, false, true);
+		++moved;
+	}
+
+	/**
+	 * swap remove the remaining slots from the back, so the
+	 * last instance is never one which is still to be removed
+	 */
+	const int32 previous_count = instance_voxels.Num();
+	for (int32 i = removed_slots.Num() - 1; i >= reused; --i)
+	{
+		const int32 slot = removed_slots[i];
+		const int32 last = instance_voxels.Num() - 1;
+
+		instance_of.Remove(instance_voxels[slot]);
+		if (slot != last)
+		{
+			const FIntVector voxel = instance_voxels[last];
+			instance_voxels[slot] = voxel;
+			instance_of[voxel] = slot;
+
+			instanced->UpdateInstanceTransform(slot, instance_transform(voxel, instance_side_length), false, false, true);
+			++moved;
+		}
+		instance_voxels.Pop(EAllowShrinking::No);
+	}
+
+	const int32 removed = previous_count - instance_voxels.Num();
+	if (removed > 0)
 	{
-		temp.Add(FTransform(FQuat::Identity,
-			p * data.voxel_side_length,
-			//Scale is multiplied by 0.01 because the default cube is
-			//1 meter in size instead of a centimeter
-			FVector(0.01 * data.voxel_side_length)));
+		/**
+		 * the tail is dropped at once
+		 */
+		TArray<int32> tail;
+		tail.Reserve(removed);
+		for (int32 slot = previous_count - 1; slot >= instance_voxels.Num(); --slot)
+			tail.Add(slot);
+		instanced->RemoveInstances(tail);
 	}
-	instanced->AddInstances(temp, false);
+
+	added_transforms.Reset();
+	for (int32 i = reused; i < added_voxels.Num(); ++i)
+	{
+		const FIntVector& voxel = added_voxels[i];
+		instance_of.Add(voxel, instance_voxels.Add(voxel));
+		added_transforms.Add(instance_transform(voxel, instance_side_length));
+	}
+
+	if (!added_transforms.IsEmpty())
+		instanced->AddInstances(added_transforms, false);
+
+	/**
+	 * moved instances were updated without touching the render state
+	 */
+	if (moved > 0)
+		instanced->MarkRenderStateDirty();
+
+	metrics.voxels = instance_voxels.Num();
+	metrics.triangles = 12 * metrics.voxels;
+	metrics.build_ms = static_cast<float>((FPlatformTime::Seconds() - start) * 1000.);
+	metrics.instances_added = added_transforms.Num();
+	metrics.instances_removed = removed;
+	metrics.instances_moved = moved;
 }
 
-void A_franka_voxel::clear_Implementation()
+void A_franka_voxel::clear_instances()
 {
 	instanced->ClearInstances();
+	instance_voxels.Reset();
+	instance_of.Reset();
+}
+
+FTransform A_franka_voxel::instance_transform(const FIntVector& voxel, float side_length)
+{
+	return FTransform(FQuat::Identity,
+		FVector(voxel) * side_length,
+		//Scale is multiplied by 0.01 because the default cube is
+		//1 meter in size instead of a centimeter
+		FVector(0.01 * side_length));
+}
+
+void A_franka_voxel::build_surface(F_voxel_data data)
+{
+	building = true;
+
+	Async(EAsyncExecution::ThreadPool,
+		[weak = TWeakObjectPtr<A_franka_voxel>(this), data = MoveTemp(data), generation = generation]() mutable
+		{
+			const double start = FPlatformTime::Seconds();
+
+			surface_build build;
+			build.generation = generation;
+			build.relative = data.robot_origin.Inverse() * FTransform(FQuat(FVector(0., 0., 1.), UE_PI / 2.f));
+			build.voxels = data.indices.Num();
+
+			TArray<FIntVector> indices;
+			indices.Reserve(data.indices.Num());
+			for (const auto& p : data.indices)
+				indices.Add(FIntVector(FMath::RoundToInt32(p.X), FMath::RoundToInt32(p.Y), FMath::RoundToInt32(p.Z)));
+
+			voxel_mesher mesher;
+			if (!mesher.build(indices, data.voxel_side_length, build.mesh))
+				build.fallback = MoveTemp(data);
+
+			build.build_ms = static_cast<float>((FPlatformTime::Seconds() - start) * 1000.);
+
+			AsyncTask(ENamedThreads::GameThread, [weak, build = MoveTemp(build)]() mutable
+				{
+					if (const auto self = weak.Get())
+						self->on_surface_built(MoveTemp(build));
+				});
+		});
+}
+
+void A_franka_voxel::on_surface_built(surface_build build)
+{
+	building = false;
+
+	/**
+	 * voxels cleared while building are not shown again
+	 */
+	if (build.generation == generation)
+	{
+		surface->ClearAllMeshSections();
+
+		if (build.fallback)
+			set_instances(*build.fallback);
+		else
+		{
+			clear_instances();
+
+			surface->SetRelativeTransform(build.relative);
+			surface->CreateMeshSection_LinearColor
+			(
+				0, build.mesh.vertices, build.mesh.triangles, build.mesh.normals,
+				{}, {}, {}, false
+			);
+			surface->SetMaterial(0, mat);
+
+			metrics.voxels = build.voxels;
+			metrics.triangles = build.mesh.triangles.Num() / 3;
+			metrics.build_ms = build.build_ms;
+		}
+	}
+
+	if (pending)
+	{
+		F_voxel_data next = MoveTemp(*pending);
+		pending.Reset();
+		set_voxels(next);
+	}
+}
+
+void A_franka_voxel::clear_Implementation()
+{
+	++generation;
+	pending.Reset();
+	clear_instances();
+	surface->ClearAllMeshSections();
 }
 
 void A_franka_voxel::set_visibility_Implementation(Visual_Change vis_change)
@@ -2,11 +2,69 @@
 
 #include "CoreMinimal.h"
 #include "Engine/StaticMeshActor.h"
+#include "ProceduralMeshComponent.h"
 
 #include "franka_common.h"
+#include "voxel_mesher.h"
 
 #include "franka_voxel.generated.h"
 
+/**
+ * @enum voxel_render_mode
+ * representation of the voxels of an @ref{A_franka_voxel}
+ */
+UENUM(BlueprintType)
+enum class voxel_render_mode : uint8
+{
+	/**
+	 * one cube instance per voxel
+	 */
+	INSTANCED UMETA(DisplayName = "INSTANCED"),
+
+	/**
+	 * single mesh of the exposed faces, built on a worker thread
+	 */
+	SURFACE UMETA(DisplayName = "SURFACE")
+};
+
+/**
+ * @struct F_voxel_mesh_metrics
+ * geometry of the last voxels shown by an @ref{A_franka_voxel}
+ */
+USTRUCT(BlueprintType)
+struct AR_INTEGRATION_API F_voxel_mesh_metrics
+{
+	GENERATED_BODY()
+
+	UPROPERTY(BlueprintReadOnly)
+	int64 voxels = 0;
+
+	/**
+	 * triangles drawn, 12 per voxel if instanced
+	 */
+	UPROPERTY(BlueprintReadOnly)
+	int64 triangles = 0;
+
+	/**
+	 * time to build the instances respectively the surface
+	 */
+	UPROPERTY(BlueprintReadOnly)
+	float build_ms = 0.f;
+
+	/**
+	 * instance operations of the last voxels, moved instances
+	 * got the transform of another voxel
+	 */
+	UPROPERTY(BlueprintReadOnly)
+	int64 instances_added = 0;
+
+	UPROPERTY(BlueprintReadOnly)
+	int64 instances_removed = 0;
+
+	UPROPERTY(BlueprintReadOnly)
+	int64 instances_moved = 0;
+};
+
 /**
  * @class for displaying of points as voxels with a pre-usage
  * defined resolution
@@ -29,10 +87,20 @@ public:
 	UFUNCTION(BlueprintCallable)
 	void set_voxels(const F_voxel_data& data);
 
+	UFUNCTION(BlueprintCallable)
+	F_voxel_mesh_metrics get_mesh_metrics() const;
+
 	void clear_Implementation() override;
 
 	void set_visibility_Implementation(Visual_Change vis_change) override;
 
+	/**
+	 * applies to voxels set afterwards, the surface falls back
+	 * to instances if the voxels span too large a volume
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Voxel")
+	voxel_render_mode render_mode = voxel_render_mode::INSTANCED;
+
 private:
 
 	/**
@@ -52,4 +120,71 @@ private:
 	 */
 	UPROPERTY()
 	UInstancedStaticMeshComponent* instanced;
+
+	/**
+	 * @var surface mesh of the exposed faces of all voxels
+	 */
+	UPROPERTY()
+	UProceduralMeshComponent* surface;
+
+	/**
+	 * updates only the instances of voxels which were added or removed
+	 * since the last call, removed slots are refilled by added voxels or
+	 * by the last instance so the instances stay contiguous
+	 */
+	void set_instances(const F_voxel_data& data);
+
+	void clear_instances();
+
+	static FTransform instance_transform(const FIntVector& voxel, float side_length);
+
+	/**
+	 * result of a surface build, fallback holds the voxels
+	 * if they span too large a volume for the mesher
+	 */
+	struct surface_build
+	{
+		int32 generation = 0;
+		FTransform relative;
+		voxel_surface mesh;
+		int64 voxels = 0;
+		float build_ms = 0.f;
+		TOptional<F_voxel_data> fallback;
+	};
+
+	/**
+	 * builds the surface of data on a worker thread
+	 */
+	void build_surface(F_voxel_data data);
+
+	void on_surface_built(surface_build build);
+
+	/**
+	 * @var building a surface build is running
+	 * @var pending latest voxels set while building, older ones are dropped
+	 * @var generation incremented by clear to discard running builds
+	 * only used on the game thread
+	 */
+	bool building = false;
+	TOptional<F_voxel_data> pending;
+	int32 generation = 0;
+
+	F_voxel_mesh_metrics metrics;
+
+	/**
+	 * @var instance_voxels voxel of every instance of instanced
+	 * @var instance_of instance of every voxel
+	 * @var instance_side_length side length of the instances
+	 */
+	TArray<FIntVector> instance_voxels;
+	TMap<FIntVector, int32> instance_of;
+	float instance_side_length = 0.f;
+
+	/**
+	 * scratch buffers of @ref{set_instances}
+	 */
+	TSet<FIntVector> next_voxels;
+	TArray<int32> removed_slots;
+	TArray<FIntVector> added_voxels;
+	TArray<FTransform> added_transforms;
 };
\ No newline at end of file
@@ -1,26 +1,84 @@
 #include "grpc_channel.h"
 
-void U_grpc_channel::BeginDestroy()
+U_grpc_channel::U_grpc_channel()
 {
-//	cq.Shutdown();
-	stop = true;
+	metrics = CreateDefaultSubobject<U_grpc_metrics>(TEXT("metrics"));
+}
 
-	if (thread)
-		thread->join();
+void U_grpc_channel::BeginDestroy()
+{
+	stop_watcher();
+	pool = {};
+	channel = nullptr;
 
 	Super::BeginDestroy();
 }
 
+const std::shared_ptr<grpc::Channel>& U_grpc_channel::get_channel(traffic_class type) const
+{
+	return pool[static_cast<size_t>(type)];
+}
+
 bool U_grpc_channel::construct(FString target, int32 timeout, int32 retries)
 {
-	/**
-	 * create channel with any credentials
-	 * and wait for connection with max. timeout
-	 */
+	auto temp = connect(target, timeout, retries, metrics->get_registry());
+	if (!temp[static_cast<size_t>(traffic_class::CONTROL)])
+		return false;
+
+	adopt(std::move(temp));
+	return true;
+}
+
+grpc::ChannelArguments U_grpc_channel::make_arguments(traffic_class type)
+{
 	grpc::ChannelArguments cArgs;
 	cArgs.SetInt(GRPC_ARG_MAX_RECONNECT_BACKOFF_MS, 2000);
-	const auto temp = CreateCustomChannel(std::string(TCHAR_TO_UTF8(*target)),
-		grpc::InsecureChannelCredentials(), cArgs);
+
+	/**
+	 * channels with equal arguments share their subchannels
+	 * and therefore one HTTP/2 connection and its flow control window
+	 * a local pool plus a distinct argument give each class its own
+	 */
+	cArgs.SetInt(GRPC_ARG_USE_LOCAL_SUBCHANNEL_POOL, 1);
+	cArgs.SetInt("ar_integration.traffic_class", static_cast<int>(type));
+
+	return cArgs;
+}
+
+channel_pool U_grpc_channel::connect(const FString& target, int32 timeout, int32 retries,
+	const std::shared_ptr<rpc_metrics_registry>& metrics)
+{
+	const std::string address(TCHAR_TO_UTF8(*target));
+
+	/**
+	 * create channels with any credentials
+	 * and the metric interceptors if requested
+	 */
+	channel_pool temp;
+	for (size_t i = 0; i < temp.size(); ++i)
+	{
+		const auto type = static_cast<traffic_class>(i);
+		if (!metrics)
+		{
+			temp[i] = CreateCustomChannel(address,
+				grpc::InsecureChannelCredentials(), make_arguments(type));
+			continue;
+		}
+
+		std::vector<std::unique_ptr<grpc::experimental::ClientInterceptorFactoryInterface>> interceptors;
+		interceptors.emplace_back(metrics->create_interceptor_factory());
+		temp[i] = grpc::experimental::CreateCustomChannelWithInterceptors(address,
+			grpc::InsecureChannelCredentials(), make_arguments(type), std::move(interceptors));
+	}
+
+	/**
+	 * start connecting the data channels while waiting
+	 * for the control channel with max. timeout
+	 */
+	for (const auto& ch : temp)
+		ch->GetState(true);
+
+	const auto& control = temp[static_cast<size_t>(traffic_class::CONTROL)];
 
 	bool established = false;
 	while (!established)
@@ -28,19 +86,27 @@ bool U_grpc_channel::construct(FString target, int32 timeout, int32 retries)
 		if (retries > 0)
 			--retries;
 
-		established = temp->WaitForConnected(std::chrono::system_clock::now() +
+		established = control->WaitForConnected(std::chrono::system_clock::now() +
 			std::chrono::milliseconds(static_cast<long long>(timeout)));
 
 		if (established || retries == 0)
 			break;
 	}
 
-	if (established)
-	{
-		channel = temp;
-		thread = std::make_unique<std::thread>(&U_grpc_channel::keep_connected, this);
-	}
-	return established;
+	if (!established)
+		return {};
+	return temp;
+}
+
+void U_grpc_channel::adopt(channel_pool connected)
+{
+	if (!connected[static_cast<size_t>(traffic_class::CONTROL)]) return;
+
+	stop_watcher();
+
+	pool = std::move(connected);
+	channel = get_channel(traffic_class::CONTROL);
+	start_watcher();
 }
 
 bool U_grpc_channel::connected() const
@@ -50,30 +116,124 @@ bool U_grpc_channel::connected() const
 
 connection_state U_grpc_channel::get_state() const
 {
-	if (channel)
-		return static_cast<connection_state>(channel->GetState(false));
+	return get_class_state(traffic_class::CONTROL);
+}
+
+U_grpc_metrics* U_grpc_channel::get_metrics() const
+{
+	return metrics;
+}
+
+rpc_method_stats* U_grpc_channel::get_method_stats(const char* method) const
+{
+	return &metrics->get_registry()->get(method);
+}
+
+F_connection_state_delegate& U_grpc_channel::on_class_state_change(traffic_class type)
+{
+	return class_state_change[static_cast<size_t>(type)];
+}
+
+connection_state U_grpc_channel::get_class_state(traffic_class type) const
+{
+	if (const auto& ch = get_channel(type))
+		return static_cast<connection_state>(ch->GetState(false));
 	return connection_state::NO_CHANNEL;
 }
 
-void U_grpc_channel::keep_connected()
+void U_grpc_channel::start_watcher()
+{
+	stop_watcher();
+
+	std::array<std::weak_ptr<grpc::Channel>, std::tuple_size_v<channel_pool>> watched;
+	for (size_t i = 0; i < pool.size(); ++i)
+		watched[i] = pool[i];
+
+	watcher = std::make_shared<watcher_state>();
+	std::thread(&U_grpc_channel::keep_connected, watcher, std::move(watched), TWeakObjectPtr<U_grpc_channel>(this)).detach();
+}
+
+void U_grpc_channel::stop_watcher()
 {
-	auto old_state = channel->GetState(false);
-	//channel->NotifyOnStateChange(old_state, std::chrono::system_clock::now() + std::chrono::milliseconds(50), &cq, nullptr);
+	if (!watcher)
+		return;
 
-	//https://github.com/grpc/grpc/issues/3064
+	watcher->stop = true;
+	watcher->wake.Set(&watcher->cq, std::chrono::system_clock::now(), nullptr);
+	watcher.reset();
+}
 
-	//bool ka;
-	//void* p2;
-	while (!stop/* && cq.Next(&p2, &ka)*/)
+void U_grpc_channel::keep_connected(std::shared_ptr<watcher_state> state,
+	std::array<std::weak_ptr<grpc::Channel>, std::tuple_size_v<channel_pool>> watched,
+	TWeakObjectPtr<U_grpc_channel> owner)
+{
+	/**
+	 * GetState(true) kicks an idle channel into connecting
+	 * which keeps the channels alive like the former polling loop
+	 *
+	 * the tag of a watch is the index of its channel plus one,
+	 * the wake up alarm has tag nullptr
+	 */
+	const auto no_deadline = std::chrono::system_clock::time_point::max();
+	std::array<grpc_connectivity_state, std::tuple_size_v<channel_pool>> old_states;
+	for (size_t i = 0; i < watched.size(); ++i)
 	{
-		const auto new_state = channel->GetState(true);
-		if (old_state == new_state) continue;
-
-		AsyncTask(ENamedThreads::GameThread, [this, old_state, new_state]()
-			{
-				on_state_change.Broadcast(static_cast<connection_state>(old_state), static_cast<connection_state>(new_state));
-			});
-		//channel->NotifyOnStateChange(old_state, std::chrono::system_clock::now() + std::chrono::milliseconds(50), &cq, nullptr);
-		old_state = new_state;
+		const auto ch = watched[i].lock();
+		if (!ch)
+			continue;
+
+		old_states[i] = ch->GetState(true);
+		ch->NotifyOnStateChange(old_states[i], no_deadline, &state->cq, reinterpret_cast<void*>(i + 1));
 	}
-}
\ No newline at end of file
+
+	/**
+	 * a watch completes on a state change, including the shutdown
+	 * of a destroyed channel, the thread sleeps in between
+	 *
+	 * https://github.com/grpc/grpc/issues/3064
+	 */
+	bool shutdown = false;
+	void* tag;
+	bool changed;
+	while (state->cq.Next(&tag, &changed))
+	{
+		/**
+		 * no further watches after the wake up, Next returns
+		 * false once the pending ones completed
+		 */
+		if (!tag || state->stop)
+		{
+			if (!shutdown)
+				state->cq.Shutdown();
+			shutdown = true;
+			continue;
+		}
+
+		const size_t i = reinterpret_cast<size_t>(tag) - 1;
+		const auto ch = watched[i].lock();
+		if (!ch)
+			continue;
+
+		const auto old_state = old_states[i];
+		const auto new_state = ch->GetState(true);
+		if (old_state != new_state)
+		{
+			AsyncTask(ENamedThreads::GameThread, [owner, i, old_state, new_state]()
+				{
+					U_grpc_channel* self = owner.Get();
+					if (!self)
+						return;
+
+					const auto type = static_cast<traffic_class>(i);
+					if (type == traffic_class::CONTROL)
+						self->on_state_change.Broadcast(static_cast<connection_state>(old_state), static_cast<connection_state>(new_state));
+					self->on_pool_state_change.Broadcast(type, static_cast<connection_state>(old_state), static_cast<connection_state>(new_state));
+					self->class_state_change[i].Broadcast(static_cast<connection_state>(old_state), static_cast<connection_state>(new_state));
+				});
+			old_states[i] = new_state;
+		}
+
+		if (new_state != GRPC_CHANNEL_SHUTDOWN)
+			ch->NotifyOnStateChange(old_states[i], no_deadline, &state->cq, tag);
+	}
+}
@@ -3,11 +3,19 @@
 #include "CoreMinimal.h"
 #include "UObject/Object.h"
 
-#include "grpc_include_begin.h"
+#include <array>
+#include <atomic>
 #include <memory>
+#include <thread>
+
+#include "grpc_include_begin.h"
 #include "grpcpp/create_channel.h"
+#include "grpcpp/alarm.h"
+#include "grpcpp/completion_queue.h"
 #include "grpc_include_end.h"
 
+#include "grpc_metrics.h"
+
 #include "grpc_channel.generated.h"
 
 UENUM(BlueprintType)
@@ -21,11 +29,37 @@ enum class connection_state : uint8
 	NO_CHANNEL UMETA(DisplayName = "NO_CHANNEL")
 };
 
+/**
+ * @enum traffic_class
+ * every class is carried by its own HTTP/2 connection
+ * so bulk transfers can't stall latency critical streams
+ *
+ * CONTROL unary calls and object synchronization
+ * REALTIME small latency critical streams e.g. joints and hands
+ * BULK large transfers e.g. point clouds, meshes and voxels
+ */
+UENUM(BlueprintType)
+enum class traffic_class : uint8
+{
+	CONTROL UMETA(DisplayName = "CONTROL"),
+	REALTIME UMETA(DisplayName = "REALTIME"),
+	BULK UMETA(DisplayName = "BULK")
+};
+
+/**
+ * one channel per @ref{traffic_class} indexed by the class
+ */
+typedef std::array<std::shared_ptr<grpc::Channel>, 3> channel_pool;
+
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(F_connection_state_delegate, 
 	connection_state, old_state, connection_state, new_state);
+
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_ThreeParams(F_pool_state_delegate,
+	traffic_class, pool_class, connection_state, old_state, connection_state, new_state);
 /*
  * @class U_grpc_channel
- * UE wrapper class for grpc::Channel
+ * UE wrapper class for a pool of grpc::Channel
+ * separated by traffic class
  */
 UCLASS(BlueprintType)
 class AR_INTEGRATION_API U_grpc_channel : public UObject
@@ -33,11 +67,22 @@ class AR_INTEGRATION_API U_grpc_channel : public UObject
 	GENERATED_BODY()
 public:
 
+	U_grpc_channel();
+
 	virtual void BeginDestroy() override;
 
+	/**
+	 * @var channel of @ref{traffic_class::CONTROL}
+	 */
 	std::shared_ptr<grpc::Channel> channel = 
 		nullptr;
 
+	/**
+	 * @returns channel carrying the traffic class
+	 * or nullptr if not constructed
+	 */
+	const std::shared_ptr<grpc::Channel>& get_channel(traffic_class type) const;
+
 	/**
 	 * construction helper for channel
 	 * @param target address of target e.g. ipv4:192.168.0.1
@@ -49,23 +94,124 @@ public:
 	UFUNCTION(BlueprintCallable)
 	bool construct(FString target, int32 timeout = 400, int32 retries = 1);
 
+	/**
+	 * creates a channel per traffic class to target and waits
+	 * for the connection of the control channel
+	 * the remaining channels connect in the background
+	 *
+	 * @param target address of target e.g. ipv4:192.168.0.1
+	 * @param timeout max. wait time for connection per try
+	 * @param metrics registry the interceptors of all channels record into
+	 *
+	 * @returns empty pool if no connection could be established
+	 *
+	 * @attend blocking call, does not touch any UObject
+	 * and may therefore be called from any thread
+	 */
+	static channel_pool connect(const FString& target, int32 timeout = 400, int32 retries = 1,
+		const std::shared_ptr<rpc_metrics_registry>& metrics = nullptr);
+
+	/**
+	 * takes over a pool created by @ref{connect}
+	 * and starts watching the state of its channels
+	 *
+	 * @attend to be called on the game thread
+	 */
+	void adopt(channel_pool connected);
+
 	UFUNCTION(BlueprintCallable, meta=(DeprecatedNode, DeprecationMessage="May soon be replaced!"))
 	bool connected() const;
 
 	UFUNCTION(BlueprintCallable)
 	connection_state get_state() const;
 
+	UFUNCTION(BlueprintCallable)
+	connection_state get_class_state(traffic_class type) const;
+
+	/**
+	 * @returns per method metrics of all rpcs on this channel
+	 */
+	UFUNCTION(BlueprintCallable)
+	U_grpc_metrics* get_metrics() const;
+
+	/**
+	 * @returns counters of method e.g. for an @ref{async_stream_reader}
+	 * @param method full name e.g. /generated.robot_com/transmit_voxels
+	 */
+	rpc_method_stats* get_method_stats(const char* method) const;
+
 	/*
+	 * state changes of the control channel
 	 * old and new state can be identical
 	 * see https://grpc.github.io/grpc/core/md_doc_connectivity-semantics-and-api.html
 	 */
 	UPROPERTY(BlueprintAssignable)
 	F_connection_state_delegate on_state_change;
 
+	/*
+	 * state changes of every channel in the pool
+	 */
+	UPROPERTY(BlueprintAssignable)
+	F_pool_state_delegate on_pool_state_change;
+
+	/**
+	 * @returns delegate of the state changes of the channel
+	 * carrying type, for clients bound to a single class
+	 */
+	F_connection_state_delegate& on_class_state_change(traffic_class type);
+
 private:
 
-	std::unique_ptr<std::thread> thread;
-	void keep_connected();
-	//grpc::CompletionQueue cq;
-	bool stop = false;
+	/**
+	 * channel arguments separating the connections
+	 * of the traffic classes
+	 */
+	static grpc::ChannelArguments make_arguments(traffic_class type);
+
+	/**
+	 * state shared with a watcher thread, which may outlive this object
+	 * until the watches on its channels completed
+	 */
+	struct watcher_state
+	{
+		grpc::CompletionQueue cq;
+		grpc::Alarm wake;
+		std::atomic_bool stop = false;
+	};
+
+	/**
+	 * starts watching @ref{pool} for state changes
+	 * and stops a previously running watcher
+	 */
+	void start_watcher();
+
+	/**
+	 * wakes the watcher, which shuts down its queue and exits
+	 * once the pending watches completed, i.e. once its channels
+	 * changed state or were destroyed
+	 *
+	 * @attend does not block, the thread is detached
+	 */
+	void stop_watcher();
+
+	/**
+	 * waits on the queue of state for notifications of
+	 * NotifyOnStateChange and emits @ref{on_state_change},
+	 * @ref{on_pool_state_change} and @ref{on_class_state_change}
+	 *
+	 * watches have no deadline, so the thread sleeps while
+	 * the states are unchanged, it keeps no channel alive
+	 */
+	static void keep_connected(std::shared_ptr<watcher_state> state,
+		std::array<std::weak_ptr<grpc::Channel>, std::tuple_size_v<channel_pool>> watched,
+		TWeakObjectPtr<U_grpc_channel> owner);
+
+	channel_pool pool;
+
+	std::array<F_connection_state_delegate, 3> class_state_change;
+
+	UPROPERTY()
+	U_grpc_metrics* metrics = nullptr;
+
+	std::shared_ptr<watcher_state> watcher;
 };
@@ -0,0 +1,292 @@
+#include "grpc_metrics.h"
+#include "message_pool.h"
+
+#include <bit>
+
+#include "grpc_include_begin.h"
+#include "grpcpp/support/byte_buffer.h"
+#include "grpc_include_end.h"
+
+namespace
+{
+	/**
+	 * @class metrics_interceptor
+	 *
+	 * created per call, forwards everything it sees
+	 * to the stats of the called method
+	 */
+	class metrics_interceptor final : public grpc::experimental::Interceptor
+	{
+	public:
+
+		metrics_interceptor(std::shared_ptr<rpc_metrics_registry> registry, rpc_method_stats& stats)
+			: registry(std::move(registry)), stats(stats)
+		{}
+
+		void Intercept(grpc::experimental::InterceptorBatchMethods* methods) override
+		{
+			using hook = grpc::experimental::InterceptionHookPoints;
+
+			if (methods->QueryInterceptionHookPoint(hook::PRE_SEND_INITIAL_METADATA))
+			{
+				start = std::chrono::steady_clock::now();
+				stats.calls.fetch_add(1, std::memory_order_relaxed);
+			}
+
+			if (methods->QueryInterceptionHookPoint(hook::PRE_SEND_MESSAGE))
+			{
+				/**
+				 * the first request for the serialized message
+				 * serializes it, which is what gets timed here
+				 */
+				const auto serialize_start = std::chrono::steady_clock::now();
+				if (const grpc::ByteBuffer* buffer = methods->GetSerializedSendMessage())
+				{
+					stats.serialize_ns.fetch_add(std::chrono::duration_cast<std::chrono::nanoseconds>(
+						std::chrono::steady_clock::now() - serialize_start).count(), std::memory_order_relaxed);
+					stats.bytes_sent.fetch_add(buffer->Length(), std::memory_order_relaxed);
+				}
+				stats.messages_sent.fetch_add(1, std::memory_order_relaxed);
+			}
+
+			if (methods->QueryInterceptionHookPoint(hook::POST_RECV_MESSAGE))
+			{
+				/**
+				 * nullptr if the stream ended instead of a message
+				 * the message is either parsed or a grpc::ByteBuffer
+				 * of an @ref{async_stream_reader}, which records
+				 * the size and parse time itself
+				 */
+				if (methods->GetRecvMessage())
+					stats.messages_received.fetch_add(1, std::memory_order_relaxed);
+			}
+
+			if (methods->QueryInterceptionHookPoint(hook::POST_RECV_STATUS))
+			{
+				if (const grpc::Status* status = methods->GetRecvStatus(); status && !status->ok())
+					stats.failed.fetch_add(1, std::memory_order_relaxed);
+
+				stats.record_latency(std::chrono::steady_clock::now() - start);
+			}
+
+			methods->Proceed();
+		}
+
+	private:
+
+		std::shared_ptr<rpc_metrics_registry> registry;
+		rpc_method_stats& stats;
+
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	};
+
+	class metrics_interceptor_factory final : public grpc::experimental::ClientInterceptorFactoryInterface
+	{
+	public:
+
+		explicit metrics_interceptor_factory(std::shared_ptr<rpc_metrics_registry> registry)
+			: registry(std::move(registry))
+		{}
+
+		grpc::experimental::Interceptor* CreateClientInterceptor(grpc::experimental::ClientRpcInfo* info) override
+		{
+			return new metrics_interceptor(registry, registry->get(info->method()));
+		}
+
+	private:
+
+		std::shared_ptr<rpc_metrics_registry> registry;
+	};
+
+	/**
+	 * @returns upper bound in ms of the bucket reaching the quantile
+	 */
+	float histogram_quantile(const TArray<int64>& histogram, int64 total, double quantile)
+	{
+		if (total == 0) return 0.f;
+
+		const int64 rank = FMath::CeilToInt64(quantile * static_cast<double>(total));
+		int64 seen = 0;
+		for (int32 i = 0; i < histogram.Num(); ++i)
+		{
+			seen += histogram[i];
+			if (seen >= rank)
+				return static_cast<float>(static_cast<double>(1ull << (i + 1)) / 1000.);
+		}
+		return static_cast<float>(static_cast<double>(1ull << histogram.Num()) / 1000.);
+	}
+}
+
+void rpc_method_stats::record_latency(std::chrono::nanoseconds latency)
+{
+	const auto us = static_cast<uint64_t>(std::max<int64_t>(1,
+		std::chrono::duration_cast<std::chrono::microseconds>(latency).count()));
+
+	const size_t bucket = std::min<size_t>(std::bit_width(us) - 1, latency_buckets - 1);
+	latency_histogram[bucket].fetch_add(1, std::memory_order_relaxed);
+}
+
+void rpc_method_stats::reset()
+{
+	calls = 0;
+	failed = 0;
+	messages_sent = 0;
+	bytes_sent = 0;
+	serialize_ns = 0;
+	messages_received = 0;
+	bytes_received = 0;
+	parse_ns = 0;
+
+	for (auto& bucket : latency_histogram)
+		bucket = 0;
+}
+
+rpc_method_stats& rpc_metrics_registry::get(const char* method)
+{
+	std::unique_lock lock(mtx);
+
+	auto& stats = methods[method];
+	if (!stats)
+		stats = std::make_unique<rpc_method_stats>();
+	return *stats;
+}
+
+void rpc_metrics_registry::reset()
+{
+	std::unique_lock lock(mtx);
+	for (auto& [method, stats] : methods)
+		stats->reset();
+}
+
+std::unique_ptr<grpc::experimental::ClientInterceptorFactoryInterface> rpc_metrics_registry::create_interceptor_factory()
+{
+	return std::make_unique<metrics_interceptor_factory>(shared_from_this());
+}
+
+U_grpc_metrics::U_grpc_metrics()
+	: registry(std::make_shared<rpc_metrics_registry>())
+{}
+
+void U_grpc_metrics::BeginDestroy()
+{
+	set_dump_interval(0.f);
+
+	Super::BeginDestroy();
+}
+
+TArray<F_rpc_method_metrics> U_grpc_metrics::get_method_metrics() const
+{
+	TArray<F_rpc_method_metrics> result;
+
+	registry->for_each([&result](const std::string& method, const rpc_method_stats& stats)
+		{
+			auto& entry = result.AddDefaulted_GetRef();
+			entry.method = UTF8_TO_TCHAR(method.c_str());
+			entry.calls = stats.calls.load(std::memory_order_relaxed);
+			entry.failed = stats.failed.load(std::memory_order_relaxed);
+			entry.messages_sent = stats.messages_sent.load(std::memory_order_relaxed);
+			entry.bytes_sent = stats.bytes_sent.load(std::memory_order_relaxed);
+			entry.serialize_ms = static_cast<float>(stats.serialize_ns.load(std::memory_order_relaxed) / 1e6);
+			entry.messages_received = stats.messages_received.load(std::memory_order_relaxed);
+			entry.bytes_received = stats.bytes_received.load(std::memory_order_relaxed);
+			entry.parse_ms = static_cast<float>(stats.parse_ns.load(std::memory_order_relaxed) / 1e6);
+
+			int64 total = 0;
+			entry.latency_histogram_us.Reserve(rpc_method_stats::latency_buckets);
+			for (const auto& bucket : stats.latency_histogram)
+			{
+				entry.latency_histogram_us.Add(bucket.load(std::memory_order_relaxed));
+				total += entry.latency_histogram_us.Last();
+			}
+
+			entry.latency_p50_ms = histogram_quantile(entry.latency_histogram_us, total, 0.5);
+			entry.latency_p99_ms = histogram_quantile(entry.latency_histogram_us, total, 0.99);
+		});
+
+	return result;
+}
+
+TArray<F_message_pool_metrics> U_grpc_metrics::get_message_pool_metrics() const
+{
+	TArray<F_message_pool_metrics> result;
+
+	message_pool_registry::get().for_each([&result](const std::string& message, const message_pool_stats& stats)
+		{
+			auto& entry = result.AddDefaulted_GetRef();
+			entry.message = UTF8_TO_TCHAR(message.c_str());
+			entry.acquired = stats.acquired.load(std::memory_order_relaxed);
+			entry.created = stats.created.load(std::memory_order_relaxed);
+			entry.arena_resets = stats.arena_resets.load(std::memory_order_relaxed);
+			entry.arena_bytes = stats.arena_bytes.load(std::memory_order_relaxed);
+		});
+
+	return result;
+}
+
+void U_grpc_metrics::dump_to_log()
+{
+	const double now = FPlatformTime::Seconds();
+	const double elapsed = last_dump_time > 0. ? now - last_dump_time : 0.;
+
+	for (const auto& entry : get_method_metrics())
+	{
+		const F_rpc_method_metrics* last = last_dump.Find(entry.method);
+
+		auto rate = [&](int64 current, int64 previous)
+			{
+				return elapsed > 0. ? static_cast<double>(current - previous) / elapsed : 0.;
+			};
+
+		UE_LOG(LogTemp, Log, TEXT("[grpc_metrics] %s calls %lld failed %lld | sent %lld msgs %lld B (%.1f msg/s %.1f kB/s, serialize %.2f ms) | received %lld msgs %lld B (%.1f msg/s %.1f kB/s, parse %.2f ms) | latency p50 <%.2f ms p99 <%.2f ms"),
+			*entry.method, entry.calls, entry.failed,
+			entry.messages_sent, entry.bytes_sent,
+			rate(entry.messages_sent, last ? last->messages_sent : 0),
+			rate(entry.bytes_sent, last ? last->bytes_sent : 0) / 1000.,
+			entry.serialize_ms,
+			entry.messages_received, entry.bytes_received,
+			rate(entry.messages_received, last ? last->messages_received : 0),
+			rate(entry.bytes_received, last ? last->bytes_received : 0) / 1000.,
+			entry.parse_ms,
+			entry.latency_p50_ms, entry.latency_p99_ms);
+
+		last_dump.Add(entry.method, entry);
+	}
+
+	for (const auto& entry : get_message_pool_metrics())
+	{
+		UE_LOG(LogTemp, Log, TEXT("[grpc_metrics] %s acquired %lld created %lld | arena %lld B resets %lld"),
+			*entry.message, entry.acquired, entry.created, entry.arena_bytes, entry.arena_resets);
+	}
+
+	last_dump_time = now;
+}
+
+void U_grpc_metrics::reset()
+{
+	registry->reset();
+	last_dump.Empty();
+	last_dump_time = 0.;
+}
+
+void U_grpc_metrics::set_dump_interval(float interval)
+{
+	if (dump_handle.IsValid())
+	{
+		FTSTicker::GetCoreTicker().RemoveTicker(dump_handle);
+		dump_handle.Reset();
+	}
+
+	if (interval <= 0.f) return;
+
+	dump_handle = FTSTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateWeakLambda(this,
+		[this](float)
+		{
+			dump_to_log();
+			return true;
+		}), interval);
+}
+
+const std::shared_ptr<rpc_metrics_registry>& U_grpc_metrics::get_registry() const
+{
+	return registry;
+}
@@ -0,0 +1,152 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/Object.h"
+#include "Containers/Ticker.h"
+
+#include <memory>
+
+#include "rpc_stats.h"
+
+#include "grpc_metrics.generated.h"
+
+/**
+ * @struct F_rpc_method_metrics
+ *
+ * snapshot of the counters of a single rpc method
+ */
+USTRUCT(BlueprintType)
+struct AR_INTEGRATION_API F_rpc_method_metrics
+{
+	GENERATED_BODY()
+
+	UPROPERTY(BlueprintReadOnly)
+	FString method;
+
+	UPROPERTY(BlueprintReadOnly)
+	int64 calls = 0;
+
+	UPROPERTY(BlueprintReadOnly)
+	int64 failed = 0;
+
+	UPROPERTY(BlueprintReadOnly)
+	int64 messages_sent = 0;
+
+	UPROPERTY(BlueprintReadOnly)
+	int64 bytes_sent = 0;
+
+	UPROPERTY(BlueprintReadOnly)
+	float serialize_ms = 0.f;
+
+	UPROPERTY(BlueprintReadOnly)
+	int64 messages_received = 0;
+
+	/**
+	 * only of streams read by an async_stream_reader
+	 */
+	UPROPERTY(BlueprintReadOnly)
+	int64 bytes_received = 0;
+
+	UPROPERTY(BlueprintReadOnly)
+	float parse_ms = 0.f;
+
+	/**
+	 * calls per latency bucket, bucket i holds
+	 * latencies in [2^i, 2^(i+1)) microseconds
+	 * for streams the latency is the lifetime of the stream
+	 */
+	UPROPERTY(BlueprintReadOnly)
+	TArray<int64> latency_histogram_us;
+
+	/**
+	 * upper bounds of the buckets holding the median
+	 * and the 99th percentile
+	 */
+	UPROPERTY(BlueprintReadOnly)
+	float latency_p50_ms = 0.f;
+
+	UPROPERTY(BlueprintReadOnly)
+	float latency_p99_ms = 0.f;
+};
+
+/**
+ * @struct F_message_pool_metrics
+ *
+ * snapshot of the @ref{message_pool_stats} of a single message type
+ */
+USTRUCT(BlueprintType)
+struct AR_INTEGRATION_API F_message_pool_metrics
+{
+	GENERATED_BODY()
+
+	UPROPERTY(BlueprintReadOnly)
+	FString message;
+
+	UPROPERTY(BlueprintReadOnly)
+	int64 acquired = 0;
+
+	/**
+	 * messages allocated, all other acquisitions reused one
+	 */
+	UPROPERTY(BlueprintReadOnly)
+	int64 created = 0;
+
+	UPROPERTY(BlueprintReadOnly)
+	int64 arena_resets = 0;
+
+	UPROPERTY(BlueprintReadOnly)
+	int64 arena_bytes = 0;
+};
+
+/**
+ * @class U_grpc_metrics
+ *
+ * UE access to the metrics recorded by the
+ * interceptors of a @ref{U_grpc_channel}
+ */
+UCLASS(BlueprintType)
+class AR_INTEGRATION_API U_grpc_metrics : public UObject
+{
+	GENERATED_BODY()
+public:
+
+	U_grpc_metrics();
+
+	virtual void BeginDestroy() override;
+
+	UFUNCTION(BlueprintCallable)
+	TArray<F_rpc_method_metrics> get_method_metrics() const;
+
+	/**
+	 * @returns counters of the message pools of all streams
+	 */
+	UFUNCTION(BlueprintCallable)
+	TArray<F_message_pool_metrics> get_message_pool_metrics() const;
+
+	/**
+	 * logs all methods with their rates
+	 * since the previous dump and all message pools
+	 */
+	UFUNCTION(BlueprintCallable)
+	void dump_to_log();
+
+	UFUNCTION(BlueprintCallable)
+	void reset();
+
+	/**
+	 * @param interval seconds between dumps to the log, 0 disables them
+	 */
+	UFUNCTION(BlueprintCallable)
+	void set_dump_interval(float interval);
+
+	const std::shared_ptr<rpc_metrics_registry>& get_registry() const;
+
+private:
+
+	std::shared_ptr<rpc_metrics_registry> registry;
+
+	FTSTicker::FDelegateHandle dump_handle;
+
+	TMap<FString, F_rpc_method_metrics> last_dump;
+	double last_dump_time = 0.;
+};
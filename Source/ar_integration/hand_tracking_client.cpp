@@ -19,29 +19,29 @@ void A_hand_tracking_client::Tick(float DeltaSeconds)
 
 	auto current_time = FDateTime::UtcNow();
 	
-	if (hand_queue.IsFull())
+	if (hand_queue.size_approx() >= hand_queue.capacity())
 		return;
 	
-	FXRMotionControllerData data;
-	UHeadMountedDisplayFunctionLibrary::GetMotionControllerData(GetWorld(), EControllerHand::Left, data);
-	pre_process(data);
-	hand_queue.Enqueue(convert<generated::Hand_Data>(std::make_pair(data, current_time)));
-	cv.notify_one();
-	
-	UHeadMountedDisplayFunctionLibrary::GetMotionControllerData(GetWorld(), EControllerHand::Right, data);
-	pre_process(data);
-	hand_queue.Enqueue(convert<generated::Hand_Data>(std::make_pair(data, current_time)));
-	cv.notify_one();
+	for (const EControllerHand hand : { EControllerHand::Left, EControllerHand::Right })
+	{
+		FXRMotionControllerData data;
+		UHeadMountedDisplayFunctionLibrary::GetMotionControllerData(GetWorld(), hand, data);
+		pre_process(data);
+
+		auto message = hand_pool.acquire();
+		convert_into(std::make_pair(data, current_time), message->mutable_hand_data());
+		hand_queue.try_enqueue(std::move(message));
+	}
+
+	if (stream)
+		stream->kick();
 }
 
 void A_hand_tracking_client::BeginDestroy()
 {
 	status = hand_client_status::TERMINATED;
-	if (thread)
-	{
-		cv.notify_all();
-		thread->join();
-	}	
+	stream.reset();
+
 	Super::BeginDestroy();
 }
 
@@ -49,49 +49,39 @@ void A_hand_tracking_client::async_transmit_data()
 {
 	hand_client_status temp_status = hand_client_status::READY;
 
-	if (disconnected) return;
+	if (disconnected || !channel) return;
 	if (!status.compare_exchange_strong(temp_status, hand_client_status::RUNNING))
 		return;
 
-	if (thread)
-		thread->join();
-	
-	thread = std::make_unique<std::thread>([this]() 
+	stream = std::make_unique<async_stream_writer<generated::Hand_Data_Meta, google::protobuf::Empty>>(
+		[this](grpc::ClientContext& ctx, google::protobuf::Empty* empty, grpc::CompletionQueue* cq)
 		{
-			if (!channel) return;
-
-			grpc::ClientContext ctx;
 			ctx.set_compression_algorithm(GRPC_COMPRESS_GZIP);
-			
-			google::protobuf::Empty empty;
-			const auto stream = 
-				stub->transmit_hand_data(&ctx, &empty);
-			stream->WaitForInitialMetadata();
-
-			bool first = true;
-			while (status == hand_client_status::RUNNING)
-			{
-				generated::Hand_Data_Meta data;
-				if (!hand_queue.Dequeue(*data.mutable_hand_data()))
-				{
-					std::unique_lock lock(mtx);
-					cv.wait(lock);
-					continue;
-				}
-				
-				if (first)
-					*data.mutable_transformation_meta() = generate_meta();
-
-				if (!stream->Write(data))
-					break;
-				first = false;
-			}
-			stream->WritesDone();
-			if (stream->Finish().error_code() == grpc::StatusCode::UNKNOWN)
+			return stub->PrepareAsynctransmit_hand_data(&ctx, empty, cq);
+		},
+		[this, first = true](message_pool<generated::Hand_Data_Meta>::handle& data) mutable
+		{
+			if (!hand_queue.try_dequeue(data))
+				return false;
+
+			if (first)
+				*data->mutable_transformation_meta() = generate_meta();
+			first = false;
+			return true;
+		},
+		[this](const grpc::Status& result, const google::protobuf::Empty&)
+		{
+			if (result.error_code() == grpc::StatusCode::UNKNOWN)
 				disconnected = true;
 
-			hand_client_status expected = hand_client_status::STOP;
-			status.compare_exchange_strong(expected, hand_client_status::READY);
+			/**
+			 * streams closed by the server become ready again as well,
+			 * retried until it sticks since async_stop may race with it
+			 */
+			hand_client_status expected = status.load();
+			while (expected != hand_client_status::TERMINATED &&
+				!status.compare_exchange_weak(expected, hand_client_status::READY))
+			{}
 		});
 }
 
@@ -101,7 +91,8 @@ bool A_hand_tracking_client::async_stop()
 	const bool ret_val = status.compare_exchange_strong(
 		temp_status, hand_client_status::STOP);
 	
-	cv.notify_all();
+	if (ret_val && stream)
+		stream->close();
 
 	return ret_val;
 }
@@ -114,13 +105,11 @@ void A_hand_tracking_client::update_local_transform(const FTransform& local)
 
 void A_hand_tracking_client::stop_Implementation()
 {
-	const bool stop = async_stop();
-	if (stop)
-	{
-		thread->join();
-		thread = nullptr;
-	}
-	hand_queue.Empty();
+	if (async_stop() && stream)
+		stream->wait();
+	stream.reset();
+
+	hand_queue.clear();
 	status = hand_client_status::READY;
 }
 
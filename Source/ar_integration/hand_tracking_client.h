@@ -11,6 +11,9 @@
 #include "hand_tracking.grpc.pb.h"
 #include "grpc_include_end.h"
 
+#include "stream_executor.h"
+#include "bounded_queue.h"
+
 #include "HeadMountedDisplayTypes.h"
 
 #include "hand_tracking_client.generated.h"
@@ -56,18 +59,24 @@ private:
 	mutable std::mutex trafo_mtx;
 	FTransform local_transform;
 	
-	TCircularQueue<generated::Hand_Data> hand_queue = 
-		TCircularQueue<generated::Hand_Data>(21);
+	/**
+	 * messages are filled by Tick and
+	 * released once they were written
+	 */
+	message_pool<generated::Hand_Data_Meta> hand_pool;
 
-	bool disconnected = false;
+	bounded_queue<message_pool<generated::Hand_Data_Meta>::handle> hand_queue = 
+		bounded_queue<message_pool<generated::Hand_Data_Meta>::handle>(20);
 
-	std::mutex mtx;
-	std::condition_variable cv;
-	
-	std::unique_ptr<std::thread> thread;
+	std::atomic_bool disconnected = false;
+
+	/**
+	 * pulls from @ref{hand_queue}, kicked by Tick
+	 */
+	std::unique_ptr<async_stream_writer<generated::Hand_Data_Meta, google::protobuf::Empty>> stream;
 	std::unique_ptr<generated::hand_tracking_com::Stub> stub;
 
-	BASE_CLIENT_BODY(
+	BASE_CLIENT_BODY_CLASS(traffic_class::REALTIME,
 		[this](const std::shared_ptr<grpc::Channel>& ch)
 		{
 			stub = generated::hand_tracking_com::NewStub(ch);
@@ -1,6 +1,9 @@
 #include "integration_game_state.h"
 //#include "HeadMountedDisplayFunctionLibrary.h"
 
+#include "Async/Async.h"
+#include "UObject/StrongObjectPtr.h"
+
 template<typename ... Ts>
 struct Overload : Ts ... {
 	using Ts::operator() ...;
@@ -38,6 +41,8 @@ void A_integration_game_state::BeginPlay()
 
 	pin_component_->RegisterComponent();
 
+	channel_->get_metrics()->set_dump_interval(rpc_metrics_dump_interval);
+
 	//correction_component->RegisterComponent();
 	correction_component_->AttachToComponent(pin_component_, FAttachmentTransformRules::KeepRelativeTransform);
 	correction_component_->SetRelativeTransform(FTransform(FQuat{ FRotator{0., 4., 0.} }, FVector(1.1, 2.3, 0.), FVector::One()));
@@ -119,13 +124,73 @@ void A_integration_game_state::Tick(float DeltaSeconds)
 	franka_controller_->Tick(DeltaSeconds);
 }
 
+void A_integration_game_state::BeginDestroy()
+{
+	/**
+	 * background stages never wait for the game thread
+	 * therefore waiting here can't deadlock
+	 */
+	if (connect_task_.IsValid())
+		connect_task_.Wait();
+
+	Super::BeginDestroy();
+}
+
 void A_integration_game_state::change_channel(const FString& target, int32 retries)
 {
 	scenario_ready_ = false;
 
-	if (target == old_target_) return;
+	if (target == old_target_ || connecting_) return;
+	connecting_ = true;
+
+	/**
+	 * connect off the game thread and hand the channel
+	 * back to it for the client setup
+	 */
+	const double start = FPlatformTime::Seconds();
+	connect_task_ = Async(EAsyncExecution::Thread,
+		[weak = TWeakObjectPtr<A_integration_game_state>(this), target, retries, start,
+			metrics = channel_->get_metrics()->get_registry()]()
+		{
+			F_connect_latency latency;
+			auto connected = U_grpc_channel::connect(target, 400, retries, metrics);
+			latency.channel_ms = static_cast<float>((FPlatformTime::Seconds() - start) * 1000.);
+
+			AsyncTask(ENamedThreads::GameThread, 
+				[weak, target, connected = std::move(connected), latency, start]() mutable
+				{
+					if (const auto self = weak.Get())
+						self->on_channel_connected(target, std::move(connected), latency, start);
+				});
+		});
+}
+
+bool A_integration_game_state::is_connecting() const
+{
+	return connecting_;
+}
+
+F_connect_latency A_integration_game_state::get_connect_latency() const
+{
+	return connect_latency_;
+}
+
+U_grpc_metrics* A_integration_game_state::get_rpc_metrics() const
+{
+	return channel_->get_metrics();
+}
+
+void A_integration_game_state::on_channel_connected(const FString& target, channel_pool connected, F_connect_latency latency, double start)
+{
+	if (!connected[static_cast<size_t>(traffic_class::CONTROL)])
+	{
+		connecting_ = false;
+		UE_LOG(LogTemp, Warning, TEXT("[A_integration_game_state] Connection to %s failed after %.1f ms"), *target, latency.channel_ms);
+		return;
+	}
 
-	if (!channel_->construct(target, 400, retries)) return;
+	const double clients_start = FPlatformTime::Seconds();
+	channel_->adopt(std::move(connected));
 
 	old_target_ = target;
 	synced_ = false;
@@ -180,18 +245,67 @@ void A_integration_game_state::change_channel(const FString& target, int32 retri
 	}*/
 
 	I_Base_Client_Interface::Execute_set_channel(hand_tracking_client, channel_);
+	latency.clients_ms = static_cast<float>((FPlatformTime::Seconds() - clients_start) * 1000.);
 
 	/**
 	 * resync if anchor is set
 	 */
+	bool sync = true;
 #if PLATFORM_HOLOLENS
-	if (anchor_pin_)
+	sync = anchor_pin_ != nullptr;
 #endif
+
+	/**
+	 * synchronization and scenario request are blocking
+	 * unary calls and streams, run them off the game thread
+	 *
+	 * the task keeps both clients alive and releases them on the
+	 * game thread, the calls have deadlines so BeginDestroy
+	 * waits for the task a bounded time
+	 */
+	connect_task_ = Async(EAsyncExecution::Thread,
+		[weak = TWeakObjectPtr<A_integration_game_state>(this), sync,
+		objects = TStrongObjectPtr<U_object_client>(object_client),
+		selection = TStrongObjectPtr<U_selection_client>(selection_client), latency, start]() mutable
+		{
+			double stage_start = FPlatformTime::Seconds();
+			if (sync)
+				objects->sync_objects();
+			latency.sync_ms = static_cast<float>((FPlatformTime::Seconds() - stage_start) * 1000.);
+
+			stage_start = FPlatformTime::Seconds();
+			scenario_type scenario = scenario_type::MIXED;
+			const bool received = selection && selection->request_scenario(scenario);
+			latency.scenario_ms = static_cast<float>((FPlatformTime::Seconds() - stage_start) * 1000.);
+
+			AsyncTask(ENamedThreads::GameThread, [weak, sync, received, scenario, latency, start,
+				objects = MoveTemp(objects), selection = MoveTemp(selection)]()
+				{
+					if (const auto self = weak.Get())
+						self->on_channel_synced(sync, received, scenario, latency, start);
+				});
+		});
+}
+
+void A_integration_game_state::on_channel_synced(bool synced, bool scenario_received, scenario_type scenario, F_connect_latency latency, double start)
+{
+	if (synced)
 	{
-		sync_and_subscribe();
+		synced_ = true;
+		subscribe_streams();
 	}
-	
-	refresh_scenario();
+
+	if (!selection_client)
+		UE_LOG(LogTemp, Warning, TEXT("[A_integration_game_state] Selection client null; cannot refresh scenario."));
+	else
+		apply_scenario(scenario_received, scenario);
+
+	latency.total_ms = static_cast<float>((FPlatformTime::Seconds() - start) * 1000.);
+	connect_latency_ = latency;
+	connecting_ = false;
+
+	UE_LOG(LogTemp, Log, TEXT("[A_integration_game_state] Connected to %s: channel %.1f ms, clients %.1f ms, sync %.1f ms, scenario %.1f ms, total %.1f ms"),
+		*old_target_, latency.channel_ms, latency.clients_ms, latency.sync_ms, latency.scenario_ms, latency.total_ms);
 
 	on_channel_change.Broadcast(channel_);
 }
@@ -365,8 +479,15 @@ void A_integration_game_state::sync_and_subscribe(bool forced)
 	synced_ = true;
 
 	if (object_client)
-	{
 		object_client->sync_objects();
+
+	subscribe_streams();
+}
+
+void A_integration_game_state::subscribe_streams()
+{
+	if (object_client)
+	{
 		object_client->async_subscribe_objects();
 		object_client->async_subscribe_delete_objects();
 	}
@@ -395,7 +516,12 @@ bool A_integration_game_state::refresh_scenario()
 	}
 
 	scenario_type new_mode = scenario_type::MIXED;
-	if (!selection_client->request_scenario(new_mode))
+	return apply_scenario(selection_client->request_scenario(new_mode), new_mode);
+}
+
+bool A_integration_game_state::apply_scenario(bool received, scenario_type new_mode)
+{
+	if (!received)
 	{
 		UE_LOG(LogTemp, Warning, TEXT("[A_integration_game_state] Scenario request failed; keeping %d"), static_cast<int32>(scenario_mode_));
 		return false;
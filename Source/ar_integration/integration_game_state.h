@@ -2,6 +2,7 @@
 
 #include "ARPin.h"
 #include "ARBlueprintLibrary.h"
+#include "Async/Future.h"
 #include "GameFramework/GameStateBase.h"
 #include "UObject/ConstructorHelpers.h"
 #include "Engine/Blueprint.h"
@@ -30,6 +31,47 @@
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(F_channel_delegate, U_grpc_channel*, channel);
 DECLARE_DYNAMIC_MULTICAST_DELEGATE(F_post_actors_delegate);
 
+/**
+ * @struct F_connect_latency
+ *
+ * duration of each stage of a channel change in milliseconds
+ */
+USTRUCT(BlueprintType)
+struct AR_INTEGRATION_API F_connect_latency
+{
+	GENERATED_BODY()
+
+	/**
+	 * @var channel_ms creation of the channel until connected
+	 */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
+	float channel_ms = 0.f;
+
+	/**
+	 * @var clients_ms handing the channel to all clients
+	 */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
+	float clients_ms = 0.f;
+
+	/**
+	 * @var sync_ms initial synchronization of objects
+	 */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
+	float sync_ms = 0.f;
+
+	/**
+	 * @var scenario_ms request of the scenario
+	 */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
+	float scenario_ms = 0.f;
+
+	/**
+	 * @var total_ms call of change_channel until on_channel_change
+	 */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
+	float total_ms = 0.f;
+};
+
 /**
  * @class A_integration_game_state
  * class holding all the global state information
@@ -53,6 +95,7 @@ public:
 	A_integration_game_state();
 
 	virtual void BeginPlay() override;
+	virtual void BeginDestroy() override;
 
 	/**
 	 * loading spatial anchor at the beginning of the application if
@@ -69,12 +112,34 @@ public:
 	 *
 	 * automatically synchronizes and subscribes in case anchor is present
 	 *
+	 * @attend returns immediately, connecting, synchronizing and
+	 * requesting the scenario run off the game thread
+	 * @attend ignored while a previous change is still in progress
 	 * @attend references to previously created clients may be invalidated
 	 * @attend emits @ref{on_channel_change} after all internal client channels are set
+	 * and the initial synchronization finished
 	 */
 	UFUNCTION(BlueprintCallable)
 	void change_channel(const FString& target, int32 retries = 1);
 
+	/**
+	 * @returns true while a channel change is in progress
+	 */
+	UFUNCTION(BlueprintPure)
+	bool is_connecting() const;
+
+	/**
+	 * @returns stage durations of the last successful channel change
+	 */
+	UFUNCTION(BlueprintPure)
+	F_connect_latency get_connect_latency() const;
+
+	/**
+	 * @returns per method metrics of all clients
+	 */
+	UFUNCTION(BlueprintPure)
+	U_grpc_metrics* get_rpc_metrics() const;
+
 	/**
 	 * signal emitted on valid change of channel
 	 */
@@ -220,6 +285,13 @@ public:
 	UPROPERTY(BlueprintAssignable)
 	F_post_actors_delegate on_post_actors;
 
+	/**
+	 * seconds between dumps of the rpc metrics to the log
+	 * 0 disables the dump
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly)
+	float rpc_metrics_dump_interval = 30.f;
+
 	UPROPERTY(BlueprintReadOnly)
 	bool enable_registration =
 #ifdef WITH_POINTCLOUD
@@ -282,6 +354,31 @@ private:
 	 */
 	assignment_type sanitize_assignment(assignment_type requested) const;
 
+	/**
+	 * second stage of @ref{change_channel} on the game thread
+	 * hands the connected channels to all clients and
+	 * starts the synchronization off the game thread
+	 */
+	void on_channel_connected(const FString& target, channel_pool connected, F_connect_latency latency, double start);
+
+	/**
+	 * last stage of @ref{change_channel} on the game thread
+	 * applies synchronization and scenario results and emits @ref{on_channel_change}
+	 */
+	void on_channel_synced(bool synced, bool scenario_received, scenario_type scenario, F_connect_latency latency, double start);
+
+	/**
+	 * starts all subscriptions and outgoing streams
+	 * without the blocking synchronization
+	 */
+	void subscribe_streams();
+
+	/**
+	 * applies the result of a scenario request
+	 * @return true if a valid scenario was applied
+	 */
+	bool apply_scenario(bool received, scenario_type new_mode);
+
 	/**
 	 * handle voxels!
 	 * TODO:: connect delegate, test, pin to position of robot relative to the anchor!
@@ -317,6 +414,21 @@ private:
 	 */
 	FString old_target_ = "";
 
+	/**
+	 * indicates whether a channel change is in progress
+	 */
+	bool connecting_ = false;
+
+	/**
+	 * background stage of a channel change in progress
+	 */
+	TFuture<void> connect_task_;
+
+	/**
+	 * stage durations of the last channel change
+	 */
+	F_connect_latency connect_latency_;
+
 	/**
 	 * indicates whether application is starting
 	 * used for loading existing anchor pin at startup
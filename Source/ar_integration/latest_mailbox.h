@@ -0,0 +1,119 @@
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+
+/**
+ * @struct mailbox_stats
+ * counters of a @ref{latest_mailbox}
+ *
+ * dropped values were replaced before being taken
+ * stale values waited longer than the stale threshold
+ */
+struct mailbox_stats
+{
+	uint64_t posted = 0;
+	uint64_t consumed = 0;
+	uint64_t dropped = 0;
+	uint64_t stale = 0;
+};
+
+/**
+ * @class latest_mailbox
+ *
+ * holds only the newest value posted by a producer
+ * until the consumer takes it e.g. once per frame
+ * so bursts don't queue up work for the consumer
+ *
+ * @attend values are moved in and out, the critical
+ * section never copies or converts them and replaced
+ * values are destroyed after leaving it
+ */
+template<typename T>
+class latest_mailbox final
+{
+public:
+
+	explicit latest_mailbox(std::chrono::milliseconds stale_after = std::chrono::milliseconds(100))
+		: stale_after(stale_after)
+	{}
+
+	/**
+	 * replaces the pending value
+	 * @param carry called as carry(pending, value) if value replaces
+	 * a pending one e.g. to keep state only the pending one carries
+	 */
+	template<typename F>
+	void post(T&& value, F&& carry)
+	{
+		std::optional<T> replaced;
+
+		std::unique_lock lock(mtx);
+		++counters.posted;
+
+		if (pending)
+		{
+			++counters.dropped;
+			carry(*pending, value);
+			replaced = std::move(pending);
+		}
+
+		pending = std::move(value);
+		posted_at = std::chrono::steady_clock::now();
+	}
+
+	void post(T&& value)
+	{
+		post(std::move(value), [](T&, T&) {});
+	}
+
+	/**
+	 * @returns false if nothing new was posted since the last call
+	 */
+	bool take(T& out)
+	{
+		std::unique_lock lock(mtx);
+		if (!pending)
+			return false;
+
+		out = std::move(*pending);
+		pending.reset();
+
+		++counters.consumed;
+		if (std::chrono::steady_clock::now() - posted_at > stale_after)
+			++counters.stale;
+		return true;
+	}
+
+	/**
+	 * drops the pending value
+	 */
+	void clear()
+	{
+		std::optional<T> replaced;
+
+		std::unique_lock lock(mtx);
+		if (!pending)
+			return;
+
+		++counters.dropped;
+		replaced = std::move(pending);
+		pending.reset();
+	}
+
+	mailbox_stats stats() const
+	{
+		std::unique_lock lock(mtx);
+		return counters;
+	}
+
+private:
+
+	const std::chrono::milliseconds stale_after;
+
+	mutable std::mutex mtx;
+	std::optional<T> pending;
+	std::chrono::steady_clock::time_point posted_at;
+	mailbox_stats counters;
+};
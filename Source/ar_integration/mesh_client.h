@@ -62,7 +62,7 @@ private:
 	std::unique_ptr<generated::mesh_com::Stub> mesh_stub;
 	std::unique_ptr<generated::object_prototype_com::Stub> obj_proto_stub;
 
-	BASE_CLIENT_BODY(
+	BASE_CLIENT_BODY_CLASS(traffic_class::BULK,
 		[this](const std::shared_ptr<grpc::Channel>& ch)
 		{
 			mesh_stub = generated::mesh_com::NewStub(ch);
@@ -0,0 +1,17 @@
+#include "message_pool.h"
+
+message_pool_registry& message_pool_registry::get()
+{
+	static message_pool_registry registry;
+	return registry;
+}
+
+std::shared_ptr<message_pool_stats> message_pool_registry::stats(const std::string& type)
+{
+	std::unique_lock lock(mtx);
+
+	auto& stats = types[type];
+	if (!stats)
+		stats = std::make_shared<message_pool_stats>();
+	return stats;
+}
@@ -0,0 +1,200 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "grpc_include_begin.h"
+#include "google/protobuf/arena.h"
+#include "grpc_include_end.h"
+
+/**
+ * @class message_pool_stats
+ *
+ * lock free counters shared by all pools of one message type
+ */
+class message_pool_stats final
+{
+public:
+
+	/**
+	 * @var acquired messages handed out by @ref{message_pool::acquire}
+	 * @var created messages constructed on an arena, every other acquisition reused one
+	 * @var arena_resets arenas dropped because they grew beyond their limit
+	 * @var arena_bytes memory currently held by the arenas
+	 */
+	std::atomic_uint64_t acquired = 0;
+	std::atomic_uint64_t created = 0;
+	std::atomic_uint64_t arena_resets = 0;
+	std::atomic_int64_t arena_bytes = 0;
+};
+
+/**
+ * @class message_pool_registry
+ *
+ * process wide collection of @ref{message_pool_stats}
+ * keyed by the full message name e.g. generated.Pcl_Data_Meta
+ */
+class message_pool_registry final
+{
+public:
+
+	static message_pool_registry& get();
+
+	/**
+	 * @returns stats of type, created on first use
+	 */
+	std::shared_ptr<message_pool_stats> stats(const std::string& type);
+
+	/**
+	 * calls f(type, stats) for every registered type
+	 */
+	template<typename F>
+	void for_each(F&& f) const
+	{
+		std::unique_lock lock(mtx);
+		for (const auto& [type, stats] : types)
+			f(type, *stats);
+	}
+
+private:
+
+	mutable std::mutex mtx;
+	std::unordered_map<std::string, std::shared_ptr<message_pool_stats>> types;
+};
+
+/**
+ * @class message_pool
+ *
+ * recycles protobuf messages allocated on an arena
+ * a released message is cleared and handed out again,
+ * cleared repeated fields keep their elements, so
+ * refilling a message of similar size does not allocate
+ *
+ * the first block of the arena is owned by the pool,
+ * the general heap is only hit if a message outgrows it
+ *
+ * @attend all handles have to be released before the pool is destroyed
+ */
+template<typename T>
+class message_pool final
+{
+public:
+
+	/**
+	 * returns the message to its pool instead of deleting it
+	 */
+	struct recycler
+	{
+		message_pool* pool = nullptr;
+
+		void operator()(T* message) const
+		{
+			pool->release(message);
+		}
+	};
+
+	typedef std::unique_ptr<T, recycler> handle;
+
+	/**
+	 * @param initial_block_size bytes of the first arena block
+	 * @param reset_limit arena size above which the arena is dropped
+	 * as soon as no message is in use, bounds the memory of
+	 * fields which were replaced instead of reused
+	 */
+	explicit message_pool(size_t initial_block_size = 64 * 1024, size_t reset_limit = 64 * 1024 * 1024)
+		: initial_block(std::make_unique<char[]>(initial_block_size)),
+		initial_block_size(initial_block_size),
+		reset_limit(reset_limit),
+		counters(message_pool_registry::get().stats(T::default_instance().GetTypeName()))
+	{
+		create_arena();
+	}
+
+	~message_pool()
+	{
+		counters->arena_bytes.fetch_sub(reported_bytes, std::memory_order_relaxed);
+	}
+
+	message_pool(const message_pool&) = delete;
+	message_pool& operator=(const message_pool&) = delete;
+
+	/**
+	 * @returns cleared message, recycled on destruction of the handle
+	 */
+	handle acquire()
+	{
+		std::unique_lock lock(mtx);
+		++in_use;
+		counters->acquired.fetch_add(1, std::memory_order_relaxed);
+
+		if (!free.empty())
+		{
+			T* message = free.back();
+			free.pop_back();
+			return handle(message, recycler{ this });
+		}
+
+		counters->created.fetch_add(1, std::memory_order_relaxed);
+		return handle(google::protobuf::Arena::CreateMessage<T>(arena.get()), recycler{ this });
+	}
+
+	const message_pool_stats& stats() const
+	{
+		return *counters;
+	}
+
+private:
+
+	void release(T* message)
+	{
+		message->Clear();
+
+		std::unique_lock lock(mtx);
+		free.push_back(message);
+
+		if (--in_use == 0 && arena->SpaceAllocated() > reset_limit)
+		{
+			free.clear();
+			create_arena();
+			counters->arena_resets.fetch_add(1, std::memory_order_relaxed);
+		}
+		update_bytes();
+	}
+
+	/**
+	 * @attend expects mtx to be locked or the pool to be under construction
+	 */
+	void create_arena()
+	{
+		google::protobuf::ArenaOptions options;
+		options.initial_block = initial_block.get();
+		options.initial_block_size = initial_block_size;
+
+		arena.reset();
+		arena = std::make_unique<google::protobuf::Arena>(options);
+		update_bytes();
+	}
+
+	void update_bytes()
+	{
+		const auto bytes = static_cast<int64_t>(arena->SpaceAllocated());
+		counters->arena_bytes.fetch_add(bytes - reported_bytes, std::memory_order_relaxed);
+		reported_bytes = bytes;
+	}
+
+	const std::unique_ptr<char[]> initial_block;
+	const size_t initial_block_size;
+	const size_t reset_limit;
+
+	std::shared_ptr<message_pool_stats> counters;
+	int64_t reported_bytes = 0;
+
+	std::mutex mtx;
+	std::unique_ptr<google::protobuf::Arena> arena;
+	std::vector<T*> free;
+	size_t in_use = 0;
+};
@@ -5,27 +5,47 @@
 void U_object_client::async_subscribe_objects()
 {
 	if (!channel ||
-		(subscribe_thread && !subscribe_thread->done())) return;
+		(subscribe_stream && !subscribe_stream->done())) return;
 
-	subscribe_thread = std::make_unique<stream_thread>( 
-		[this](grpc::ClientContext& ctx)
+	constexpr const char* method = "/generated.object_com/transmit_object";
+	subscribe_stream = std::make_unique<async_stream_reader<generated::Object_Instance_TF_Meta>>(
+		[ch = channel->get_channel(channel_class)](grpc::ClientContext& ctx, grpc::CompletionQueue* cq)
 		{
-			if (this->subscribe_objects(ctx).error_code() == grpc::StatusCode::UNKNOWN)
+			return prepare_stream(ch.get(), method, ctx, google::protobuf::Empty(), cq);
+		},
+		[this, wrapper = std::make_shared<TF_Conv_Wrapper>()](message_pool<generated::Object_Instance_TF_Meta>::handle& msg)
+		{
+			process(*msg, *wrapper);
+		},
+		[this](const grpc::Status& status)
+		{
+			if (status.error_code() == grpc::StatusCode::UNKNOWN)
 				sub_add_disconnected = true;
-		});
+		},
+		&object_pool, channel->get_method_stats(method));
 }
 
 void U_object_client::async_subscribe_delete_objects()
 {
 	if (!channel ||
-		(subscribe_delete_thread && !subscribe_delete_thread->done())) return;
+		(subscribe_delete_stream && !subscribe_delete_stream->done())) return;
 
-	subscribe_delete_thread = std::make_unique<stream_thread>(
-		[this](grpc::ClientContext& ctx)
+	constexpr const char* method = "/generated.object_com/delete_object";
+	subscribe_delete_stream = std::make_unique<async_stream_reader<generated::Delete_Request>>(
+		[ch = channel->get_channel(channel_class)](grpc::ClientContext& ctx, grpc::CompletionQueue* cq)
+		{
+			return prepare_stream(ch.get(), method, ctx, google::protobuf::Empty(), cq);
+		},
+		[this](message_pool<generated::Delete_Request>::handle& req)
 		{
-			if (this->subscribe_delete_objects(ctx).error_code() == grpc::StatusCode::UNKNOWN)
+			on_object_delete.Broadcast(convert<FString>(req->id()));
+		},
+		[this](const grpc::Status& status)
+		{
+			if (status.error_code() == grpc::StatusCode::UNKNOWN)
 				sub_del_disconnected = true;
-		});
+		},
+		&delete_pool, channel->get_method_stats(method));
 }
 
 void U_object_client::state_change_Implementation(connection_state old_state, connection_state new_state)
@@ -43,38 +63,13 @@ void U_object_client::state_change_Implementation(connection_state old_state, co
 	}
 }
 
-grpc::Status U_object_client::subscribe_objects(grpc::ClientContext& ctx) const
-{
-	google::protobuf::Empty empty;
-	auto stream =
-		stub->transmit_object(&ctx, empty);
-	stream->WaitForInitialMetadata();
-
-	TF_Conv_Wrapper wrapper;
-	generated::Object_Instance_TF_Meta msg;
-	while (stream->Read(&msg))
-		process(msg, wrapper);
-	return stream->Finish();
-}
-
-grpc::Status U_object_client::subscribe_delete_objects(grpc::ClientContext& ctx) const
-{
-	google::protobuf::Empty empty;
-	auto stream = stub->delete_object(&ctx, empty);
-	stream->WaitForInitialMetadata();
-
-	generated::Delete_Request req;
-	while (stream->Read(&req))
-		on_object_delete.Broadcast(convert<FString>(req.id()));
-	return stream->Finish();
-}
-
 void U_object_client::sync_objects()
 {
 	if (!channel) return;
 
 	google::protobuf::Empty empty;
 	grpc::ClientContext ctx;
+	ctx.set_deadline(std::chrono::system_clock::now() + sync_timeout);
 	auto stream = stub->sync_objects(&ctx, empty);
 	stream->WaitForInitialMetadata();
 
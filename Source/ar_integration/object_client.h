@@ -11,7 +11,7 @@
 #include "object.grpc.pb.h"
 #include "grpc_include_end.h"
 
-#include "stream_thread.h"
+#include "stream_executor.h"
 
 #include "object_client.generated.h"
 
@@ -51,7 +51,7 @@ public:
 	 * synchronizes with objects present on server
 	 * if channel valid
 	 *
-	 * @attend blocking call
+	 * @attend blocking call for at most @ref{sync_timeout}
 	 */
 	UFUNCTION(BlueprintCallable, Category = "Object|Subscriptions")
 	void sync_objects();
@@ -78,29 +78,28 @@ public:
 	virtual void state_change_Implementation(connection_state old_state, connection_state new_state) override;
 private:
 
-	/**
-	 * synchronise versions of @ref{async_subscribe_objects} and
-	 * @ref{async_subscribe_delete_objects}
-	 *
-	 * @attend this versions do not check for validity of channel
-	 * prior to execution
-	 */
-	grpc::Status subscribe_objects(grpc::ClientContext& ctx) const;
-	grpc::Status subscribe_delete_objects(grpc::ClientContext& ctx) const;
-
 	/**
 	 * processes incoming object_instances with wrappers
 	 * and emits corresponding signals
 	 */
 	void process(const generated::Object_Instance_TF_Meta& meta_instance, TF_Conv_Wrapper& wrapper) const;
+
+	/**
+	 * @var sync_timeout deadline of the whole synchronization
+	 * so a stalled server can't block the caller
+	 */
+	inline static constexpr std::chrono::seconds sync_timeout{ 10 };
 	
 	std::unique_ptr<generated::object_com::Stub> stub;
 	
-	std::unique_ptr<stream_thread> subscribe_thread;
-	std::unique_ptr<stream_thread> subscribe_delete_thread;
+	message_pool<generated::Object_Instance_TF_Meta> object_pool;
+	message_pool<generated::Delete_Request> delete_pool;
+
+	std::unique_ptr<async_stream_reader<generated::Object_Instance_TF_Meta>> subscribe_stream;
+	std::unique_ptr<async_stream_reader<generated::Delete_Request>> subscribe_delete_stream;
 
-	bool sub_add_disconnected = false;
-	bool sub_del_disconnected = false;
+	std::atomic_bool sub_add_disconnected = false;
+	std::atomic_bool sub_del_disconnected = false;
 
 	BASE_CLIENT_BODY(
 		[this](const std::shared_ptr<grpc::Channel>& ch)
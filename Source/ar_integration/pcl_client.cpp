@@ -3,69 +3,15 @@
 #include "pcl_client.h"
 
 #include "Kismet/KismetSystemLibrary.h"
-#include "Kismet/KismetMathLibrary.h"
 
 #include "Math/TransformVectorized.h"
 #include "ARBlueprintLibrary.h"
 
 #include "util.h"
+#include "point_cloud_filter.h"
+#include "stream_executor.h"
 
-pcl_transmission_vertices::pcl_transmission_vertices(std::unique_ptr<generated::pcl_com::Stub>& stub)
-	: stub(stub)
-{
-	context.set_compression_algorithm(GRPC_COMPRESS_GZIP);
-}
-
-void pcl_transmission_vertices::transmit_data(generated::ICP_Result& response)
-{
-	stream = stub->transmit_pcl_data(&context, &response);
-	stream->WaitForInitialMetadata();
-}
-
-bool pcl_transmission_vertices::send_data(const F_point_cloud& pcl)
-{
-	generated::Pcl_Data_Meta to_send;
-	*to_send.mutable_pcl_data() = convert<generated::Pcl_Data>(pcl);
-
-	if (first)
-		*to_send.mutable_transformation_meta() = generate_meta();
-	first = false;
-
-	return stream->Write(to_send);
-}
-
-grpc::Status pcl_transmission_vertices::end_data()
-{
-	stream->WritesDone();
-	return stream->Finish();
-}
-
-
-/*
-pcl_transmission_draco::pcl_transmission_draco(std::unique_ptr<generated::pcl_com::Stub>& stub)
-	: stub(stub)
-{
-	context.set_compression_algorithm(GRPC_COMPRESS_NONE);
-}
-
-void pcl_transmission_draco::transmit_data(generated::ICP_Result& response)
-{
-	stream = stub->transmit_draco_data(&context, &response);
-	stream->WaitForInitialMetadata();
-}
-
-bool pcl_transmission_draco::send_data(const F_point_cloud& pcl)
-{
-	return stream->Write(convert<generated::draco_data>(pcl));
-}
-
-grpc::Status pcl_transmission_draco::end_data()
-{
-	stream->WritesDone();
-	return stream->Finish();
-}
-*/
-
+#include <stdexcept>
 
 A_pcl_client::A_pcl_client()
 {
@@ -139,14 +85,128 @@ void A_pcl_client::set_state(state new_state)
 		state_change_sync(old_state, new_state);
 }
 
-grpc::Status A_pcl_client::send_point_clouds()
+template<typename Frame, typename Request>
+grpc::Status A_pcl_client::stream_frames(
+	message_pool<Request>& pool,
+	const std::function<bool(size_t, Frame&)>& acquire,
+	const std::function<bool(size_t, const Frame&, Request&)>& encode,
+	std::function<std::unique_ptr<grpc::ClientAsyncWriter<Request>>(
+		grpc::ClientContext&, generated::ICP_Result*, grpc::CompletionQueue*)>&& factory,
+	std::function<void(Request&)>&& prepare,
+	std::function<void(size_t)>&& enqueued)
 {
+	typedef typename message_pool<Request>::handle message_handle;
+
+	for (pcl_stage_stats* stats : { &acquire_stats, &redundancy_stats, &filter_stats, &encode_stats, &send_stats })
+		stats->reset();
+	camera_dropped_baseline = cam->get_dropped_frames();
+
+	struct encoded
+	{
+		message_handle message;
+		std::chrono::steady_clock::time_point enqueued;
+	};
+
 	/**
-	 * generate context data for transmission
-	 * and set compression algorithm
+	 * bounds the point clouds waiting for the stream, full queues
+	 * block the workers which in turn leave frames in the camera queue
 	 */
+	bounded_queue<encoded> send_queue(send_queue_capacity);
+
+	grpc::Status status;
 	generated::ICP_Result response;
 
+	{
+		async_stream_writer<Request, generated::ICP_Result> writer(
+			std::move(factory),
+			[this, &send_queue, &prepare, first = true](message_handle& data) mutable
+			{
+				encoded next;
+				if (!send_queue.try_dequeue(next))
+					return false;
+
+				send_stats.record(std::chrono::steady_clock::now() - next.enqueued);
+				send_stats.queue_depth = send_queue.size_approx();
+
+				data = std::move(next.message);
+				if (prepare)
+					prepare(*data);
+
+				if (first)
+					*data->mutable_transformation_meta() = generate_meta();
+				first = false;
+				return true;
+			},
+			[&status, &response](const grpc::Status& result, const generated::ICP_Result& icp_result)
+			{
+				status = result;
+				response = icp_result;
+			});
+
+		workers->run([&](size_t worker)
+			{
+				Frame frame;
+				while (current_state == state::RUNNING && !writer.done())
+				{
+					if (!acquire(worker, frame))
+						continue;
+
+					const auto start = std::chrono::steady_clock::now();
+					message_handle message = pool.acquire();
+					if (!encode(worker, frame, *message))
+					{
+						encode_stats.dropped.fetch_add(1, std::memory_order_relaxed);
+						continue;
+					}
+
+					const auto now = std::chrono::steady_clock::now();
+					encode_stats.record(now - start);
+					encode_stats.bytes.fetch_add(message->ByteSizeLong(), std::memory_order_relaxed);
+
+					if (!send_queue.wait_enqueue_for(encoded{ std::move(message), now }, std::chrono::milliseconds(100)))
+					{
+						send_stats.dropped.fetch_add(1, std::memory_order_relaxed);
+						continue;
+					}
+					send_stats.queue_depth = send_queue.size_approx();
+					if (enqueued)
+						enqueued(worker);
+					writer.kick();
+				}
+			});
+
+		/**
+		 * set state to stop if stream closed
+		 */
+		if (writer.done())
+			set_state(state::STOP);
+
+		writer.close();
+		writer.wait();
+
+		/**
+		 * closing writes no further frames, the ones left
+		 * in the queue are dropped
+		 */
+		send_stats.dropped.fetch_add(send_queue.size_approx(), std::memory_order_relaxed);
+		send_queue.clear();
+		send_stats.queue_depth = 0;
+	}
+
+	/**
+	 * evaluate if point cloud correspondence with server is valid
+	 * and transform it and set table_to_point_cloud
+	 */
+	if (status.ok())
+	{
+		if (const auto result = convert<TOptional<FTransform>>(response); result.IsSet())
+			table_to_point_cloud = result.GetValue();
+	}
+	return status;
+}
+
+grpc::Status A_pcl_client::send_point_clouds()
+{
 	const bool interface_present = box_interface_obj &&
 		I_box_interface::Execute_has_box(box_interface_obj);
 
@@ -156,24 +216,62 @@ grpc::Status A_pcl_client::send_point_clouds()
 
 	const auto extrinsic_inv = cam->get_camera_view_matrix().Inverse();
 
+	update_workers();
+
+	/**
+	 * the workers read the settings concurrently to the game thread
+	 */
+	const float leaf_size = downsample_leaf_size;
+	const bool skip_redundant = skip_redundant_frames;
+
+	/**
+	 * state of the workers, indexed by the worker
+	 */
+	std::vector<voxel_grid_filter> downsample(workers->size());
+
+	frame_redundancy_filter redundancy(redundancy_translation, redundancy_rotation,
+		redundancy_depth_change, std::chrono::milliseconds(FMath::RoundToInt(keyframe_interval * 1000.f)));
+
 	/**
-	 * initialize stream
+	 * frames become the reference only once queued for sending,
+	 * indexed by the worker
 	 */
-	auto stream = pcl_transmission_vertices{ stub };
-	stream.transmit_data(response);
-	while (current_state == state::RUNNING)
+	std::vector<frame_redundancy_filter::candidate> candidates(workers->size());
+	auto commit = [&](size_t worker)
+	{
+		if (skip_redundant)
+			redundancy.commit(candidates[worker]);
+	};
+
+	auto acquire = [&](size_t worker, F_point_cloud& out)
 	{
 		/**
-		 * pull point cloud from cam and yield if empty
+		 * wait for a point cloud from cam, the timeout
+		 * bounds the reaction time to state changes
 		 */
-		auto pcl = cam->get_pcl();
+		auto pcl = cam->wait_pcl(std::chrono::milliseconds(100));
+		update_camera_stats();
 		if (!pcl.IsSet())
+			return false;
+
+		auto& [location, point_cloud] = pcl.GetValue();
+
+		record_frame_age(point_cloud.abs_timestamp);
+
+		/**
+		 * compared before the points leave camera space
+		 */
+		if (skip_redundant)
 		{
-			std::this_thread::yield();
-			continue;
+			if (!redundancy.check(location, point_cloud.points, candidates[worker]))
+			{
+				redundancy_stats.dropped.fetch_add(1, std::memory_order_relaxed);
+				return false;
+			}
+			redundancy_stats.processed.fetch_add(1, std::memory_order_relaxed);
 		}
 
-		auto& [location, point_cloud] = pcl.GetValue();
+		const auto start = std::chrono::steady_clock::now();
 
 		FTransform world_trafo;
 		/**
@@ -183,83 +281,190 @@ grpc::Status A_pcl_client::send_point_clouds()
 		 */
 		FTransform::Multiply(&world_trafo, &extrinsic_inv, &location);
 
-		for (auto& p : point_cloud.data)
-		{
-			p = world_trafo.TransformPosition(p);
-			
-			if (interface_present)
+		const point_cloud_crop crop(world_trafo, interface_present ? &obb : nullptr);
+		point_cloud.points.set_num(crop.apply(point_cloud.points));
+		point_cloud.points.set_num(downsample[worker].apply(point_cloud.points, leaf_size));
+
+		filter_stats.record(std::chrono::steady_clock::now() - start);
+
+		/**
+		 * skip point clouds without points left after filtering
+		 */
+		if (point_cloud.points.IsEmpty())
+			return false;
+
+		if (voxel)
+			voxel->insert(point_cloud.points);
+
+		out = MoveTemp(point_cloud);
+		return true;
+	};
+
+	if (compression == pcl_compression::NONE)
+	{
+		return stream_frames<F_point_cloud, generated::Pcl_Data_Meta>(pcl_pool, acquire,
+			[](size_t, const F_point_cloud& pcl, generated::Pcl_Data_Meta& out)
 			{
-				if (!UKismetMathLibrary::IsPointInBoxWithTransform(p, FTransform(obb.rotation, obb.axis_box.GetCenter()), obb.axis_box.GetExtent()))
-					p.Set(NAN, NAN, NAN);
-			}
-		}
-		if (interface_present)
-		{
-			size_t last_valid_idx = 0;
-			size_t valid_points = 0;
-			//size_t last_invalid_idx = point_cloud.data.Num() - 1;
-			for (size_t i = point_cloud.data.Num() - 1; (i + 1) > 0; --i)
+				convert_into(pcl, out.mutable_pcl_data());
+				return true;
+			},
+			[this](grpc::ClientContext& ctx, generated::ICP_Result* response, grpc::CompletionQueue* cq)
 			{
-				if (point_cloud.data[i].ContainsNaN())
-					continue;
+				ctx.set_compression_algorithm(GRPC_COMPRESS_GZIP);
+				return stub->PrepareAsynctransmit_pcl_data(&ctx, response, cq);
+			},
+			nullptr, commit);
+	}
 
-				last_valid_idx = i;
-				valid_points = i + 1;
-				break;
-			}
+	/**
+	 * codecs keep scratch buffers, one per worker
+	 */
+	std::vector<std::unique_ptr<pcl_codec>> codecs;
+	for (size_t i = 0; i < workers->size(); ++i)
+		codecs.emplace_back(pcl_codec::create(
+			compression == pcl_compression::DRACO ? generated::DRACO_KD_TREE : generated::QUANTIZED_ZSTD,
+			compression_precision));
+
+	return stream_frames<F_point_cloud, generated::Draco_Data>(draco_pool, acquire,
+		[&codecs](size_t worker, const F_point_cloud& pcl, generated::Draco_Data& out)
+		{
+			/**
+			 * units and axes are described by the transformation meta
+			 * as for uncompressed transmissions, the camera only
+			 * unprojects valid pixels so all points are finite
+			 */
+			if (!codecs[worker]->encode(pcl.points, out))
+				return false;
+
+			out.set_timestamp(pcl.abs_timestamp);
+			return true;
+		},
+		[this](grpc::ClientContext& ctx, generated::ICP_Result* response, grpc::CompletionQueue* cq)
+		{
+			/**
+			 * the payload is already compressed
+			 */
+			ctx.set_compression_algorithm(GRPC_COMPRESS_NONE);
+			return stub->PrepareAsynctransmit_draco_data(&ctx, response, cq);
+		},
+		nullptr, commit);
+}
 
-			//we can skip every nan before the last valid index
-			for (size_t i = last_valid_idx; (i + 1) > 0; --i)
-			{
-				if (!point_cloud.data[i].ContainsNaN())
-					continue;
+grpc::Status A_pcl_client::send_depth_frames()
+{
+	const auto extrinsic_inv = cam->get_camera_view_matrix().Inverse();
 
-				--valid_points;
-				point_cloud.data.Swap(last_valid_idx, i);
+	update_workers();
 
-				for (size_t j = i - 1; i > 0 && (j + 1) > 0; --j)
-				{
-					if (point_cloud.data[j].ContainsNaN())
-						continue;
+	const bool skip_redundant = skip_redundant_frames;
 
-					last_valid_idx = i;
-					break;
-				}
-			}
-			point_cloud.data.SetNum(valid_points);
-		}
+	/**
+	 * without points only the poses are compared
+	 */
+	frame_redundancy_filter redundancy(redundancy_translation, redundancy_rotation,
+		1., std::chrono::milliseconds(FMath::RoundToInt(keyframe_interval * 1000.f)));
 
-		/**
-		 * return if there are no points left after filtering
-		 */
-		if (point_cloud.data.IsEmpty())
-			continue;
+	std::vector<frame_redundancy_filter::candidate> candidates(workers->size());
 
-		if (voxel)
-			voxel->insert(point_cloud.data);
+	auto acquire = [&](size_t worker, raw_depth_frame& out)
+	{
+		auto frame = cam->wait_depth_frame(std::chrono::milliseconds(100));
+		update_camera_stats();
+		if (!frame.IsSet())
+			return false;
 
-		/**
-		 * transmit point clouds while stream is active
-		 * set state to stop if stream closes
-		 */
-		if (!stream.send_data(point_cloud))
+		record_frame_age(frame->abs_timestamp);
+
+		if (skip_redundant)
 		{
-			set_state(state::STOP);
-			break;
+			if (!redundancy.check(frame->location, {}, candidates[worker]))
+			{
+				redundancy_stats.dropped.fetch_add(1, std::memory_order_relaxed);
+				return false;
+			}
+			redundancy_stats.processed.fetch_add(1, std::memory_order_relaxed);
 		}
-	}
-	auto status = stream.end_data();
 
+		out = MoveTemp(frame.GetValue());
+		return true;
+	};
+
+	return stream_frames<raw_depth_frame, generated::Depth_Frame>(depth_pool, acquire,
+		[&extrinsic_inv](size_t, const raw_depth_frame& frame, generated::Depth_Frame& out)
+		{
+			out.mutable_depth()->assign(
+				reinterpret_cast<const char*>(frame.depth.GetData()), frame.depth.Num() * sizeof(uint16));
+			out.mutable_sigma()->assign(
+				reinterpret_cast<const char*>(frame.sigma.GetData()), frame.sigma.Num());
+			out.set_width(frame.width);
+			out.set_height(frame.height);
+			out.set_timestamp(frame.abs_timestamp);
+
+			/**
+			 * same chain as for point clouds, sensor -> rig -> world
+			 */
+			FTransform sensor_to_world;
+			FTransform::Multiply(&sensor_to_world, &extrinsic_inv, &frame.location);
+			*out.mutable_sensor_to_world() = convert<generated::Matrix>(sensor_to_world);
+			return true;
+		},
+		[this](grpc::ClientContext& ctx, generated::ICP_Result* response, grpc::CompletionQueue* cq)
+		{
+			ctx.set_compression_algorithm(GRPC_COMPRESS_GZIP);
+			return stub->PrepareAsynctransmit_depth_frames(&ctx, response, cq);
+		},
+		[this, sent = std::shared_ptr<const depth_unprojection>()](generated::Depth_Frame& message) mutable
+		{
+			/**
+			 * rays precede the first frame of every resolution
+			 */
+			if (sent && sent->matches(message.width(), message.height()))
+				return;
+
+			sent = cam->get_unprojection();
+			if (sent && sent->matches(message.width(), message.height()))
+				convert_into(*sent, message.mutable_intrinsics());
+			else
+				sent.reset();
+		},
+		[&](size_t worker)
+		{
+			if (skip_redundant)
+				redundancy.commit(candidates[worker]);
+		});
+}
+
+void A_pcl_client::update_workers()
+{
 	/**
-	 * evaluate if point cloud correspondence with server is valid
-	 * and transform it and set table_to_point_cloud
+	 * a single worker keeps the frames of a replay in order
 	 */
-	if (status.ok())
-	{
-		if (const auto result = convert<TOptional<FTransform>>(response); result.IsSet())
-			table_to_point_cloud = result.GetValue();
-	}
-	return status;
+	const auto count = cam->is_replaying() ? size_t(1) : static_cast<size_t>(FMath::Max(worker_count, 1));
+	if (workers && workers->size() == count)
+		return;
+
+	workers.reset();
+	workers = std::make_unique<worker_pool>(count);
+}
+
+void A_pcl_client::update_camera_stats()
+{
+	acquire_stats.queue_depth = cam->get_queue_depth();
+	acquire_stats.dropped = cam->get_dropped_frames() - camera_dropped_baseline;
+}
+
+void A_pcl_client::record_frame_age(int64 abs_timestamp)
+{
+	if (abs_timestamp <= 0)
+		return;
+
+	/**
+	 * sensor timestamps are FILETIMEs, ticks since 1601
+	 */
+	static const int64 file_time_epoch = FDateTime(1601, 1, 1).GetTicks();
+
+	const int64 age = FDateTime::UtcNow().GetTicks() - file_time_epoch - abs_timestamp;
+	acquire_stats.record(std::chrono::nanoseconds(age * 100));
 }
 
 bool A_pcl_client::filter_point(FVector& p) const
@@ -318,7 +523,7 @@ void A_pcl_client::toggle(bool active)
 			set_state(state::STOP);
 			return;
 		default:
-			throw std::exception("Invalid enum value");
+			throw std::runtime_error("Invalid enum value");
 		}	
 	}
 	
@@ -357,7 +562,7 @@ void A_pcl_client::toggle(bool active)
 		break;
 	}
 	default:
-		throw std::exception("Invalid enum value");
+		throw std::runtime_error("Invalid enum value");
 	}
 
 	state expected = state::START;
@@ -370,9 +575,10 @@ void A_pcl_client::toggle(bool active)
 	if (!was_expected) return;
 
 	/**
-	 * creates voxel filter and size if visualize is true
+	 * creates voxel filter and size if visualize is true,
+	 * raw depth frames are never unprojected on the device
 	 */
-	if (visualize)
+	if (visualize && transmission_mode != pcl_transmission_mode::RAW_DEPTH)
 	{
 		FFunctionGraphTask::CreateAndDispatchWhenReady([this]()
 			{
@@ -389,19 +595,23 @@ void A_pcl_client::toggle(bool active)
 	 * set state to running and clear depth image buffer
 	 */
 	set_state(state::RUNNING);
-	cam->clear_queue();
+	cam->set_capture_mode(transmission_mode == pcl_transmission_mode::RAW_DEPTH ?
+		capture_mode::RAW_DEPTH : capture_mode::POINT_CLOUD);
+
+	/**
+	 * frames of a replay are not outdated
+	 */
+	if (!cam->is_replaying())
+		cam->clear_queue();
 
 	/**
-	 * send obb and open multiple channels for transmission of point clouds
+	 * send obb and stream point clouds through the pipeline
 	 */
 	{
 		std::unique_lock lock(channel_mutex);
 		std::ignore = send_obb();
-		std::list<std::thread> threads;
-		for (size_t i = 0; i < 3; ++i)
-			threads.emplace_back(std::thread(&A_pcl_client::send_point_clouds, this));
-		for (auto& thread : threads)
-			thread.join();
+		std::ignore = transmission_mode == pcl_transmission_mode::RAW_DEPTH ?
+			send_depth_frames() : send_point_clouds();
 	}
 	/**
 	 * Restore ready state
@@ -412,6 +622,7 @@ void A_pcl_client::toggle(bool active)
 		FFunctionGraphTask::CreateAndDispatchWhenReady([this]()
 			{
 				voxel->Destroy();
+				voxel = nullptr;
 			},
 			TStatId{}, nullptr, ENamedThreads::GameThread)->Wait();
 	}
@@ -420,6 +631,39 @@ void A_pcl_client::toggle(bool active)
 	cv.notify_all();
 }
 
+TArray<F_pcl_stage_metrics> A_pcl_client::get_pipeline_metrics() const
+{
+	TArray<F_pcl_stage_metrics> out;
+
+	auto add = [&out](const TCHAR* name, const pcl_stage_stats& stats)
+	{
+		F_pcl_stage_metrics& m = out.AddDefaulted_GetRef();
+		m.stage = name;
+		m.processed = static_cast<int64>(stats.processed.load(std::memory_order_relaxed));
+		m.dropped = static_cast<int64>(stats.dropped.load(std::memory_order_relaxed));
+		m.queue_depth = static_cast<int64>(stats.queue_depth.load(std::memory_order_relaxed));
+
+		const double total_ms = stats.total_ns.load(std::memory_order_relaxed) * 1e-6;
+		m.mean_latency_ms = m.processed > 0 ? static_cast<float>(total_ms / m.processed) : 0.f;
+		m.max_latency_ms = static_cast<float>(stats.max_ns.load(std::memory_order_relaxed) * 1e-6);
+		m.bytes = static_cast<int64>(stats.bytes.load(std::memory_order_relaxed));
+	};
+
+	add(TEXT("acquire"), acquire_stats);
+	add(TEXT("redundancy"), redundancy_stats);
+	add(TEXT("filter"), filter_stats);
+	add(TEXT("encode"), encode_stats);
+	add(TEXT("send"), send_stats);
+
+	/**
+	 * skipped frames are assumed to cost as much as the encoded ones
+	 */
+	const F_pcl_stage_metrics& encoded = out[3];
+	if (encoded.processed > 0)
+		out[1].bytes = out[1].dropped * (encoded.bytes / encoded.processed);
+	return out;
+}
+
 state A_pcl_client::get_state() const
 {
 	return current_state;
@@ -439,10 +683,18 @@ void A_pcl_client::Tick(float DeltaTime)
 	//FActorSpawnParameters params;
 	//params.bNoFail = true;
 
-	if (current_state != state::INIT) return;
-	
-	if (UARBlueprintLibrary::GetARSessionStatus().Status ==
-		EARSessionStatus::Running && channel)
+	if (current_state != state::INIT || !channel) return;
+
+	/**
+	 * a camera set by set_camera needs no ar session
+	 */
+	if (cam)
+	{
+		set_state(state::READY);
+		cv.notify_all();
+	}
+	else if (UARBlueprintLibrary::GetARSessionStatus().Status ==
+		EARSessionStatus::Running)
 	{
 		set_state(state::READY);
 
@@ -455,4 +707,10 @@ void A_pcl_client::Tick(float DeltaTime)
 		cv.notify_all();
 	}
 #endif
+}
+
+void A_pcl_client::set_camera(A_camera* camera)
+{
+	if (current_state == state::INIT && IsValid(camera))
+		cam = camera;
 }
\ No newline at end of file
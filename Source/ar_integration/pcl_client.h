@@ -12,61 +12,53 @@
 #include "depth_image.grpc.pb.h"
 #include "grpc_include_end.h"
 
+#include "message_pool.h"
+#include "pcl_pipeline.h"
+#include "pcl_codec.h"
 #include "voxel.h"
 #include "camera.h"
 #include "util.h"
 
 #include "pcl_client.generated.h"
 
-class pcl_transmission
+/**
+ * @struct F_pcl_stage_metrics
+ *
+ * snapshot of the @ref{pcl_stage_stats} of one pipeline stage
+ */
+USTRUCT(BlueprintType)
+struct AR_INTEGRATION_API F_pcl_stage_metrics
 {
-public:
-
-	virtual ~pcl_transmission() = default;
-	
-	virtual void transmit_data(generated::ICP_Result& response) = 0;
-	virtual bool send_data(const F_point_cloud& pcl) = 0;
-	virtual grpc::Status end_data() = 0;
+	GENERATED_BODY()
 
-protected:
+	UPROPERTY(BlueprintReadOnly)
+	FString stage;
 
-	bool first = true;
-	grpc::ClientContext context;
-};
+	UPROPERTY(BlueprintReadOnly)
+	int64 processed = 0;
 
-class pcl_transmission_vertices : public pcl_transmission
-{
-public:
+	UPROPERTY(BlueprintReadOnly)
+	int64 dropped = 0;
 
-	pcl_transmission_vertices(std::unique_ptr<generated::pcl_com::Stub>& stub);
-	virtual ~pcl_transmission_vertices() override = default;
+	/**
+	 * point clouds waiting in the queue in front of the stage
+	 */
+	UPROPERTY(BlueprintReadOnly)
+	int64 queue_depth = 0;
 
-	virtual void transmit_data(generated::ICP_Result& response) override;
-	virtual bool send_data(const F_point_cloud& pcl) override;
-	virtual grpc::Status end_data() override;
+	UPROPERTY(BlueprintReadOnly)
+	float mean_latency_ms = 0.f;
 
-private:
+	UPROPERTY(BlueprintReadOnly)
+	float max_latency_ms = 0.f;
 
-	std::unique_ptr<generated::pcl_com::Stub>& stub;
-	std::unique_ptr<grpc::ClientWriter<generated::Pcl_Data_Meta>> stream;
+	/**
+	 * bytes produced by the encode stage
+	 * respectively estimated bytes saved by the redundancy stage
+	 */
+	UPROPERTY(BlueprintReadOnly)
+	int64 bytes = 0;
 };
-/*
-class pcl_transmission_draco : public pcl_transmission
-{
-public:
-
-	pcl_transmission_draco(std::unique_ptr<generated::pcl_com::Stub>& stub);
-	virtual ~pcl_transmission_draco() override = default;
-
-	virtual void transmit_data(generated::ICP_Result& response) override;
-	virtual bool send_data(const F_point_cloud& pcl) override;
-	virtual grpc::Status end_data() override;
-
-private:
-
-	std::unique_ptr<generated::pcl_com::Stub>& stub;
-	std::unique_ptr<grpc::ClientWriter<generated::draco_data>> stream;
-};*/
 
 /**
  * @class U_box_interface
@@ -137,6 +129,36 @@ enum class state : uint8
 	STOP UMETA(DisplayName = "STOP")
 };
 
+/**
+ * @enum pcl_transmission_mode
+ * data sent by a pcl_client
+ */
+UENUM(BlueprintType)
+enum class pcl_transmission_mode : uint8
+{
+	/**
+	 * filtered point clouds, unprojected on the device
+	 */
+	POINT_CLOUD UMETA(DisplayName = "POINT_CLOUD"),
+
+	/**
+	 * raw depth images, unprojected and cropped by the server
+	 */
+	RAW_DEPTH UMETA(DisplayName = "RAW_DEPTH")
+};
+
+/**
+ * @enum pcl_compression
+ * encoding of transmitted point clouds
+ */
+UENUM(BlueprintType)
+enum class pcl_compression : uint8
+{
+	NONE UMETA(DisplayName = "NONE"),
+	DRACO UMETA(DisplayName = "DRACO"),
+	QUANTIZED_ZSTD UMETA(DisplayName = "QUANTIZED_ZSTD")
+};
+
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(F_state_delegate, state, old_state, state, new_state);
 
 /**
@@ -164,7 +186,8 @@ public:
 	 * polls for state of ar session and channel
 	 *
 	 * sets state to ready and initializes camera
-	 * if session is running and channel connected
+	 * if session is running and channel connected,
+	 * a camera set by @ref{set_camera} only needs the channel
 	 */
 	virtual void Tick(float DeltaTime) override;
 
@@ -182,6 +205,17 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "PCL Client")
 	state get_state() const;
 
+	/**
+	 * uses camera instead of spawning one for the sensor,
+	 * e.g. one replaying a recording without an ar session
+	 *
+	 * @attend ignored once the client left the INIT state
+	 * @attend while the camera replays, transmissions use a single
+	 * worker so the frames are sent in the recorded order
+	 */
+	UFUNCTION(BlueprintCallable, Category = "PCL Client")
+	void set_camera(A_camera* camera);
+
 	/**
 	 * toggles state asynchronously
 	 */
@@ -214,10 +248,96 @@ public:
 
 	/**
 	 * if true displays point cloud points
-	 * through voxels during transmission
+	 * through voxels during transmission,
+	 * raw depth frames are not displayed
 	 */
 	UPROPERTY(BlueprintReadWrite)
 	bool visualize = true;
+
+	/**
+	 * applies to transmissions started afterwards
+	 * @ref{compression}, @ref{downsample_leaf_size} and the depth
+	 * comparison of redundant frames only apply to point clouds
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "PCL Client")
+	pcl_transmission_mode transmission_mode = pcl_transmission_mode::POINT_CLOUD;
+
+	/**
+	 * encoding of transmitted point clouds,
+	 * applies to transmissions started afterwards
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "PCL Client")
+	pcl_compression compression = pcl_compression::NONE;
+
+	/**
+	 * maximum quantization error per axis in centimeters
+	 * of compressed transmissions
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "PCL Client", meta = (ClampMin = "0.01"))
+	float compression_precision = 0.1f;
+
+	/**
+	 * edge length in centimeters of the voxel grid the point clouds
+	 * are downsampled to before transmission, applies to
+	 * transmissions started afterwards, 0 transmits all points
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "PCL Client", meta = (ClampMin = "0"))
+	float downsample_leaf_size = 0.f;
+
+	/**
+	 * skips frames which hardly differ from the last sent one,
+	 * see @ref{frame_redundancy_filter}
+	 * the settings apply to transmissions started afterwards
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "PCL Client")
+	bool skip_redundant_frames = false;
+
+	/**
+	 * distance in centimeters the headset may move between sent frames
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "PCL Client", meta = (ClampMin = "0"))
+	float redundancy_translation = 2.f;
+
+	/**
+	 * angle in degrees the headset may turn between sent frames
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "PCL Client", meta = (ClampMin = "0"))
+	float redundancy_rotation = 2.f;
+
+	/**
+	 * fraction of the coarse depth image which may change between sent frames
+	 * 1 compares poses only
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "PCL Client", meta = (ClampMin = "0", ClampMax = "1"))
+	float redundancy_depth_change = 0.05f;
+
+	/**
+	 * seconds after which a frame is sent regardless of changes
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "PCL Client", meta = (ClampMin = "0"))
+	float keyframe_interval = 1.f;
+
+	/**
+	 * threads filtering and encoding point clouds,
+	 * applies to transmissions started afterwards
+	 * several workers may send frames out of order
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "PCL Client", meta = (ClampMin = "1"))
+	int32 worker_count = 3;
+
+	/**
+	 * encoded point clouds waiting for the stream,
+	 * workers block while it is full
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "PCL Client", meta = (ClampMin = "1"))
+	int32 send_queue_capacity = 4;
+
+	/**
+	 * @returns counters of the stages acquire (sensor to worker incl. unprojection),
+	 * redundancy (skipped frames are dropped), filter, encode and send (waiting for the stream)
+	 */
+	UFUNCTION(BlueprintCallable, Category = "PCL Client")
+	TArray<F_pcl_stage_metrics> get_pipeline_metrics() const;
 	void stop_Implementation() override;
 	
 private:
@@ -228,7 +348,7 @@ private:
 	 * @var voxel actor visualizing voxels
 	 */
 	UPROPERTY()
-	A_voxel* voxel;
+	A_voxel* voxel = nullptr;
 
 	/**
 	 * @var box_interface_obj holds currently assigned box interface
@@ -240,7 +360,7 @@ private:
 	 * HoloLens 2 depth camera access
 	 */
 	UPROPERTY()
-	A_camera* cam;
+	A_camera* cam = nullptr;
 
 	/**
 	 * to be called for every state change that doesn't expect
@@ -258,13 +378,55 @@ private:
 	 *
 	 * @attend returns immediately if channel disconnected
 	 *
-	 * pulls depth images from HoloLens 2, processes it with a
-	 * optional box_interface, displays it as voxels
+	 * runs the pipeline acquire -> filter -> encode -> send
+	 * the workers pull depth images from HoloLens 2, process them with a
+	 * optional box_interface, display them as voxels and encode them,
+	 * a single stream sends them and evaluates the response
 	 *
 	 * transmitted points are in meters
 	 */
 	grpc::Status send_point_clouds();
 
+	/**
+	 * streams raw depth frames instead of point clouds, the unit rays
+	 * of the sensor are sent once per resolution
+	 */
+	grpc::Status send_depth_frames();
+
+	/**
+	 * recreates @ref{workers} if @ref{worker_count} changed
+	 */
+	void update_workers();
+
+	/**
+	 * copies queue depth and drops of the camera into the acquire stage
+	 */
+	void update_camera_stats();
+
+	/**
+	 * records the time since the sensor captured a frame
+	 */
+	void record_frame_age(int64 abs_timestamp);
+
+	/**
+	 * runs the workers and the stream of one transmission,
+	 * the stage stats only cover this transmission
+	 * @param acquire acquire and filter stage, returns false if there is no frame
+	 * @param encode encode stage, returns false to drop the frame
+	 * @param prepare called in stream order right before a message is
+	 * written, e.g. to attach data to the first message
+	 * @param enqueued called by a worker once its frame is queued for sending
+	 */
+	template<typename Frame, typename Request>
+	grpc::Status stream_frames(
+		message_pool<Request>& pool,
+		const std::function<bool(size_t, Frame&)>& acquire,
+		const std::function<bool(size_t, const Frame&, Request&)>& encode,
+		std::function<std::unique_ptr<grpc::ClientAsyncWriter<Request>>(
+			grpc::ClientContext&, generated::ICP_Result*, grpc::CompletionQueue*)>&& factory,
+		std::function<void(Request&)>&& prepare = nullptr,
+		std::function<void(size_t)>&& enqueued = nullptr);
+
 	/**
 	 * @brief 
 	 * @param p point to be checked against filter
@@ -286,13 +448,36 @@ private:
 	
 	std::unique_ptr<generated::pcl_com::Stub> stub;
 
+	/**
+	 * shared by all workers
+	 */
+	message_pool<generated::Pcl_Data_Meta> pcl_pool;
+	message_pool<generated::Draco_Data> draco_pool;
+	message_pool<generated::Depth_Frame> depth_pool;
+
+	/**
+	 * persistent workers, recreated if @ref{worker_count} changed
+	 */
+	std::unique_ptr<worker_pool> workers;
+
+	pcl_stage_stats acquire_stats;
+	pcl_stage_stats redundancy_stats;
+	pcl_stage_stats filter_stats;
+	pcl_stage_stats encode_stats;
+	pcl_stage_stats send_stats;
+
+	/**
+	 * frames the camera dropped before the current transmission
+	 */
+	uint64 camera_dropped_baseline = 0;
+
 	std::atomic<state> current_state = state::INIT;
 
 	/**
 	 * @var set ensures idempotent return in case of no state change
 	 */
 	bool set = false;
-	BASE_CLIENT_BODY(
+	BASE_CLIENT_BODY_CLASS(traffic_class::BULK,
 		[this](const std::shared_ptr<grpc::Channel>& ch)
 		{
 			stub = generated::pcl_com::NewStub(ch);
@@ -0,0 +1,180 @@
+#include "pcl_codec.h"
+
+#include "grpc_include_begin.h"
+#include <draco/compression/decode.h>
+#include <draco/compression/encode.h>
+#include <draco/point_cloud/point_cloud_builder.h>
+#include <zstd.h>
+#include "grpc_include_end.h"
+
+std::unique_ptr<pcl_codec> pcl_codec::create(generated::Pcl_Codec codec, float precision)
+{
+	switch (codec)
+	{
+	case generated::DRACO_KD_TREE:
+		return std::make_unique<draco_codec>(precision);
+	case generated::QUANTIZED_ZSTD:
+		return std::make_unique<quantized_zstd_codec>(precision);
+	default:
+		return nullptr;
+	}
+}
+
+draco_codec::draco_codec(float precision)
+	: precision(precision)
+{}
+
+bool draco_codec::encode(const point_buffer& points, generated::Draco_Data& out) const
+{
+	draco::PointCloudBuilder builder;
+	builder.Start(points.Num());
+
+	const int att_id = builder.AddAttribute(draco::GeometryAttribute::POSITION, 3, draco::DataType::DT_FLOAT32);
+
+	FBox bounds(ForceInit);
+	for (int32 i = 0; i < points.Num(); ++i)
+	{
+		const float value[3] = { points.x()[i], points.y()[i], points.z()[i] };
+		builder.SetAttributeValueForPoint(att_id, draco::PointIndex(i), value);
+		bounds += FVector(value[0], value[1], value[2]);
+	}
+
+	const std::unique_ptr<draco::PointCloud> cloud = builder.Finalize(false);
+	if (!cloud)
+		return false;
+
+	/**
+	 * quantization bits covering the largest extent with the precision
+	 */
+	const double range = bounds.IsValid ? bounds.GetSize().GetMax() : 0.;
+	const int bits = FMath::Clamp(
+		FMath::CeilToInt(FMath::Log2(range / FMath::Max(2. * precision, UE_KINDA_SMALL_NUMBER) + 1.)), 1, 30);
+
+	draco::Encoder encoder;
+	encoder.SetEncodingMethod(draco::POINT_CLOUD_KD_TREE_ENCODING);
+	encoder.SetAttributeQuantization(draco::GeometryAttribute::POSITION, bits);
+	encoder.SetSpeedOptions(4, 1);
+
+	draco::EncoderBuffer buffer;
+	if (!encoder.EncodePointCloudToBuffer(*cloud, &buffer).ok())
+		return false;
+
+	out.set_codec(generated::DRACO_KD_TREE);
+	out.set_point_count(points.Num());
+	out.set_data(buffer.data(), buffer.size());
+	return true;
+}
+
+bool draco_codec::decode(const generated::Draco_Data& in, TArray<FVector>& out) const
+{
+	if (in.codec() != generated::DRACO_KD_TREE)
+		return false;
+
+	draco::DecoderBuffer buffer;
+	buffer.Init(in.data().data(), in.data().size());
+
+	draco::Decoder decoder;
+	auto result = decoder.DecodePointCloudFromBuffer(&buffer);
+	if (!result.ok())
+		return false;
+
+	const std::unique_ptr<draco::PointCloud> cloud = std::move(result).value();
+	const draco::PointAttribute* positions = cloud->GetNamedAttribute(draco::GeometryAttribute::POSITION);
+	if (!positions || positions->num_components() != 3)
+		return false;
+
+	out.SetNumUninitialized(cloud->num_points());
+	for (draco::PointIndex i(0); i < cloud->num_points(); ++i)
+	{
+		float value[3];
+		positions->GetMappedValue(i, value);
+		out[i.value()] = FVector(value[0], value[1], value[2]);
+	}
+	return true;
+}
+
+quantized_zstd_codec::quantized_zstd_codec(float precision, int level)
+	: precision(precision), level(level)
+{}
+
+bool quantized_zstd_codec::encode(const point_buffer& points, generated::Draco_Data& out) const
+{
+	const int32 count = points.Num();
+
+	FBox bounds(ForceInit);
+	for (int32 i = 0; i < count; ++i)
+		bounds += points.get(i);
+
+	const float* axes[3] = { points.x(), points.y(), points.z() };
+
+	const FVector origin = bounds.IsValid ? bounds.Min : FVector::ZeroVector;
+	const double range = bounds.IsValid ? bounds.GetSize().GetMax() : 0.;
+	const double step = FMath::Max3(2. * precision, range / TNumericLimits<uint16>::Max(), UE_KINDA_SMALL_NUMBER);
+	const double inv_step = 1. / step;
+
+	/**
+	 * one plane per axis, each holding deltas to the previous point
+	 * unsigned overflow is intended and undone by the decoder
+	 */
+	quantized.resize(3 * static_cast<size_t>(count));
+	for (int32 axis = 0; axis < 3; ++axis)
+	{
+		uint16* plane = quantized.data() + static_cast<size_t>(axis) * count;
+		const float* in = axes[axis];
+		uint16 previous = 0;
+		for (int32 i = 0; i < count; ++i)
+		{
+			const auto value = static_cast<uint16>(FMath::RoundToInt((in[i] - origin[axis]) * inv_step));
+			plane[i] = static_cast<uint16>(value - previous);
+			previous = value;
+		}
+	}
+
+	const size_t source_size = quantized.size() * sizeof(uint16);
+	std::string* data = out.mutable_data();
+	data->resize(ZSTD_compressBound(source_size));
+
+	const size_t size = ZSTD_compress(data->data(), data->size(), quantized.data(), source_size, level);
+	if (ZSTD_isError(size))
+		return false;
+	data->resize(size);
+
+	out.set_codec(generated::QUANTIZED_ZSTD);
+	out.set_point_count(count);
+	out.set_quantization_step(static_cast<float>(step));
+
+	auto* out_origin = out.mutable_origin();
+	out_origin->set_x(origin.X);
+	out_origin->set_y(origin.Y);
+	out_origin->set_z(origin.Z);
+	return true;
+}
+
+bool quantized_zstd_codec::decode(const generated::Draco_Data& in, TArray<FVector>& out) const
+{
+	if (in.codec() != generated::QUANTIZED_ZSTD)
+		return false;
+
+	const size_t count = in.point_count();
+	quantized.resize(3 * count);
+
+	const size_t size = ZSTD_decompress(quantized.data(), quantized.size() * sizeof(uint16), in.data().data(), in.data().size());
+	if (ZSTD_isError(size) || size != quantized.size() * sizeof(uint16))
+		return false;
+
+	const double step = in.quantization_step();
+	const FVector origin(in.origin().x(), in.origin().y(), in.origin().z());
+
+	out.SetNumUninitialized(count);
+	for (int32 axis = 0; axis < 3; ++axis)
+	{
+		const uint16* plane = quantized.data() + static_cast<size_t>(axis) * count;
+		uint16 value = 0;
+		for (size_t i = 0; i < count; ++i)
+		{
+			value = static_cast<uint16>(value + plane[i]);
+			out[i][axis] = origin[axis] + step * value;
+		}
+	}
+	return true;
+}
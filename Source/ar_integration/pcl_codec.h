@@ -0,0 +1,95 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "grpc_include_begin.h"
+#include "depth_image.pb.h"
+#include "grpc_include_end.h"
+
+#include "point_buffer.h"
+
+/**
+ * @class pcl_codec
+ *
+ * compression of point clouds into @ref{generated::Draco_Data}
+ * for pcl_com::transmit_draco_data
+ *
+ * @attend codecs keep scratch buffers, use one instance per thread
+ */
+class pcl_codec
+{
+public:
+
+	virtual ~pcl_codec() = default;
+
+	/**
+	 * fills data, codec, point_count and the codec specific fields of out
+	 * @returns false if encoding failed
+	 */
+	virtual bool encode(const point_buffer& points, generated::Draco_Data& out) const = 0;
+
+	/**
+	 * @returns false if in is corrupt or of another codec
+	 */
+	virtual bool decode(const generated::Draco_Data& in, TArray<FVector>& out) const = 0;
+
+	/**
+	 * @param precision maximum error per axis in the unit of the points
+	 */
+	static std::unique_ptr<pcl_codec> create(generated::Pcl_Codec codec, float precision);
+};
+
+/**
+ * @class draco_codec
+ *
+ * draco kd tree point cloud compression, the quantization
+ * bits are derived per cloud from its extent and the precision
+ *
+ * @attend draco reorders the points
+ */
+class draco_codec final : public pcl_codec
+{
+public:
+
+	explicit draco_codec(float precision);
+
+	bool encode(const point_buffer& points, generated::Draco_Data& out) const override;
+	bool decode(const generated::Draco_Data& in, TArray<FVector>& out) const override;
+
+private:
+
+	float precision;
+};
+
+/**
+ * @class quantized_zstd_codec
+ *
+ * quantizes points relative to the minimum of their bounding box
+ * to 16 bit per axis, stores every axis as deltas of consecutive points
+ * (neighbouring pixels of a depth image are close) and compresses with zstd
+ *
+ * the step grows beyond twice the precision if the extent of the cloud
+ * does not fit into 16 bit otherwise, points keep their order
+ *
+ * @attend data is little endian
+ */
+class quantized_zstd_codec final : public pcl_codec
+{
+public:
+
+	explicit quantized_zstd_codec(float precision, int level = 3);
+
+	bool encode(const point_buffer& points, generated::Draco_Data& out) const override;
+	bool decode(const generated::Draco_Data& in, TArray<FVector>& out) const override;
+
+private:
+
+	float precision;
+	int level;
+
+	mutable std::vector<uint16> quantized;
+};
@@ -0,0 +1,86 @@
+#include "pcl_pipeline.h"
+
+worker_pool::worker_pool(size_t thread_count)
+{
+	threads.reserve(thread_count);
+	for (size_t i = 0; i < thread_count; ++i)
+		threads.emplace_back(&worker_pool::work, this, i);
+}
+
+worker_pool::~worker_pool()
+{
+	std::unique_lock run_lock(run_mtx);
+	{
+		std::unique_lock lock(mtx);
+		stopping = true;
+	}
+	start_cv.notify_all();
+
+	for (auto& thread : threads)
+		thread.join();
+}
+
+size_t worker_pool::size() const
+{
+	return threads.size();
+}
+
+void worker_pool::run(const std::function<void(size_t)>& f)
+{
+	std::unique_lock run_lock(run_mtx);
+	std::unique_lock lock(mtx);
+
+	job = &f;
+	running = threads.size();
+	++generation;
+	start_cv.notify_all();
+
+	done_cv.wait(lock, [this]() { return running == 0; });
+	job = nullptr;
+}
+
+void worker_pool::work(size_t index)
+{
+	uint64_t seen = 0;
+	for (;;)
+	{
+		const std::function<void(size_t)>* current;
+		{
+			std::unique_lock lock(mtx);
+			start_cv.wait(lock, [this, seen]() { return stopping || generation != seen; });
+			if (stopping)
+				return;
+
+			seen = generation;
+			current = job;
+		}
+
+		(*current)(index);
+
+		std::unique_lock lock(mtx);
+		if (--running == 0)
+			done_cv.notify_all();
+	}
+}
+
+void pcl_stage_stats::record(std::chrono::nanoseconds latency)
+{
+	const auto ns = static_cast<uint64_t>(latency.count() > 0 ? latency.count() : 0);
+
+	processed.fetch_add(1, std::memory_order_relaxed);
+	total_ns.fetch_add(ns, std::memory_order_relaxed);
+
+	uint64_t prev = max_ns.load(std::memory_order_relaxed);
+	while (prev < ns && !max_ns.compare_exchange_weak(prev, ns, std::memory_order_relaxed))
+	{}
+}
+
+void pcl_stage_stats::reset()
+{
+	processed = 0;
+	dropped = 0;
+	total_ns = 0;
+	max_ns = 0;
+	queue_depth = 0;
+	bytes = 0;
+}
@@ -0,0 +1,89 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * @class worker_pool
+ *
+ * fixed set of threads kept alive between transmissions
+ * runs the same job on every thread and waits for all of them
+ * replacing threads spawned and joined per transmission
+ */
+class worker_pool final
+{
+public:
+
+	explicit worker_pool(size_t thread_count);
+
+	/**
+	 * waits for a running job and joins all threads
+	 */
+	~worker_pool();
+
+	worker_pool(const worker_pool&) = delete;
+	worker_pool& operator=(const worker_pool&) = delete;
+
+	size_t size() const;
+
+	/**
+	 * executes job(worker index) once on every thread
+	 * and blocks until all of them returned
+	 *
+	 * @attend concurrent calls are executed one after another
+	 */
+	void run(const std::function<void(size_t)>& job);
+
+private:
+
+	void work(size_t index);
+
+	std::mutex run_mtx;
+
+	std::mutex mtx;
+	std::condition_variable start_cv;
+	std::condition_variable done_cv;
+
+	const std::function<void(size_t)>* job = nullptr;
+	uint64_t generation = 0;
+	size_t running = 0;
+	bool stopping = false;
+
+	std::vector<std::thread> threads;
+};
+
+/**
+ * @class pcl_stage_stats
+ *
+ * lock free counters of one stage of the point cloud pipeline
+ */
+class pcl_stage_stats final
+{
+public:
+
+	/**
+	 * @var processed point clouds which passed the stage
+	 * @var dropped point clouds discarded by the stage
+	 * @var queue_depth point clouds waiting for the stage
+	 * at the last update
+	 * @var bytes output of the stage if it produces messages
+	 */
+	std::atomic_uint64_t processed = 0;
+	std::atomic_uint64_t dropped = 0;
+	std::atomic_uint64_t total_ns = 0;
+	std::atomic_uint64_t max_ns = 0;
+	std::atomic_uint64_t queue_depth = 0;
+	std::atomic_uint64_t bytes = 0;
+
+	/**
+	 * counts a processed point cloud which took latency
+	 */
+	void record(std::chrono::nanoseconds latency);
+
+	void reset();
+};
@@ -0,0 +1,296 @@
+#include "point_cloud_filter.h"
+
+namespace
+{
+	constexpr int32 block_size = 256;
+
+	/**
+	 * out = (x, y, z, 1) * m for a block of points
+	 */
+	void transform_block(const FMatrix& m, int32 count,
+		const double* RESTRICT x, const double* RESTRICT y, const double* RESTRICT z,
+		double* RESTRICT out_x, double* RESTRICT out_y, double* RESTRICT out_z)
+	{
+		const auto& M = m.M;
+		for (int32 i = 0; i < count; ++i)
+		{
+			out_x[i] = x[i] * M[0][0] + y[i] * M[1][0] + z[i] * M[2][0] + M[3][0];
+			out_y[i] = x[i] * M[0][1] + y[i] * M[1][1] + z[i] * M[2][1] + M[3][1];
+			out_z[i] = x[i] * M[0][2] + y[i] * M[1][2] + z[i] * M[2][2] + M[3][2];
+		}
+	}
+}
+
+point_cloud_crop::point_cloud_crop(const FTransform& camera_to_world, const F_obb* obb)
+	: to_world(camera_to_world.ToMatrixWithScale()),
+	to_box(FMatrix::Identity),
+	extent(FVector::ZeroVector),
+	crop(obb != nullptr)
+{
+	if (!obb)
+		return;
+
+	/**
+	 * camera -> world -> box space in one matrix
+	 */
+	const FTransform box_to_world(obb->rotation, obb->axis_box.GetCenter());
+	to_box = to_world * box_to_world.ToInverseMatrixWithScale();
+	extent = obb->axis_box.GetExtent();
+}
+
+int32 point_cloud_crop::apply(point_buffer& points) const
+{
+	alignas(64) double in[3][block_size];
+	alignas(64) double world[3][block_size];
+	alignas(64) double box[3][block_size];
+	alignas(64) uint8 inside[block_size];
+
+	int32 kept = 0;
+	for (int32 begin = 0; begin < points.Num(); begin += block_size)
+	{
+		const int32 count = FMath::Min(block_size, points.Num() - begin);
+
+		const float* x = points.x() + begin;
+		const float* y = points.y() + begin;
+		const float* z = points.z() + begin;
+		for (int32 i = 0; i < count; ++i)
+		{
+			in[0][i] = x[i];
+			in[1][i] = y[i];
+			in[2][i] = z[i];
+		}
+
+		transform_block(to_world, count, in[0], in[1], in[2], world[0], world[1], world[2]);
+
+		if (crop)
+		{
+			transform_block(to_box, count, in[0], in[1], in[2], box[0], box[1], box[2]);
+
+			for (int32 i = 0; i < count; ++i)
+			{
+				inside[i] = (FMath::Abs(box[0][i]) <= extent.X)
+					& (FMath::Abs(box[1][i]) <= extent.Y)
+					& (FMath::Abs(box[2][i]) <= extent.Z);
+			}
+		}
+		else
+		{
+			for (int32 i = 0; i < count; ++i)
+				inside[i] = 1;
+		}
+
+		/**
+		 * kept never passes the read position, the block
+		 * was copied out before anything is written back
+		 */
+		float* out_x = points.x();
+		float* out_y = points.y();
+		float* out_z = points.z();
+		for (int32 i = 0; i < count; ++i)
+		{
+			out_x[kept] = static_cast<float>(world[0][i]);
+			out_y[kept] = static_cast<float>(world[1][i]);
+			out_z[kept] = static_cast<float>(world[2][i]);
+			kept += inside[i];
+		}
+	}
+	return kept;
+}
+
+voxel_grid_filter::voxel_grid_filter(int32 expected_points)
+{
+	reserve(expected_points);
+}
+
+void voxel_grid_filter::reserve(int32 point_count)
+{
+	const uint32 needed = FMath::RoundUpToPowerOfTwo(FMath::Max(2 * point_count, 64));
+	if (static_cast<uint32>(cells.Num()) >= needed)
+		return;
+
+	/**
+	 * slots move with the table size, so all cells are dropped
+	 */
+	cells.Empty(needed);
+	cells.SetNumZeroed(needed);
+	occupied.Reserve(point_count);
+	shift = 64 - FMath::FloorLog2(needed);
+	stamp = 0;
+}
+
+int32 voxel_grid_filter::apply(point_buffer& points, double leaf_size)
+{
+	if (leaf_size <= 0. || points.IsEmpty())
+		return points.Num();
+
+	reserve(points.Num());
+
+	/**
+	 * a wrapped stamp could match stale cells
+	 */
+	if (++stamp == 0)
+	{
+		for (cell& c : cells)
+			c.stamp = 0;
+		stamp = 1;
+	}
+	occupied.Reset();
+
+	constexpr uint64 axis_mask = (uint64(1) << 21) - 1;
+	const double inv_leaf = 1. / leaf_size;
+	const uint64 mask = cells.Num() - 1;
+
+	const float* x = points.x();
+	const float* y = points.y();
+	const float* z = points.z();
+
+	for (int32 i = 0; i < points.Num(); ++i)
+	{
+		const FVector p(x[i], y[i], z[i]);
+		const uint64 key =
+			(static_cast<uint64>(FMath::FloorToInt64(p.X * inv_leaf)) & axis_mask) |
+			(static_cast<uint64>(FMath::FloorToInt64(p.Y * inv_leaf)) & axis_mask) << 21 |
+			(static_cast<uint64>(FMath::FloorToInt64(p.Z * inv_leaf)) & axis_mask) << 42;
+
+		/**
+		 * fibonacci hashing and linear probing, the table is
+		 * at most half full so probe sequences stay short
+		 */
+		uint64 slot = (key * 0x9E3779B97F4A7C15ull) >> shift;
+		while (cells[slot].stamp == stamp && cells[slot].key != key)
+			slot = (slot + 1) & mask;
+
+		cell& c = cells[slot];
+		if (c.stamp != stamp)
+		{
+			c = { key, stamp, 0, { 0., 0., 0. } };
+			occupied.Add(static_cast<uint32>(slot));
+		}
+
+		++c.count;
+		c.sum[0] += p.X;
+		c.sum[1] += p.Y;
+		c.sum[2] += p.Z;
+	}
+
+	/**
+	 * there are never more cells than points
+	 */
+	for (int32 i = 0; i < occupied.Num(); ++i)
+	{
+		const cell& c = cells[occupied[i]];
+		const double inv_count = 1. / c.count;
+		points.set(i, FVector(c.sum[0] * inv_count, c.sum[1] * inv_count, c.sum[2] * inv_count));
+	}
+	return occupied.Num();
+}
+
+frame_redundancy_filter::frame_redundancy_filter(double max_translation, double max_rotation,
+	double max_depth_change, std::chrono::milliseconds keyframe_interval)
+	: max_translation(max_translation),
+	max_rotation(FMath::DegreesToRadians(max_rotation)),
+	max_depth_change(max_depth_change),
+	keyframe_interval(keyframe_interval)
+{}
+
+bool frame_redundancy_filter::check(const FTransform& pose, const point_buffer& camera_points, candidate& out) const
+{
+	const bool compare_depth = max_depth_change < 1.;
+
+	signature depth;
+	if (compare_depth)
+		make_signature(camera_points, depth);
+
+	const auto now = std::chrono::steady_clock::now();
+
+	{
+		std::unique_lock lock(mtx);
+		const bool changed = !has_reference ||
+			now - reference_time >= keyframe_interval ||
+			FVector::Dist(pose.GetLocation(), reference_pose.GetLocation()) > max_translation ||
+			pose.GetRotation().AngularDistance(reference_pose.GetRotation()) > max_rotation ||
+			(compare_depth && depth_change(depth, reference_depth) > max_depth_change);
+
+		if (!changed)
+			return false;
+	}
+
+	out.pose = pose;
+	out.time = now;
+	if (compare_depth)
+		out.depth = depth;
+	return true;
+}
+
+void frame_redundancy_filter::commit(const candidate& frame)
+{
+	std::unique_lock lock(mtx);
+	if (has_reference && frame.time <= reference_time)
+		return;
+
+	has_reference = true;
+	reference_pose = frame.pose;
+	reference_time = frame.time;
+	reference_depth = frame.depth;
+}
+
+void frame_redundancy_filter::reset()
+{
+	std::unique_lock lock(mtx);
+	has_reference = false;
+}
+
+void frame_redundancy_filter::make_signature(const point_buffer& camera_points, signature& out)
+{
+	/**
+	 * the sensor looks along -x, cells cover the tangents
+	 * of the viewing directions in [-2, 2]
+	 */
+	constexpr double tangent_range = 2.;
+	constexpr double to_cell = grid / (2. * tangent_range);
+
+	std::array<uint32, grid * grid> counts = {};
+	out.fill(0.f);
+
+	const float* x = camera_points.x();
+	const float* y = camera_points.y();
+	const float* z = camera_points.z();
+
+	for (int32 i = 0; i < camera_points.Num(); ++i)
+	{
+		if (x[i] >= 0.f)
+			continue;
+
+		const float inv_forward = -1.f / x[i];
+		const int32 u = FMath::FloorToInt32((y[i] * inv_forward + tangent_range) * to_cell);
+		const int32 v = FMath::FloorToInt32((z[i] * inv_forward + tangent_range) * to_cell);
+		if (u < 0 || u >= grid || v < 0 || v >= grid)
+			continue;
+
+		out[v * grid + u] -= x[i];
+		++counts[v * grid + u];
+	}
+
+	for (int32 i = 0; i < grid * grid; ++i)
+		if (counts[i])
+			out[i] /= counts[i];
+}
+
+double frame_redundancy_filter::depth_change(const signature& a, const signature& b)
+{
+	/**
+	 * relative tolerance above the noise of the long throw sensor
+	 */
+	constexpr float tolerance = 0.02f;
+
+	int32 changed = 0;
+	for (int32 i = 0; i < grid * grid; ++i)
+	{
+		const bool occupied_a = a[i] > 0.f;
+		const bool occupied_b = b[i] > 0.f;
+
+		changed += occupied_a != occupied_b ||
+			FMath::Abs(a[i] - b[i]) > tolerance * FMath::Max(a[i], b[i]);
+	}
+	return static_cast<double>(changed) / (grid * grid);
+}
@@ -0,0 +1,188 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Math/Matrix.h"
+
+#include <array>
+#include <chrono>
+#include <mutex>
+
+#include "grpc_wrapper.h"
+#include "point_buffer.h"
+
+/**
+ * @class point_cloud_crop
+ *
+ * transforms point clouds of the depth camera into world space
+ * and crops them to an optional oriented bounding box
+ *
+ * the camera to world and camera to box space matrices are
+ * combined once per frame, points are processed in blocks
+ * as structure of arrays so the transformation and the box
+ * test run in SIMD lanes
+ */
+class point_cloud_crop final
+{
+public:
+
+	/**
+	 * @param camera_to_world transform of the point cloud into world space
+	 * @param obb box in world space to crop to, nullptr keeps all points
+	 */
+	point_cloud_crop(const FTransform& camera_to_world, const F_obb* obb);
+
+	/**
+	 * transforms points in place and moves the points inside the box
+	 * to the front keeping their order, the box is inclusive like
+	 * UKismetMathLibrary::IsPointInBoxWithTransform
+	 *
+	 * @returns number of points kept
+	 */
+	int32 apply(point_buffer& points) const;
+
+private:
+
+	FMatrix to_world;
+	FMatrix to_box;
+	FVector extent;
+	bool crop;
+};
+
+/**
+ * @class voxel_grid_filter
+ *
+ * downsamples point clouds to the centroids of the occupied
+ * cells of a uniform grid, e.g. to the density the server needs
+ *
+ * cells live in an open addressing hash table keyed by the
+ * quantized coordinates, the table is kept between frames
+ * and invalidated by a frame stamp instead of being cleared
+ *
+ * @attend not thread safe, use one instance per thread
+ * @attend cell indices are wrapped to 21 bit per axis
+ */
+class voxel_grid_filter final
+{
+public:
+
+	/**
+	 * @param expected_points preallocates the table for clouds of this size
+	 */
+	explicit voxel_grid_filter(int32 expected_points = 0);
+
+	/**
+	 * replaces points by the centroids of their cells, centroids are
+	 * ordered by the first point of their cell
+	 *
+	 * @param leaf_size edge length of the cells, points are kept if <= 0
+	 * @returns number of centroids written to the front of points
+	 */
+	int32 apply(point_buffer& points, double leaf_size);
+
+private:
+
+	struct cell
+	{
+		uint64 key;
+		uint32 stamp;
+		uint32 count;
+		double sum[3];
+	};
+
+	/**
+	 * grows the table to at least twice the number of points
+	 */
+	void reserve(int32 point_count);
+
+	TArray<cell> cells;
+	TArray<uint32> occupied;
+	uint32 shift = 64;
+	uint32 stamp = 0;
+};
+
+/**
+ * @class frame_redundancy_filter
+ *
+ * skips frames of a headset which hardly moved in a static scene
+ *
+ * a frame is compared against the last accepted one by the pose delta
+ * and optionally by a coarse depth image, the mean range of the points
+ * per cell of a grid over the viewing directions
+ *
+ * @attend thread safe, the signature of a frame is computed
+ * before the lock is taken
+ */
+class frame_redundancy_filter final
+{
+public:
+
+	/**
+	 * @param max_translation distance in cm the pose may move unnoticed
+	 * @param max_rotation angle in degrees the pose may turn unnoticed
+	 * @param max_depth_change fraction of cells of the coarse depth image
+	 * which may change unnoticed, depth is not compared if >= 1
+	 * @param keyframe_interval frames are accepted at least this often
+	 */
+	frame_redundancy_filter(double max_translation = 2., double max_rotation = 2.,
+		double max_depth_change = 0.05, std::chrono::milliseconds keyframe_interval = std::chrono::milliseconds(1000));
+
+	/**
+	 * cells per axis of the coarse depth image
+	 */
+	inline static constexpr int32 grid = 16;
+
+	typedef std::array<float, grid * grid> signature;
+
+	/**
+	 * frame which passed @ref{check}, not yet the reference
+	 */
+	struct candidate
+	{
+		FTransform pose;
+		signature depth = {};
+		std::chrono::steady_clock::time_point time;
+	};
+
+	/**
+	 * compares a frame against the reference without changing it
+	 * @param pose pose of the sensor e.g. @ref{F_located_point_cloud::location}
+	 * @param camera_points points in camera space before any transformation
+	 * @param out set to the frame if it is to be sent
+	 * @returns true if the frame is to be sent
+	 */
+	bool check(const FTransform& pose, const point_buffer& camera_points, candidate& out) const;
+
+	/**
+	 * makes a checked frame the reference once it was actually sent,
+	 * frames committed out of order don't replace a newer reference
+	 *
+	 * @attend frames checked concurrently before the commit
+	 * are all sent, at most one per worker
+	 */
+	void commit(const candidate& frame);
+
+	/**
+	 * forgets the reference, the next frame is accepted
+	 */
+	void reset();
+
+private:
+
+	static void make_signature(const point_buffer& camera_points, signature& out);
+
+	/**
+	 * @returns fraction of cells whose occupancy or mean range differs
+	 */
+	static double depth_change(const signature& a, const signature& b);
+
+	const double max_translation;
+	const double max_rotation;
+	const double max_depth_change;
+	const std::chrono::milliseconds keyframe_interval;
+
+	mutable std::mutex mtx;
+	bool has_reference = false;
+	FTransform reference_pose;
+	signature reference_depth = {};
+	std::chrono::steady_clock::time_point reference_time;
+};
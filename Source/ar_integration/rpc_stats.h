@@ -0,0 +1,96 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#include "grpc_include_begin.h"
+#include "grpcpp/support/client_interceptor.h"
+#include "grpc_include_end.h"
+
+/**
+ * @class rpc_method_stats
+ *
+ * lock free counters of a single rpc method
+ * updated by all calls of the method
+ */
+class rpc_method_stats final
+{
+public:
+
+	/**
+	 * @var latency_buckets bucket i counts calls with
+	 * a latency in [2^i, 2^(i+1)) microseconds
+	 */
+	inline static constexpr size_t latency_buckets = 24;
+
+	std::atomic_uint64_t calls = 0;
+	std::atomic_uint64_t failed = 0;
+
+	std::atomic_uint64_t messages_sent = 0;
+	std::atomic_uint64_t bytes_sent = 0;
+	std::atomic_uint64_t serialize_ns = 0;
+
+	std::atomic_uint64_t messages_received = 0;
+
+	/**
+	 * @var bytes_received serialized size of the messages
+	 * @var parse_ns time spent deserializing them
+	 * recorded by @ref{async_stream_reader}, which receives
+	 * the serialized messages, other calls leave them untouched
+	 */
+	std::atomic_uint64_t bytes_received = 0;
+	std::atomic_uint64_t parse_ns = 0;
+
+	std::array<std::atomic_uint64_t, latency_buckets> latency_histogram = {};
+
+	void record_latency(std::chrono::nanoseconds latency);
+
+	void reset();
+};
+
+/**
+ * @class rpc_metrics_registry
+ *
+ * thread safe collection of @ref{rpc_method_stats}
+ * keyed by the full method name e.g. /generated.pcl_com/transmit_pcl_data
+ */
+class rpc_metrics_registry final : public std::enable_shared_from_this<rpc_metrics_registry>
+{
+public:
+
+	/**
+	 * @returns stats of method, created on first use
+	 * the reference is valid for the lifetime of the registry
+	 */
+	rpc_method_stats& get(const char* method);
+
+	/**
+	 * calls f(method, stats) for every recorded method
+	 */
+	template<typename F>
+	void for_each(F&& f) const
+	{
+		std::unique_lock lock(mtx);
+		for (const auto& [method, stats] : methods)
+			f(method, *stats);
+	}
+
+	void reset();
+
+	/**
+	 * creates an interceptor factory for
+	 * grpc::experimental::CreateCustomChannelWithInterceptors
+	 * recording into this registry
+	 */
+	std::unique_ptr<grpc::experimental::ClientInterceptorFactoryInterface> create_interceptor_factory();
+
+private:
+
+	mutable std::mutex mtx;
+	std::unordered_map<std::string, std::unique_ptr<rpc_method_stats>> methods;
+};
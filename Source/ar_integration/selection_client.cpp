@@ -56,6 +56,7 @@ bool U_selection_client::request_scenario(scenario_type& scenario)
     }
 
     grpc::ClientContext ctx;
+    ctx.set_deadline(std::chrono::system_clock::now() + request_timeout);
     google::protobuf::Empty req;
     generated::scenario_request resp;
 
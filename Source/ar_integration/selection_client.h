@@ -56,6 +56,8 @@ public:
 
 	/*
 	 * requests the scenario type from the server
+	 *
+	 * @attend blocking call for at most @ref{request_timeout}
 	 */
 	UFUNCTION(BlueprintCallable, Category = "Selection")
 	bool request_scenario(scenario_type& scenario);
@@ -72,6 +74,12 @@ public:
 
 private:
 
+	/**
+	 * @var request_timeout deadline of unary calls
+	 * so a stalled server can't block the caller
+	 */
+	inline static constexpr std::chrono::seconds request_timeout{ 2 };
+
 	std::unique_ptr<generated::selection_com::Stub> stub_;
 
 	BASE_CLIENT_BODY
@@ -0,0 +1,334 @@
+#include "sparse_voxel_map.h"
+
+#include <algorithm>
+
+namespace
+{
+	/**
+	 * spreads the lower 21 bits of v to every third bit
+	 */
+	uint64 spread_bits(uint64 v)
+	{
+		v &= 0x1FFFFF;
+		v = (v | v << 32) & 0x1F00000000FFFFull;
+		v = (v | v << 16) & 0x1F0000FF0000FFull;
+		v = (v | v << 8) & 0x100F00F00F00F00Full;
+		v = (v | v << 4) & 0x10C30C30C30C30C3ull;
+		v = (v | v << 2) & 0x1249249249249249ull;
+		return v;
+	}
+}
+
+sparse_voxel_map::sparse_voxel_map(size_t memory_budget, eviction policy)
+{
+	set_budget(memory_budget, policy);
+}
+
+void sparse_voxel_map::set_budget(size_t memory_budget, eviction policy)
+{
+	/**
+	 * whole chunks, so the storage never outgrows the budget
+	 * unless it is smaller than a single chunk
+	 */
+	max_bricks = std::max<size_t>(memory_budget / brick_bytes / chunk_bricks, 1) * chunk_bricks;
+	this->policy = policy;
+}
+
+void sparse_voxel_map::set_frame(uint32 frame)
+{
+	this->frame = std::max(this->frame, frame);
+}
+
+uint64 sparse_voxel_map::brick_key(const FIntVector& voxel)
+{
+	/**
+	 * arithmetic shift floors negative indices, the bias
+	 * maps the brick coordinates to 21 unsigned bits
+	 */
+	constexpr int32 bias = 1 << 20;
+	return spread_bits(static_cast<uint64>((voxel.X >> brick_shift) + bias))
+		| spread_bits(static_cast<uint64>((voxel.Y >> brick_shift) + bias)) << 1
+		| spread_bits(static_cast<uint64>((voxel.Z >> brick_shift) + bias)) << 2;
+}
+
+bool sparse_voxel_map::insert(const FIntVector& voxel)
+{
+	const uint64 key = brick_key(voxel);
+
+	int32 slot = last_slot;
+	if (key != last_key)
+	{
+		if (const int32* found = index.Find(key))
+			slot = *found;
+		else
+		{
+			slot = allocate();
+
+			brick& b = at(slot);
+			b.origin = brick_origin(voxel);
+			b.count = 0;
+			b.total_hits = 0;
+			FMemory::Memzero(b.occupancy, sizeof(b.occupancy));
+
+			index.Add(key, slot);
+		}
+
+		last_key = key;
+		last_slot = slot;
+	}
+
+	brick& b = at(slot);
+	const int32 local = (voxel.X & (brick_size - 1))
+		| (voxel.Y & (brick_size - 1)) << brick_shift
+		| (voxel.Z & (brick_size - 1)) << (2 * brick_shift);
+
+	uint64& word = b.occupancy[local >> 6];
+	const uint64 bit = 1ull << (local & 63);
+
+	b.last_touch = frame;
+	++b.total_hits;
+	b.last_seen[local] = frame;
+
+	if (word & bit)
+	{
+		b.hits[local] += b.hits[local] != TNumericLimits<uint16>::Max();
+		return false;
+	}
+
+	word |= bit;
+	b.hits[local] = 1;
+	++b.count;
+	++counters.voxels;
+
+	added.Add(voxel);
+	return true;
+}
+
+int32 sparse_voxel_map::enforce_budget()
+{
+	if (live() <= max_bricks)
+		return 0;
+
+	/**
+	 * evict down to 15/16 of the budget so not every
+	 * new brick triggers another selection
+	 */
+	return evict_to(max_bricks - max_bricks / 16);
+}
+
+int32 sparse_voxel_map::allocate()
+{
+	/**
+	 * a full budget is freed before the storage grows
+	 */
+	if (free_slots.empty() && live() >= max_bricks)
+		evict_to(std::min(max_bricks - max_bricks / 16, live() - 1));
+
+	if (!free_slots.empty())
+	{
+		const int32 slot = free_slots.back();
+		free_slots.pop_back();
+		return slot;
+	}
+
+	if (slots % chunk_bricks == 0)
+		chunks.emplace_back(std::make_unique<brick[]>(chunk_bricks));
+	return slots++;
+}
+
+int32 sparse_voxel_map::evict_to(size_t target)
+{
+	if (live() <= target)
+		return 0;
+
+	std::vector<std::pair<uint64, int32>> candidates;
+	candidates.reserve(live());
+	for (int32 slot = 0; slot < slots; ++slot)
+	{
+		const brick& b = at(slot);
+		if (b.count == 0)
+			continue;
+
+		const uint64 score = policy == eviction::LEAST_RECENT
+			? b.last_touch
+			: std::min<uint64>(b.total_hits, 0xFFFFFFFFull) << 32 | b.last_touch;
+		candidates.emplace_back(score, slot);
+	}
+
+	const size_t count = live() - target;
+	std::nth_element(candidates.begin(), candidates.begin() + (count - 1), candidates.end());
+	for (size_t i = 0; i < count; ++i)
+		evict(candidates[i].second);
+
+	counters.evicted_bricks += static_cast<int64>(count);
+
+	/**
+	 * the consumer never sees voxels of bricks it is told to remove
+	 */
+	added.RemoveAllSwap([this](const FIntVector& voxel)
+		{
+			return !index.Contains(brick_key(voxel));
+		});
+
+	return static_cast<int32>(count);
+}
+
+void sparse_voxel_map::evict(int32 slot)
+{
+	brick& b = at(slot);
+
+	index.Remove(brick_key(b.origin));
+	counters.voxels -= b.count;
+	b.count = 0;
+
+	evicted.Add(b.origin);
+
+	free_slots.push_back(slot);
+
+	if (slot == last_slot)
+	{
+		last_key = ~0ull;
+		last_slot = -1;
+	}
+}
+
+void sparse_voxel_map::take_changes(TArray<FIntVector>& added, TArray<FIntVector>& evicted)
+{
+	/**
+	 * swapped so both buffers keep their capacity
+	 */
+	added.Reset();
+	Swap(added, this->added);
+	evicted.Reset();
+	Swap(evicted, this->evicted);
+}
+
+sparse_voxel_map_stats sparse_voxel_map::stats() const
+{
+	sparse_voxel_map_stats out = counters;
+	out.bricks = static_cast<int64>(live());
+	out.storage_bytes = static_cast<int64>(chunks.size() * chunk_bricks * sizeof(brick)
+		+ chunks.capacity() * sizeof(std::unique_ptr<brick[]>)
+		+ free_slots.capacity() * sizeof(int32)
+		+ index.GetAllocatedSize());
+	out.bytes = out.storage_bytes + static_cast<int64>(added.GetAllocatedSize() + evicted.GetAllocatedSize());
+	return out;
+}
+
+sharded_voxel_map::~sharded_voxel_map()
+{
+	release(batches.exchange(nullptr));
+}
+
+void sharded_voxel_map::set_budget(size_t memory_budget, sparse_voxel_map::eviction policy)
+{
+	budget.store(memory_budget, std::memory_order_relaxed);
+	this->policy.store(policy, std::memory_order_relaxed);
+}
+
+int32 sharded_voxel_map::shard_of(const FIntVector& voxel)
+{
+	/**
+	 * neighbouring bricks have similar morton codes,
+	 * the multiplication spreads them over the shards
+	 */
+	return static_cast<int32>((sparse_voxel_map::brick_key(voxel) * 0x9E3779B97F4A7C15ull) >> (64 - shard_bits));
+}
+
+void sharded_voxel_map::insert(TArrayView<const FIntVector> voxels)
+{
+	/**
+	 * sorted by shard first, so every shard is locked once
+	 */
+	thread_local std::array<TArray<FIntVector>, shard_count> buckets;
+	for (auto& bucket : buckets)
+		bucket.Reset();
+
+	for (const FIntVector& voxel : voxels)
+		buckets[shard_of(voxel)].Add(voxel);
+
+	const uint32 current = frame.fetch_add(1, std::memory_order_relaxed) + 1;
+	const size_t shard_budget = budget.load(std::memory_order_relaxed) / shard_count;
+	const auto current_policy = policy.load(std::memory_order_relaxed);
+
+	auto* occupied = new batch;
+	for (int32 i = 0; i < shard_count; ++i)
+	{
+		if (buckets[i].IsEmpty())
+			continue;
+
+		shard& s = shards[i];
+		std::unique_lock lock(s.mtx);
+
+		s.map.set_budget(shard_budget, current_policy);
+		s.map.set_frame(current);
+		for (const FIntVector& voxel : buckets[i])
+			s.map.insert(voxel);
+		s.map.enforce_budget();
+
+		s.map.take_changes(s.added, s.evicted);
+		++s.generation;
+		if (s.added.IsEmpty() && s.evicted.IsEmpty())
+			continue;
+
+		occupied->voxels.Append(s.added);
+		occupied->evicted.Append(s.evicted);
+		occupied->segments.Add({ i, s.generation, occupied->voxels.Num(), occupied->evicted.Num() });
+	}
+
+	if (occupied->segments.IsEmpty())
+	{
+		delete occupied;
+		return;
+	}
+
+	occupied->next = batches.load(std::memory_order_relaxed);
+	while (!batches.compare_exchange_weak(occupied->next, occupied,
+		std::memory_order_release, std::memory_order_relaxed))
+	{}
+}
+
+sharded_voxel_map::batch* sharded_voxel_map::take()
+{
+	/**
+	 * the stack holds the newest batch on top,
+	 * evictions have to be applied in order
+	 */
+	batch* newest = batches.exchange(nullptr, std::memory_order_acquire);
+	batch* oldest = nullptr;
+	while (newest)
+	{
+		batch* next = newest->next;
+		newest->next = oldest;
+		oldest = newest;
+		newest = next;
+	}
+	return oldest;
+}
+
+void sharded_voxel_map::release(batch* batches)
+{
+	while (batches)
+	{
+		batch* next = batches->next;
+		delete batches;
+		batches = next;
+	}
+}
+
+sparse_voxel_map_stats sharded_voxel_map::stats()
+{
+	sparse_voxel_map_stats out;
+	for (shard& s : shards)
+	{
+		std::unique_lock lock(s.mtx);
+		const sparse_voxel_map_stats stats = s.map.stats();
+
+		out.voxels += stats.voxels;
+		out.bricks += stats.bricks;
+		out.bytes += stats.bytes + s.added.GetAllocatedSize() + s.evicted.GetAllocatedSize();
+		out.storage_bytes += stats.storage_bytes;
+		out.evicted_bricks += stats.evicted_bricks;
+	}
+	return out;
+}
@@ -0,0 +1,362 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+/**
+ * @struct sparse_voxel_map_stats
+ * counters of a @ref{sparse_voxel_map}
+ *
+ * @var bytes memory held by the map including the voxels
+ * and evicted bricks not yet handed to the consumer
+ * @var storage_bytes memory held by bricks and the brick index,
+ * bounded by the memory budget
+ */
+struct sparse_voxel_map_stats
+{
+	int64 voxels = 0;
+	int64 bricks = 0;
+	int64 bytes = 0;
+	int64 storage_bytes = 0;
+	int64 evicted_bricks = 0;
+};
+
+/**
+ * @class sparse_voxel_map
+ *
+ * occupied voxel indices grouped into bricks of 8x8x8 voxels,
+ * a brick is allocated on the first voxel inside it and addressed
+ * by the morton code of its brick coordinates
+ *
+ * every voxel counts its hits and the frame it was last hit in,
+ * if the bricks exceed the memory budget the least recently
+ * respectively least hit ones are evicted
+ *
+ * @attend not thread safe
+ */
+class sparse_voxel_map final
+{
+public:
+
+	enum class eviction : uint8
+	{
+		LEAST_RECENT,
+		LEAST_HIT
+	};
+
+	inline static constexpr int32 brick_shift = 3;
+	inline static constexpr int32 brick_size = 1 << brick_shift;
+	inline static constexpr int32 brick_voxels = brick_size * brick_size * brick_size;
+
+	explicit sparse_voxel_map(size_t memory_budget = 256ull * 1024 * 1024, eviction policy = eviction::LEAST_RECENT);
+
+	/**
+	 * takes effect on the next brick allocation respectively
+	 * @ref{enforce_budget}
+	 */
+	void set_budget(size_t memory_budget, eviction policy);
+
+	/**
+	 * voxels hit from now on are hit in frame,
+	 * the frame never goes back
+	 */
+	void set_frame(uint32 frame);
+
+	/**
+	 * counts a hit of voxel
+	 * @returns true if voxel was not occupied before
+	 */
+	bool insert(const FIntVector& voxel);
+
+	/**
+	 * evicts bricks until the map fits into its budget
+	 * @returns number of evicted bricks
+	 */
+	int32 enforce_budget();
+
+	/**
+	 * moves the voxels occupied and the origins of the bricks
+	 * evicted since the last call into added respectively evicted
+	 *
+	 * voxels of bricks evicted after their occupation are not listed,
+	 * so removing evicted before adding added follows the map
+	 */
+	void take_changes(TArray<FIntVector>& added, TArray<FIntVector>& evicted);
+
+	/**
+	 * calls f(voxel, hits, age) for every occupied voxel
+	 * age is the number of frames since the last hit
+	 */
+	template<typename F>
+	void for_each(F&& f) const
+	{
+		for (int32 slot = 0; slot < slots; ++slot)
+		{
+			const brick& b = at(slot);
+			if (b.count == 0)
+				continue;
+
+			for (int32 word = 0; word < brick_voxels / 64; ++word)
+			{
+				uint64 bits = b.occupancy[word];
+				while (bits)
+				{
+					const int32 local = word * 64 + FMath::CountTrailingZeros64(bits);
+					bits &= bits - 1;
+
+					const FIntVector voxel = b.origin + FIntVector(
+						local & (brick_size - 1),
+						(local >> brick_shift) & (brick_size - 1),
+						local >> (2 * brick_shift));
+					f(voxel, b.hits[local], frame - b.last_seen[local]);
+				}
+			}
+		}
+	}
+
+	sparse_voxel_map_stats stats() const;
+
+	/**
+	 * @returns morton code of the brick containing voxel
+	 */
+	static uint64 brick_key(const FIntVector& voxel);
+
+	/**
+	 * @returns smallest voxel of the brick containing voxel
+	 */
+	static FIntVector brick_origin(const FIntVector& voxel)
+	{
+		return FIntVector(
+			voxel.X & ~(brick_size - 1),
+			voxel.Y & ~(brick_size - 1),
+			voxel.Z & ~(brick_size - 1));
+	}
+
+private:
+
+	struct brick
+	{
+		FIntVector origin;
+		int32 count = 0;
+		uint32 last_touch = 0;
+		uint64 total_hits = 0;
+
+		uint64 occupancy[brick_voxels / 64];
+		uint16 hits[brick_voxels];
+		uint32 last_seen[brick_voxels];
+	};
+
+	/**
+	 * bytes per brick including its entry in the index
+	 */
+	static constexpr size_t brick_bytes = sizeof(brick) + sizeof(TPair<uint64, int32>) + 2 * sizeof(int32);
+
+	/**
+	 * bricks are allocated in chunks which never move, so growing
+	 * copies no brick and allocates at most one chunk beyond the budget
+	 */
+	inline static constexpr int32 chunk_bricks = 16;
+
+	brick& at(int32 slot)
+	{
+		return chunks[slot / chunk_bricks][slot % chunk_bricks];
+	}
+
+	const brick& at(int32 slot) const
+	{
+		return chunks[slot / chunk_bricks][slot % chunk_bricks];
+	}
+
+	/**
+	 * @returns slot of a new brick, evicts first if the budget is used up
+	 */
+	int32 allocate();
+
+	/**
+	 * evicts the bricks ranked lowest by the policy until target are left
+	 */
+	int32 evict_to(size_t target);
+
+	void evict(int32 slot);
+
+	size_t live() const
+	{
+		return static_cast<size_t>(slots) - free_slots.size();
+	}
+
+	size_t max_bricks;
+	eviction policy;
+
+	uint32 frame = 0;
+
+	std::vector<std::unique_ptr<brick[]>> chunks;
+	int32 slots = 0;
+	std::vector<int32> free_slots;
+	TMap<uint64, int32> index;
+
+	/**
+	 * cache of the brick hit last, neighbouring points
+	 * of a cloud mostly fall into the same brick
+	 */
+	uint64 last_key = ~0ull;
+	int32 last_slot = -1;
+
+	TArray<FIntVector> added;
+	TArray<FIntVector> evicted;
+
+	sparse_voxel_map_stats counters;
+};
+
+/**
+ * @class sharded_voxel_map
+ *
+ * @ref{sparse_voxel_map} split by brick into shards with a lock each,
+ * so producers on several threads only contend if they hit the
+ * same shard at the same time
+ *
+ * voxels occupied and bricks evicted by an insert are handed to the
+ * consumer as one batch on a lock free stack, taking all batches
+ * is a single exchange
+ */
+class sharded_voxel_map final
+{
+public:
+
+	inline static constexpr int32 shard_bits = 4;
+	inline static constexpr int32 shard_count = 1 << shard_bits;
+
+	/**
+	 * generation of every shard, counting the inserts into it
+	 */
+	typedef std::array<uint64, shard_count> generations;
+
+	/**
+	 * changes of one @ref{insert}, evicted holds brick origins
+	 * and has to be applied before voxels
+	 */
+	struct batch
+	{
+		/**
+		 * changes of one shard, ending at voxels_end
+		 * respectively evicted_end of the batch
+		 */
+		struct segment
+		{
+			int32 shard = 0;
+			uint64 generation = 0;
+			int32 voxels_end = 0;
+			int32 evicted_end = 0;
+		};
+
+		TArray<FIntVector> voxels;
+		TArray<FIntVector> evicted;
+		TArray<segment, TInlineAllocator<shard_count>> segments;
+		batch* next = nullptr;
+
+		/**
+		 * calls f(voxels, evicted) with the changes of every shard
+		 * which are newer than the generations read by @ref{for_each}
+		 */
+		template<typename F>
+		void for_each_newer(const generations& read, F&& f) const
+		{
+			int32 voxels_begin = 0;
+			int32 evicted_begin = 0;
+			for (const segment& s : segments)
+			{
+				if (s.generation > read[s.shard])
+					f(TArrayView<const FIntVector>(voxels.GetData() + voxels_begin, s.voxels_end - voxels_begin),
+						TArrayView<const FIntVector>(evicted.GetData() + evicted_begin, s.evicted_end - evicted_begin));
+
+				voxels_begin = s.voxels_end;
+				evicted_begin = s.evicted_end;
+			}
+		}
+	};
+
+	sharded_voxel_map() = default;
+	~sharded_voxel_map();
+
+	sharded_voxel_map(const sharded_voxel_map&) = delete;
+	sharded_voxel_map& operator=(const sharded_voxel_map&) = delete;
+
+	/**
+	 * applies to all following inserts
+	 * @param memory_budget of all shards together
+	 */
+	void set_budget(size_t memory_budget, sparse_voxel_map::eviction policy);
+
+	/**
+	 * counts a hit for every voxel as one frame
+	 * and evicts bricks of shards beyond their budget
+	 *
+	 * thread safe
+	 */
+	void insert(TArrayView<const FIntVector> voxels);
+
+	/**
+	 * takes all batches pushed so far, oldest first
+	 * the caller owns them and frees them with @ref{release}
+	 *
+	 * lock free, reverses the taken batches
+	 */
+	batch* take();
+
+	static void release(batch* batches);
+
+	/**
+	 * calls f(voxel, hits, age) for every occupied voxel
+	 * locking one shard at a time
+	 * @returns generations of the shards when they were read, batches
+	 * taken afterwards may hold changes which were already read,
+	 * @ref{batch::for_each_newer} skips them
+	 */
+	template<typename F>
+	generations for_each(F&& f)
+	{
+		generations read;
+		for (int32 i = 0; i < shard_count; ++i)
+		{
+			shard& s = shards[i];
+			std::unique_lock lock(s.mtx);
+			s.map.for_each(f);
+			read[i] = s.generation;
+		}
+		return read;
+	}
+
+	sparse_voxel_map_stats stats();
+
+	/**
+	 * @returns shard of the brick containing voxel
+	 */
+	static int32 shard_of(const FIntVector& voxel);
+
+private:
+
+	/**
+	 * separate cache lines to avoid false sharing of the locks
+	 */
+	struct alignas(64) shard
+	{
+		std::mutex mtx;
+		sparse_voxel_map map;
+		uint64 generation = 0;
+		TArray<FIntVector> added;
+		TArray<FIntVector> evicted;
+	};
+
+	std::array<shard, shard_count> shards;
+
+	std::atomic<size_t> budget = 256ull * 1024 * 1024;
+	std::atomic<sparse_voxel_map::eviction> policy = sparse_voxel_map::eviction::LEAST_RECENT;
+	std::atomic_uint32_t frame = 0;
+
+	std::atomic<batch*> batches = nullptr;
+};
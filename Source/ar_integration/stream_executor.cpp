@@ -0,0 +1,143 @@
+#include "stream_executor.h"
+
+namespace
+{
+	std::mutex instance_mtx;
+
+	/**
+	 * not a function local static, its destructor would join
+	 * the threads during static destruction
+	 */
+	stream_executor* instance = nullptr;
+}
+
+stream_executor& stream_executor::get()
+{
+	std::unique_lock lock(instance_mtx);
+	/**
+	 * two threads keep one slow handler
+	 * from stalling all other streams
+	 */
+	if (!instance)
+		instance = new stream_executor(2);
+	return *instance;
+}
+
+bool stream_executor::shutdown(std::chrono::milliseconds timeout)
+{
+	stream_executor* executor;
+	{
+		std::unique_lock lock(instance_mtx);
+		executor = instance;
+		instance = nullptr;
+	}
+
+	if (!executor)
+		return true;
+
+	bool finished;
+	{
+		std::unique_lock lock(executor->streams_mtx);
+		for (stream_completion* stream : executor->streams)
+			stream->abort();
+
+		finished = executor->streams_cv.wait_for(lock, timeout,
+			[executor]() { return executor->streams.empty(); });
+	}
+
+	/**
+	 * operations started on a shut down queue fail,
+	 * so a stream still running keeps the executor alive
+	 */
+	if (!finished)
+	{
+		for (auto& thread : executor->threads)
+			thread.detach();
+		return false;
+	}
+
+	delete executor;
+	return true;
+}
+
+stream_executor::stream_executor(size_t thread_count)
+{
+	threads.reserve(thread_count);
+	for (size_t i = 0; i < thread_count; ++i)
+		threads.emplace_back(&stream_executor::run, this);
+}
+
+stream_executor::~stream_executor()
+{
+	cq.Shutdown();
+	for (auto& thread : threads)
+		thread.join();
+}
+
+grpc::CompletionQueue* stream_executor::queue()
+{
+	return &cq;
+}
+
+void stream_executor::run()
+{
+	void* tag;
+	bool ok;
+	while (cq.Next(&tag, &ok))
+		static_cast<stream_operation*>(tag)->proceed(ok);
+}
+
+void stream_executor::attach(stream_completion* stream)
+{
+	std::unique_lock lock(streams_mtx);
+	streams.insert(stream);
+}
+
+void stream_executor::detach(stream_completion* stream)
+{
+	std::unique_lock lock(streams_mtx);
+	streams.erase(stream);
+	streams_cv.notify_all();
+}
+
+stream_completion::stream_completion()
+	: executor(stream_executor::get())
+{
+	executor.attach(this);
+}
+
+void stream_completion::abort()
+{
+	ctx.TryCancel();
+}
+
+bool stream_completion::done() const
+{
+	std::unique_lock lock(done_mtx);
+	return finished;
+}
+
+void stream_completion::wait() const
+{
+	std::unique_lock lock(done_mtx);
+	done_cv.wait(lock, [this]() { return finished; });
+}
+
+void stream_completion::finish_stream()
+{
+	/**
+	 * notify while holding the lock, the waiting
+	 * destructor may free this right after
+	 */
+	executor.detach(this);
+	std::unique_lock lock(done_mtx);
+	finished = true;
+	done_cv.notify_all();
+}
+
+void stream_completion::cancel_and_wait()
+{
+	if (!done())
+		ctx.TryCancel();
+	wait();
+}
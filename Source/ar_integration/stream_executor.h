@@ -0,0 +1,474 @@
+#pragma once
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+
+#include "grpc_include_begin.h"
+#include <grpcpp/client_context.h>
+#include <grpcpp/completion_queue.h>
+#include <grpcpp/impl/codegen/proto_utils.h>
+#include <grpcpp/impl/rpc_method.h>
+#include <grpcpp/support/async_stream.h>
+#include <grpcpp/support/byte_buffer.h>
+#include <grpcpp/support/proto_buffer_reader.h>
+#include "grpc_include_end.h"
+
+#include "message_pool.h"
+#include "rpc_stats.h"
+
+/**
+ * @class stream_operation
+ *
+ * tag of the @ref{stream_executor}
+ * every operation has at most one pending event
+ * so @ref{proceed} is never called concurrently
+ */
+class stream_operation
+{
+public:
+
+	virtual ~stream_operation() = default;
+
+	/**
+	 * called by the executor once the pending event completed
+	 * @param ok result of the completion queue for the event
+	 */
+	virtual void proceed(bool ok) = 0;
+
+protected:
+
+	/**
+	 * @returns tag of this operation for the completion queue
+	 * the executor casts tags back to stream_operation, so derived
+	 * classes must not pass their own this pointer
+	 */
+	void* tag()
+	{
+		return static_cast<stream_operation*>(this);
+	}
+};
+
+class stream_completion;
+
+/**
+ * @class stream_executor
+ *
+ * process wide completion queue shared by all client streams
+ * replacing a blocked thread per stream by
+ * a small fixed number of polling threads
+ *
+ * the executor is never destroyed during static destruction,
+ * the module stops it explicitly by @ref{shutdown}
+ */
+class stream_executor final
+{
+public:
+
+	/**
+	 * @returns executor, started on first use or after a @ref{shutdown}
+	 */
+	static stream_executor& get();
+
+	/**
+	 * aborts all running streams, waits until they finished,
+	 * shuts the completion queue down and joins the threads
+	 *
+	 * @param timeout for the streams to finish, the executor is
+	 * leaked and its threads detached if it is exceeded
+	 * @returns false if streams did not finish in time
+	 * @attend no stream may be started concurrently
+	 */
+	static bool shutdown(std::chrono::milliseconds timeout = std::chrono::seconds(5));
+
+	grpc::CompletionQueue* queue();
+
+private:
+
+	friend class stream_completion;
+
+	explicit stream_executor(size_t thread_count);
+	~stream_executor();
+
+	void run();
+
+	void attach(stream_completion* stream);
+	void detach(stream_completion* stream);
+
+	grpc::CompletionQueue cq;
+	std::vector<std::thread> threads;
+
+	/**
+	 * streams which may still have a pending event
+	 */
+	std::mutex streams_mtx;
+	std::condition_variable streams_cv;
+	std::unordered_set<stream_completion*> streams;
+};
+
+/**
+ * @class stream_completion
+ *
+ * shared bookkeeping of @ref{async_stream_reader} and @ref{async_stream_writer}
+ * mirrors the semantics of the former stream_thread
+ * destruction aborts the stream and waits until it finished
+ */
+class stream_completion
+{
+public:
+
+	/**
+	 * returns true if transmission is already done
+	 */
+	bool done() const;
+
+	/**
+	 * blocks until transmission is done
+	 */
+	void wait() const;
+
+protected:
+
+	stream_completion();
+	~stream_completion() = default;
+
+	/**
+	 * aborts the stream without waiting, called by
+	 * @ref{stream_executor::shutdown} while the stream is running
+	 */
+	virtual void abort();
+
+	void finish_stream();
+
+	/**
+	 * aborts the stream if it is still running and waits for it
+	 * @attend has to be called in the destructor of the derived class
+	 * and never from within one of its callbacks
+	 */
+	void cancel_and_wait();
+
+	stream_executor& executor;
+	grpc::ClientContext ctx;
+	grpc::Status status;
+
+private:
+
+	friend class stream_executor;
+
+	mutable std::mutex done_mtx;
+	mutable std::condition_variable done_cv;
+	bool finished = false;
+};
+
+/**
+ * prepares a server streaming call which receives the serialized
+ * messages, called like the generated stubs but by method name
+ * e.g. prepare_stream(channel, "/generated.robot_com/transmit_voxels", ctx, request, cq)
+ *
+ * @attend method has to outlive the call, e.g. a string literal
+ */
+template<typename Request>
+std::unique_ptr<grpc::ClientAsyncReader<grpc::ByteBuffer>> prepare_stream(grpc::ChannelInterface* channel,
+	const char* method, grpc::ClientContext& ctx, const Request& request, grpc::CompletionQueue* cq)
+{
+	return std::unique_ptr<grpc::ClientAsyncReader<grpc::ByteBuffer>>(
+		grpc::internal::ClientAsyncReaderFactory<grpc::ByteBuffer>::Create(channel, cq,
+			grpc::internal::RpcMethod(method, grpc::internal::RpcMethod::SERVER_STREAMING),
+			&ctx, request, false, nullptr));
+}
+
+/**
+ * @class async_stream_reader
+ *
+ * server streaming call on the @ref{stream_executor}
+ * calls handler for every received message and
+ * finisher with the final status
+ *
+ * messages are received serialized and parsed into handles
+ * of a @ref{message_pool}, the handler may keep a message
+ * by moving its handle
+ */
+template<typename Response>
+class async_stream_reader final : public stream_operation, public stream_completion
+{
+public:
+
+	typedef std::function<std::unique_ptr<grpc::ClientAsyncReader<grpc::ByteBuffer>>(
+		grpc::ClientContext&, grpc::CompletionQueue*)> factory_function;
+	typedef typename message_pool<Response>::handle message_handle;
+	typedef std::function<void(message_handle&)> handler_function;
+	typedef std::function<void(const grpc::Status&)> finish_function;
+
+	/**
+	 * starts the stream
+	 * @param factory prepares the call with @ref{prepare_stream}
+	 * @param handler executed on an executor thread per message
+	 * @param finisher executed on an executor thread after the stream finished
+	 * @param pool provides the messages, a private one is used if nullptr
+	 * @param stats receives the size and parse time of the messages, may be nullptr
+	 * @attend pool and stats have to outlive the reader
+	 */
+	async_stream_reader(factory_function&& factory, handler_function&& handler, finish_function&& finisher = nullptr,
+		message_pool<Response>* pool = nullptr, rpc_method_stats* stats = nullptr)
+		: handler(std::move(handler)), finisher(std::move(finisher)),
+		own_pool(pool ? nullptr : std::make_unique<message_pool<Response>>()),
+		pool(pool ? pool : own_pool.get()), stats(stats)
+	{
+		message = this->pool->acquire();
+		reader = factory(ctx, executor.queue());
+		reader->StartCall(tag());
+	}
+
+	/**
+	 * Aborts transmission if still running
+	 */
+	~async_stream_reader() override
+	{
+		cancel_and_wait();
+	}
+
+	void proceed(bool ok) override
+	{
+		switch (step)
+		{
+		case stage::START:
+		case stage::READ:
+			if (ok && step == stage::READ)
+			{
+				/**
+				 * a corrupt message fails the stream
+				 * like the parsing of the generated stubs
+				 */
+				if (parse())
+					handler(message);
+				else
+					ctx.TryCancel();
+			}
+
+			if (ok)
+			{
+				if (!message)
+					message = pool->acquire();
+
+				step = stage::READ;
+				reader->Read(&buffer, tag());
+				return;
+			}
+
+			step = stage::FINISH;
+			reader->Finish(&status, tag());
+			return;
+
+		case stage::FINISH:
+			if (finisher)
+				finisher(status);
+			finish_stream();
+			return;
+		}
+	}
+
+private:
+
+	enum class stage : uint8_t
+	{
+		START,
+		READ,
+		FINISH
+	};
+
+	/**
+	 * parses buffer into message and records its size and parse time
+	 */
+	bool parse()
+	{
+		const auto start = std::chrono::steady_clock::now();
+		const size_t bytes = buffer.Length();
+
+		bool parsed;
+		{
+			grpc::ProtoBufferReader input(&buffer);
+			parsed = input.status().ok() && message->ParseFromZeroCopyStream(&input);
+		}
+		buffer.Clear();
+
+		if (stats)
+		{
+			stats->parse_ns.fetch_add(std::chrono::duration_cast<std::chrono::nanoseconds>(
+				std::chrono::steady_clock::now() - start).count(), std::memory_order_relaxed);
+			stats->bytes_received.fetch_add(bytes, std::memory_order_relaxed);
+		}
+		return parsed;
+	}
+
+	handler_function handler;
+	finish_function finisher;
+
+	std::unique_ptr<message_pool<Response>> own_pool;
+	message_pool<Response>* pool;
+	rpc_method_stats* stats;
+
+	stage step = stage::START;
+	message_handle message;
+	grpc::ByteBuffer buffer;
+	std::unique_ptr<grpc::ClientAsyncReader<grpc::ByteBuffer>> reader;
+};
+
+/**
+ * @class async_stream_writer
+ *
+ * client streaming call on the @ref{stream_executor}
+ * pulls messages from source whenever the previous write finished
+ * or @ref{kick} is called and the stream is idle
+ *
+ * a written message is released once its write completed
+ */
+template<typename Request, typename Response>
+class async_stream_writer final : public stream_operation, public stream_completion
+{
+public:
+
+	typedef std::function<std::unique_ptr<grpc::ClientAsyncWriter<Request>>(
+		grpc::ClientContext&, Response*, grpc::CompletionQueue*)> factory_function;
+	typedef typename message_pool<Request>::handle message_handle;
+	typedef std::function<bool(message_handle&)> source_function;
+	typedef std::function<void(const grpc::Status&, const Response&)> finish_function;
+
+	/**
+	 * starts the stream
+	 * @param factory prepares the call e.g. stub->PrepareAsyncfoo(&ctx, response, cq)
+	 * @param source hands out the next message e.g. taken from a queue
+	 * or acquired from a @ref{message_pool}, returns false if there is none
+	 * @param finisher executed on an executor thread after the stream finished
+	 */
+	async_stream_writer(factory_function&& factory, source_function&& source, finish_function&& finisher = nullptr)
+		: source(std::move(source)), finisher(std::move(finisher))
+	{
+		std::unique_lock lock(mtx);
+		writer = factory(ctx, &response, executor.queue());
+		writer->StartCall(tag());
+	}
+
+	/**
+	 * Aborts transmission if still running
+	 */
+	~async_stream_writer() override
+	{
+		abort();
+		cancel_and_wait();
+	}
+
+	/**
+	 * writes the next message of source if the stream is idle
+	 */
+	void kick()
+	{
+		std::unique_lock lock(mtx);
+		if (step == stage::IDLE)
+			next();
+	}
+
+	/**
+	 * ends the stream gracefully after the pending write
+	 */
+	void close()
+	{
+		std::unique_lock lock(mtx);
+		closing = true;
+		if (step == stage::IDLE)
+			next();
+	}
+
+	void proceed(bool ok) override
+	{
+		std::unique_lock lock(mtx);
+		switch (step)
+		{
+		case stage::START:
+		case stage::WRITE:
+			if (!ok)
+			{
+				step = stage::FINISH;
+				writer->Finish(&status, tag());
+				return;
+			}
+			step = stage::IDLE;
+			next();
+			return;
+
+		case stage::WRITES_DONE:
+			step = stage::FINISH;
+			writer->Finish(&status, tag());
+			return;
+
+		case stage::FINISH:
+			lock.unlock();
+			if (finisher)
+				finisher(status, response);
+			finish_stream();
+			return;
+
+		case stage::IDLE:
+			return;
+		}
+	}
+
+private:
+
+	/**
+	 * an idle stream has no pending event
+	 * which could complete due to the cancellation
+	 */
+	void abort() override
+	{
+		std::unique_lock lock(mtx);
+		ctx.TryCancel();
+		if (step == stage::IDLE)
+		{
+			step = stage::FINISH;
+			writer->Finish(&status, tag());
+		}
+	}
+
+	enum class stage : uint8_t
+	{
+		START,
+		IDLE,
+		WRITE,
+		WRITES_DONE,
+		FINISH
+	};
+
+	/**
+	 * @attend expects mtx to be locked and the stream to be idle
+	 */
+	void next()
+	{
+		if (closing)
+		{
+			step = stage::WRITES_DONE;
+			writer->WritesDone(tag());
+			return;
+		}
+
+		message.reset();
+		if (!source(message) || !message)
+			return;
+
+		step = stage::WRITE;
+		writer->Write(*message, tag());
+	}
+
+	source_function source;
+	finish_function finisher;
+
+	std::mutex mtx;
+	stage step = stage::START;
+	bool closing = false;
+
+	message_handle message;
+	Response response;
+	std::unique_ptr<grpc::ClientAsyncWriter<Request>> writer;
+};
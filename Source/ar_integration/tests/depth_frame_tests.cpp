@@ -0,0 +1,176 @@
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+#include "Misc/Paths.h"
+
+#include "recorded_frames.h"
+#include "util.h"
+
+namespace
+{
+	/**
+	 * unprojects like A_camera::process did before depth_unprojection,
+	 * a mapping call and a normalization per valid pixel
+	 */
+	void unproject_per_pixel(const depth_frame_view& frame,
+		const depth_unprojection::unit_plane_mapping& map_to_unit_plane, TArray<FVector>& out)
+	{
+		const int32 pixels = static_cast<int32>(frame.width * frame.height);
+
+		int32 needed_size = pixels;
+		for (int32 i = 0; i < pixels; ++i)
+			if (frame.sigma[i] & 0x80)
+				--needed_size;
+		out.Reset(needed_size);
+
+		for (uint32 i = 0, index = 0; i < frame.height; ++i)
+		{
+			for (uint32 j = 0; j < frame.width; ++j, ++index)
+			{
+				if (frame.sigma[index] & 0x80)
+					continue;
+
+				float uv[2] = { static_cast<float>(j), static_cast<float>(i) };
+				float xy[2];
+				if (!map_to_unit_plane(uv, xy))
+					continue;
+
+				FVector vertex(xy[0], xy[1], 1.f);
+				vertex.Normalize();
+				vertex *= static_cast<float>(frame.depth[index]) / 10.f;
+
+				out.Add(FVector(-vertex.Z, vertex.X, vertex.Y));
+			}
+		}
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(F_depth_intrinsics_round_trip_test, "ar_integration.depth_frame.intrinsics_round_trip",
+	EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool F_depth_intrinsics_round_trip_test::RunTest(const FString& Parameters)
+{
+	constexpr uint32_t width = 80;
+	constexpr uint32_t height = 60;
+	const pinhole_intrinsics intrinsics{ 60.f, 58.f, 39.5f, 29.5f };
+
+	/**
+	 * the corners have no ray like the vignetted pixels of the sensor
+	 */
+	const depth_unprojection device(width, height,
+		[&intrinsics](float (&uv)[2], float (&xy)[2])
+		{
+			const float u = uv[0] - intrinsics.cx;
+			const float v = uv[1] - intrinsics.cy;
+			return u * u + v * v < 38.f * 38.f && intrinsics(uv, xy);
+		}, 0.1f);
+
+	/**
+	 * what the server receives with the first raw frame
+	 */
+	generated::Depth_Intrinsics message;
+	convert_into(device, &message);
+
+	TestEqual(TEXT("width"), static_cast<int64>(message.width()), static_cast<int64>(width));
+	TestEqual(TEXT("height"), static_cast<int64>(message.height()), static_cast<int64>(height));
+
+	const depth_unprojection server(message.width(), message.height(),
+		std::vector<float>(message.ray_x().begin(), message.ray_x().end()),
+		std::vector<float>(message.ray_y().begin(), message.ray_y().end()),
+		std::vector<float>(message.ray_z().begin(), message.ray_z().end()));
+
+	TestTrue(TEXT("resolution"), server.matches(width, height));
+
+	/**
+	 * a raw frame with invalid pixels, the point cloud path
+	 * unprojects it on the device
+	 */
+	std::vector<uint16_t> depth(device.pixel_count());
+	std::vector<uint8_t> sigma(device.pixel_count());
+	for (size_t i = 0; i < depth.size(); ++i)
+	{
+		depth[i] = static_cast<uint16_t>(150 + (i * 53) % 4000);
+		sigma[i] = i % 11 == 0 ? 0x80 : 0;
+	}
+
+	point_buffer on_device;
+	on_device.set_num(static_cast<int32>(device.pixel_count()));
+	on_device.set_num(static_cast<int32>(device.unproject(depth.data(), sigma.data(),
+		on_device.x(), on_device.y(), on_device.z())));
+
+	TArray<FVector> on_server;
+	on_server.SetNumUninitialized(server.pixel_count());
+	on_server.SetNum(static_cast<int32>(server.unproject(depth.data(), sigma.data(), on_server.GetData())));
+
+	if (!TestEqual(TEXT("points"), static_cast<int64>(on_server.Num()), static_cast<int64>(on_device.Num())))
+		return false;
+
+	for (int32 i = 0; i < on_server.Num(); ++i)
+	{
+		if (on_server[i] != on_device.get(i))
+		{
+			AddError(FString::Printf(TEXT("point %d is %s on the server instead of %s"),
+				i, *on_server[i].ToString(), *on_device.get(i).ToString()));
+			return false;
+		}
+	}
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(F_depth_unprojection_rate_test, "ar_integration.depth_frame.unprojection_rate",
+	EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::PerfFilter)
+
+bool F_depth_unprojection_rate_test::RunTest(const FString& Parameters)
+{
+	constexpr int32 frame_count = 60;
+	constexpr int32 rounds = 10;
+
+	const FString path = FPaths::Combine(FPaths::AutomationTransientDir(), TEXT("depth_unprojection.drec"));
+	std::vector<int32> valid;
+	depth_replay replay;
+	if (!TestTrue(TEXT("recording replayed"), record_turning_headset(path, frame_count, valid) && replay.open(path)))
+		return false;
+
+	const depth_unprojection::unit_plane_mapping mapping = recorded_intrinsics;
+
+	/**
+	 * both paths on one thread over the same frames
+	 */
+	point_buffer points;
+	TArray<FVector> reference;
+	double table_seconds = 0.;
+	double per_pixel_seconds = 0.;
+	bool equal = true;
+	for (int32 round = 0; round < rounds; ++round)
+	{
+		for (size_t f = 0; f < replay.frame_count(); ++f)
+		{
+			double start = FPlatformTime::Seconds();
+			unproject_frame(replay, f, points);
+			table_seconds += FPlatformTime::Seconds() - start;
+
+			start = FPlatformTime::Seconds();
+			unproject_per_pixel(replay.frame(f), mapping, reference);
+			per_pixel_seconds += FPlatformTime::Seconds() - start;
+
+			if (round > 0)
+				continue;
+
+			equal &= points.Num() == reference.Num() && points.Num() == valid[f];
+			for (int32 i = 0; equal && i < points.Num(); ++i)
+				equal = points.get(i).Equals(reference[i], 1e-3 * reference[i].Size());
+		}
+	}
+
+	TestTrue(TEXT("same points as the per pixel path"), equal);
+
+	const double frames = static_cast<double>(rounds) * frame_count;
+	AddInfo(FString::Printf(TEXT("%ux%u frames on one thread: ray table %.0f frames/s, per pixel normalize %.0f frames/s, %.1fx"),
+		recorded_width, recorded_height, frames / table_seconds, frames / per_pixel_seconds, per_pixel_seconds / table_seconds));
+
+	return true;
+}
+
+#endif
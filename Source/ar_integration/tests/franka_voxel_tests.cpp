@@ -0,0 +1,142 @@
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+#include "franka_voxel.h"
+#include "test_world.h"
+#include "voxel_mesher.h"
+
+namespace
+{
+	/**
+	 * voxels of a box of extent voxels per axis at offset,
+	 * like the swept volume of a resting robot link
+	 */
+	F_voxel_data box(const FIntVector& offset, const FIntVector& extent)
+	{
+		F_voxel_data data;
+		data.voxel_side_length = 1.f;
+		data.indices.Reserve(extent.X * extent.Y * extent.Z);
+		for (int32 z = 0; z < extent.Z; ++z)
+			for (int32 y = 0; y < extent.Y; ++y)
+				for (int32 x = 0; x < extent.X; ++x)
+					data.indices.Emplace(offset.X + x, offset.Y + y, offset.Z + z);
+		return data;
+	}
+
+	TArray<FIntVector> to_voxels(const F_voxel_data& data)
+	{
+		TArray<FIntVector> voxels;
+		voxels.Reserve(data.indices.Num());
+		for (const FVector& p : data.indices)
+			voxels.Emplace(FMath::RoundToInt32(p.X), FMath::RoundToInt32(p.Y), FMath::RoundToInt32(p.Z));
+		return voxels;
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(F_voxel_mesher_test, "ar_integration.franka_voxel.surface",
+	EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::PerfFilter)
+
+bool F_voxel_mesher_test::RunTest(const FString& Parameters)
+{
+	voxel_mesher mesher;
+	voxel_surface surface;
+
+	/**
+	 * a box of any size is closed by one rectangle per side
+	 */
+	for (const FIntVector& extent : { FIntVector(1), FIntVector(2), FIntVector(7, 3, 5) })
+	{
+		TestTrue(TEXT("box built"), mesher.build(to_voxels(box(FIntVector(-3), extent)), 1.f, surface));
+		TestEqual(TEXT("box triangles"), surface.triangles.Num() / 3, 12);
+		TestEqual(TEXT("normal per vertex"), surface.normals.Num(), surface.vertices.Num());
+	}
+
+	/**
+	 * a checkerboard cannot merge any face, the worst case
+	 */
+	TArray<FIntVector> checkerboard;
+	for (int32 z = 0; z < 32; ++z)
+		for (int32 y = 0; y < 32; ++y)
+			for (int32 x = 0; x < 32; ++x)
+				if ((x + y + z) % 2 == 0)
+					checkerboard.Emplace(x, y, z);
+
+	const TArray<TPair<const TCHAR*, TArray<FIntVector>>> volumes = {
+		{ TEXT("box 64^3"), to_voxels(box(FIntVector(0), FIntVector(64))) },
+		{ TEXT("slab 256x256x4"), to_voxels(box(FIntVector(0), FIntVector(256, 256, 4))) },
+		{ TEXT("checkerboard 32^3"), checkerboard }
+	};
+
+	for (const auto& [name, voxels] : volumes)
+	{
+		const double start = FPlatformTime::Seconds();
+		TestTrue(TEXT("volume built"), mesher.build(voxels, 1.f, surface));
+		const double ms = 1e3 * (FPlatformTime::Seconds() - start);
+
+		AddInfo(FString::Printf(TEXT("%s: %d voxels, surface %d triangles in %.2f ms, instanced %d triangles"),
+			name, voxels.Num(), surface.triangles.Num() / 3, ms, 12 * voxels.Num()));
+		TestTrue(TEXT("surface not larger than instances"), surface.triangles.Num() / 3 <= 12 * voxels.Num());
+	}
+
+	/**
+	 * the instanced build time for comparison
+	 */
+	test_world world;
+	A_franka_voxel* actor = world.spawn<A_franka_voxel>();
+	if (!TestNotNull(TEXT("franka voxel actor"), actor))
+		return false;
+
+	actor->set_voxels(box(FIntVector(0), FIntVector(64)));
+	const F_voxel_mesh_metrics metrics = actor->get_mesh_metrics();
+	AddInfo(FString::Printf(TEXT("box 64^3 instanced: %lld triangles in %.2f ms"), metrics.triangles, metrics.build_ms));
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(F_franka_voxel_instances_test, "ar_integration.franka_voxel.instances",
+	EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::PerfFilter)
+
+bool F_franka_voxel_instances_test::RunTest(const FString& Parameters)
+{
+	test_world world;
+	A_franka_voxel* actor = world.spawn<A_franka_voxel>();
+	if (!TestNotNull(TEXT("franka voxel actor"), actor))
+		return false;
+
+	/**
+	 * recorded stream of a link sweeping one voxel per frame
+	 * along x, growing along y every tenth frame
+	 */
+	const FIntVector extent(20, 20, 20);
+	int64 operations = 0;
+	int64 changed = 0;
+	double ms = 0.;
+
+	TSet<FIntVector> previous;
+	for (int32 frame = 0; frame < 100; ++frame)
+	{
+		const F_voxel_data data = box(FIntVector(frame, 0, 0), extent + FIntVector(0, frame / 10, 0));
+		actor->set_voxels(data);
+
+		const F_voxel_mesh_metrics metrics = actor->get_mesh_metrics();
+		TestEqual(TEXT("instances"), metrics.voxels, int64(data.indices.Num()));
+
+		TSet<FIntVector> current(to_voxels(data));
+		if (frame > 0)
+		{
+			changed += current.Difference(previous).Num() + previous.Difference(current).Num();
+			operations += metrics.instances_added + metrics.instances_removed + metrics.instances_moved;
+			ms += metrics.build_ms;
+		}
+		previous = MoveTemp(current);
+	}
+
+	AddInfo(FString::Printf(TEXT("%lld instance operations for %lld changed voxels in %.2f ms"),
+		operations, changed, ms));
+	TestTrue(TEXT("no more operations than changed voxels"), operations <= changed);
+
+	return true;
+}
+
+#endif
@@ -0,0 +1,125 @@
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+#include "Async/TaskGraphInterfaces.h"
+#include "Misc/ScopeExit.h"
+
+#include "grpc_channel.h"
+#include "state_change_probe.h"
+
+#include "grpc_include_begin.h"
+#include "grpcpp/server_builder.h"
+#include "depth_image.grpc.pb.h"
+#include "grpc_include_end.h"
+
+namespace
+{
+	/**
+	 * runs the tasks posted to the game thread, e.g. the broadcasts
+	 * of the watcher, until condition holds or timeout passed
+	 */
+	template<typename F>
+	bool pump_until(F&& condition, double timeout)
+	{
+		const double start = FPlatformTime::Seconds();
+		while (!condition())
+		{
+			if (FPlatformTime::Seconds() - start > timeout)
+				return false;
+
+			FTaskGraphInterface::Get().ProcessThreadUntilIdle(ENamedThreads::GameThread);
+			FPlatformProcess::Sleep(0.0002f);
+		}
+		return true;
+	}
+
+	/**
+	 * runs the tasks posted to the game thread for seconds
+	 */
+	void pump_for(double seconds)
+	{
+		const double start = FPlatformTime::Seconds();
+		while (FPlatformTime::Seconds() - start < seconds)
+		{
+			FTaskGraphInterface::Get().ProcessThreadUntilIdle(ENamedThreads::GameThread);
+			FPlatformProcess::Sleep(0.001f);
+		}
+	}
+
+	/**
+	 * cpu usage of the process in percent while idling for seconds
+	 */
+	float idle_cpu(float seconds)
+	{
+		FPlatformTime::UpdateCPUTime(0.f);
+		FPlatformProcess::Sleep(seconds);
+		FPlatformTime::UpdateCPUTime(seconds);
+		return FPlatformTime::GetCPUTime().CPUTimePct;
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(F_grpc_channel_watcher_test, "ar_integration.grpc_channel.watcher",
+	EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::PerfFilter)
+
+bool F_grpc_channel_watcher_test::RunTest(const FString& Parameters)
+{
+	generated::pcl_com::Service service;
+	int port = 0;
+	grpc::ServerBuilder builder;
+	builder.AddListeningPort("127.0.0.1:0", grpc::InsecureServerCredentials(), &port);
+	builder.RegisterService(&service);
+	std::unique_ptr<grpc::Server> server = builder.BuildAndStart();
+	if (!TestTrue(TEXT("server started"), server && port > 0))
+		return false;
+
+	/**
+	 * the process without a channel is the baseline
+	 */
+	const float baseline = idle_cpu(2.f);
+
+	U_grpc_channel* channel = NewObject<U_grpc_channel>();
+	U_state_change_probe* probe = NewObject<U_state_change_probe>();
+	channel->AddToRoot();
+	probe->AddToRoot();
+	ON_SCOPE_EXIT
+	{
+		channel->RemoveFromRoot();
+		probe->RemoveFromRoot();
+	};
+
+	if (!TestTrue(TEXT("connected"), channel->construct(FString::Printf(TEXT("ipv4:127.0.0.1:%d"), port), 2000)))
+		return false;
+
+	channel->on_class_state_change(traffic_class::BULK).AddDynamic(probe, &U_state_change_probe::on_state_change);
+
+	TestTrue(TEXT("all classes ready"), pump_until([channel]()
+		{
+			for (const auto type : { traffic_class::CONTROL, traffic_class::REALTIME, traffic_class::BULK })
+				if (channel->get_class_state(type) != connection_state::READY)
+					return false;
+			return true;
+		}, 5.));
+	pump_for(0.5);
+
+	/**
+	 * no state changes while connected, the watcher
+	 * sleeps without deadline
+	 */
+	const float watched = idle_cpu(2.f);
+	AddInfo(FString::Printf(TEXT("idle cpu: %.2f %% without channel, %.2f %% with watched channels"), baseline, watched));
+
+	probe->changes = 0;
+	const double shutdown = FPlatformTime::Seconds();
+	server->Shutdown();
+
+	if (!TestTrue(TEXT("state change reported"), pump_until([probe]() { return probe->changes > 0; }, 5.)))
+		return false;
+
+	AddInfo(FString::Printf(TEXT("server shutdown reported after %.2f ms"), 1e3 * (probe->last_change - shutdown)));
+	TestTrue(TEXT("not ready after shutdown"), probe->last_state != connection_state::READY);
+
+	return true;
+}
+
+#endif
@@ -0,0 +1,119 @@
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+#include "util.h"
+
+#include <limits>
+
+namespace
+{
+	/**
+	 * a frame where every pixel_gap-th point has no depth
+	 */
+	TArray<FVector> frame_with_gaps(int32 count, int32 pixel_gap)
+	{
+		TArray<FVector> points;
+		points.Reserve(count);
+		for (int32 i = 0; i < count; ++i)
+		{
+			if (i % pixel_gap == 0)
+				points.Emplace(std::numeric_limits<double>::quiet_NaN(), i, 0.);
+			else
+				points.Emplace(i * 0.001, i % 512, i / 512);
+		}
+		return points;
+	}
+
+	/**
+	 * the filter before append_finite, indices of finite points collected in a set
+	 */
+	google::protobuf::RepeatedPtrField<generated::vertex_3d> set_filter(const TArray<FVector>& in)
+	{
+		google::protobuf::RepeatedPtrField<generated::vertex_3d> out;
+
+		TSet<size_t> not_nan;
+		for (size_t i = 0; i < in.Num(); ++i)
+		{
+			if (!in[i].ContainsNaN())
+				not_nan.Add(i);
+		}
+		out.Reserve(not_nan.Num());
+
+		for (const auto& index : not_nan)
+			out.Add(convert<generated::vertex_3d, FVector>(in[index]));
+
+		return out;
+	}
+
+	template<typename F>
+	double milliseconds_per_frame(int32 repetitions, F&& filter)
+	{
+		const double start = FPlatformTime::Seconds();
+		for (int32 i = 0; i < repetitions; ++i)
+			filter();
+		return (FPlatformTime::Seconds() - start) * 1000. / repetitions;
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(F_nan_filter_test, "ar_integration.util.append_finite",
+	EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::PerfFilter)
+
+bool F_nan_filter_test::RunTest(const FString& Parameters)
+{
+	const FVector inf(std::numeric_limits<double>::infinity(), 0., 0.);
+	TestFalse(TEXT("infinity"), is_finite(inf));
+	TestFalse(TEXT("nan"), is_finite(FVector(0., 0., std::numeric_limits<double>::quiet_NaN())));
+	TestTrue(TEXT("finite"), is_finite(FVector(1., -2., 3.)));
+
+	/**
+	 * long throw and articulated hand tracking frames of the HoloLens 2
+	 */
+	const std::pair<const TCHAR*, int32> frames[] = {
+		{ TEXT("320x288"), 320 * 288 },
+		{ TEXT("512x512"), 512 * 512 }
+	};
+
+	for (const auto& [name, count] : frames)
+	{
+		const TArray<FVector> points = frame_with_gaps(count, 3);
+
+		google::protobuf::RepeatedPtrField<generated::vertex_3d> filtered;
+		append_finite(points, &filtered);
+
+		const auto reference = set_filter(points);
+		if (!TestEqual(TEXT("finite points"), filtered.size(), reference.size()))
+			continue;
+
+		int32 previous = -1;
+		bool ordered = true;
+		for (const auto& vertex : filtered)
+		{
+			const int32 index = FMath::RoundToInt32(vertex.x() * 1000.);
+			ordered &= index > previous;
+			previous = index;
+		}
+		TestTrue(TEXT("order kept"), ordered);
+
+		const std::vector<generated::vertex_3d> as_vector = convert_std_array<generated::vertex_3d, true>(points);
+		TestEqual(TEXT("std::vector variant"), static_cast<int32>(as_vector.size()), filtered.size());
+
+		const double single_pass = milliseconds_per_frame(20, [&]()
+			{
+				google::protobuf::RepeatedPtrField<generated::vertex_3d> out;
+				append_finite(points, &out);
+			});
+
+		const double set_based = milliseconds_per_frame(20, [&]()
+			{
+				set_filter(points);
+			});
+
+		AddInfo(FString::Printf(TEXT("%s, %d finite: append_finite %.2f ms, set based %.2f ms per frame"),
+			name, filtered.size(), single_pass, set_based));
+	}
+
+	return true;
+}
+
+#endif
@@ -0,0 +1,134 @@
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+#include "Misc/Paths.h"
+
+#include "pcl_codec.h"
+#include "point_cloud_filter.h"
+#include "recorded_frames.h"
+#include "util.h"
+
+namespace
+{
+	constexpr int32 frame_count = 30;
+
+	/**
+	 * maximum error per axis in cm, the default of A_pcl_client
+	 */
+	constexpr float precision = 0.1f;
+
+	struct codec_result
+	{
+		int64 bytes = 0;
+		double encode_seconds = 0.;
+		double decode_seconds = 0.;
+		double max_error = 0.;
+		bool decoded = true;
+	};
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(F_pcl_codec_test, "ar_integration.pcl_codec.replay",
+	EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::PerfFilter)
+
+bool F_pcl_codec_test::RunTest(const FString& Parameters)
+{
+	const FString path = FPaths::Combine(FPaths::AutomationTransientDir(), TEXT("pcl_codec.drec"));
+	std::vector<int32> expected;
+	depth_replay replay;
+	if (!TestTrue(TEXT("recording replayed"), record_turning_headset(path, frame_count, expected) && replay.open(path)))
+		return false;
+
+	const std::pair<const TCHAR*, generated::Pcl_Codec> codecs[] = {
+		{ TEXT("draco kd tree"), generated::DRACO_KD_TREE },
+		{ TEXT("quantized zstd"), generated::QUANTIZED_ZSTD }
+	};
+	codec_result results[UE_ARRAY_COUNT(codecs)];
+
+	int64 raw_bytes = 0;
+	int64 points = 0;
+
+	F_point_cloud pcl;
+	for (size_t f = 0; f < replay.frame_count(); ++f)
+	{
+		/**
+		 * the world space points A_pcl_client encodes
+		 */
+		const FTransform world = unproject_frame(replay, f, pcl.points);
+		pcl.points.set_num(point_cloud_crop(world, nullptr).apply(pcl.points));
+		pcl.abs_timestamp = replay.frame(f).abs_timestamp;
+		points += pcl.points.Num();
+
+		generated::Pcl_Data uncompressed;
+		convert_into(pcl, &uncompressed);
+		raw_bytes += uncompressed.ByteSizeLong();
+
+		for (size_t c = 0; c < UE_ARRAY_COUNT(codecs); ++c)
+		{
+			codec_result& result = results[c];
+			const std::unique_ptr<pcl_codec> codec = pcl_codec::create(codecs[c].second, precision);
+
+			generated::Draco_Data encoded;
+			double start = FPlatformTime::Seconds();
+			result.decoded &= codec->encode(pcl.points, encoded);
+			result.encode_seconds += FPlatformTime::Seconds() - start;
+			result.bytes += encoded.ByteSizeLong();
+
+			TArray<FVector> decoded;
+			start = FPlatformTime::Seconds();
+			result.decoded &= codec->decode(encoded, decoded);
+			result.decode_seconds += FPlatformTime::Seconds() - start;
+
+			if (decoded.Num() != pcl.points.Num())
+			{
+				result.decoded = false;
+				continue;
+			}
+
+			/**
+			 * draco reorders the points, compare the bounds only
+			 */
+			if (codecs[c].second == generated::DRACO_KD_TREE)
+			{
+				FBox original(ForceInit);
+				FBox restored(ForceInit);
+				for (int32 i = 0; i < decoded.Num(); ++i)
+				{
+					original += pcl.points.get(i);
+					restored += decoded[i];
+				}
+				result.max_error = FMath::Max(result.max_error, FMath::Max(
+					(original.Min - restored.Min).GetAbsMax(), (original.Max - restored.Max).GetAbsMax()));
+			}
+			else
+			{
+				for (int32 i = 0; i < decoded.Num(); ++i)
+					result.max_error = FMath::Max(result.max_error, (pcl.points.get(i) - decoded[i]).GetAbsMax());
+			}
+		}
+	}
+
+	const double frames = static_cast<double>(replay.frame_count());
+	AddInfo(FString::Printf(TEXT("%d frames, %.0f points and %.0f uncompressed bytes per frame"),
+		static_cast<int32>(frames), points / frames, raw_bytes / frames));
+
+	for (size_t c = 0; c < UE_ARRAY_COUNT(codecs); ++c)
+	{
+		const codec_result& result = results[c];
+		AddInfo(FString::Printf(TEXT("%s: %.0f bytes (%.1f %%), encode %.2f ms, decode %.2f ms per frame, max error %.3f cm"),
+			codecs[c].first, result.bytes / frames, 100. * result.bytes / raw_bytes,
+			result.encode_seconds * 1e3 / frames, result.decode_seconds * 1e3 / frames, result.max_error));
+
+		TestTrue(FString::Printf(TEXT("%s decoded"), codecs[c].first), result.decoded);
+
+		/**
+		 * float coordinates add rounding on top of the quantization
+		 */
+		TestTrue(FString::Printf(TEXT("%s within precision"), codecs[c].first), result.max_error <= precision * 1.01 + 1e-3);
+		TestTrue(FString::Printf(TEXT("%s compresses"), codecs[c].first), result.bytes < raw_bytes);
+	}
+
+	return true;
+}
+
+#endif
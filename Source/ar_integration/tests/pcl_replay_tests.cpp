@@ -0,0 +1,151 @@
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+#include "Misc/Paths.h"
+#include "Misc/ScopeExit.h"
+
+#include "pcl_client.h"
+#include "recorded_frames.h"
+#include "test_world.h"
+
+#include "grpc_include_begin.h"
+#include "grpcpp/server_builder.h"
+#include "grpc_include_end.h"
+
+#include <thread>
+
+namespace
+{
+	constexpr int32 frame_count = 60;
+
+	/**
+	 * server side of the point cloud stream, counts the points per frame
+	 */
+	class pcl_service final : public generated::pcl_com::Service
+	{
+	public:
+
+		grpc::Status transmit_pcl_data(grpc::ServerContext*,
+			grpc::ServerReader<generated::Pcl_Data_Meta>* reader, generated::ICP_Result*) override
+		{
+			generated::Pcl_Data_Meta message;
+			while (reader->Read(&message))
+			{
+				std::unique_lock lock(mtx);
+				received.emplace_back(message.pcl_data().timestamp(), message.pcl_data().vertices_size());
+			}
+			return grpc::Status::OK;
+		}
+
+		std::vector<std::pair<int64, int32>> frames() const
+		{
+			std::unique_lock lock(mtx);
+			return received;
+		}
+
+	private:
+
+		mutable std::mutex mtx;
+		std::vector<std::pair<int64, int32>> received;
+	};
+}
+
+/**
+ * runs without a headset, e.g. with -nullrhi, but only on Win64,
+ * ar_integration needs the Grpc and UXTools plugins which
+ * support no other desktop platform
+ */
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(F_pcl_replay_test, "ar_integration.pcl_client.replay",
+	EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::PerfFilter)
+
+bool F_pcl_replay_test::RunTest(const FString& Parameters)
+{
+	const FString path = FPaths::Combine(FPaths::AutomationTransientDir(), TEXT("pcl_replay.drec"));
+
+	std::vector<int32> expected;
+	if (!TestTrue(TEXT("recording written"), record_turning_headset(path, frame_count, expected)))
+		return false;
+
+	pcl_service service;
+	int port = 0;
+	grpc::ServerBuilder builder;
+	builder.AddListeningPort("127.0.0.1:0", grpc::InsecureServerCredentials(), &port);
+	builder.RegisterService(&service);
+	const std::unique_ptr<grpc::Server> server = builder.BuildAndStart();
+	if (!TestTrue(TEXT("server started"), server && port > 0))
+		return false;
+
+	U_grpc_channel* channel = NewObject<U_grpc_channel>();
+	channel->AddToRoot();
+	ON_SCOPE_EXIT{ channel->RemoveFromRoot(); };
+
+	if (!TestTrue(TEXT("connected"), channel->construct(FString::Printf(TEXT("ipv4:127.0.0.1:%d"), port), 2000)))
+		return false;
+
+	/**
+	 * the client runs without ar session on the replaying camera
+	 */
+	test_world world;
+	A_camera* camera = world.spawn<A_camera>();
+	A_pcl_client* client = world.spawn<A_pcl_client>();
+	if (!TestNotNull(TEXT("camera"), camera) || !TestNotNull(TEXT("client"), client))
+		return false;
+
+	client->visualize = false;
+	I_Base_Client_Interface::Execute_set_channel(client, channel);
+	client->set_camera(camera);
+	client->Tick(0.f);
+
+	if (!TestTrue(TEXT("client ready"), client->get_state() == state::READY))
+		return false;
+
+	/**
+	 * frames are delivered as fast as they are consumed
+	 */
+	if (!TestTrue(TEXT("replay started"), camera->start_replay(path, 0.f, false)))
+		return false;
+
+	const double start = FPlatformTime::Seconds();
+	while (!camera->get_unprojection() && FPlatformTime::Seconds() - start < 5.)
+		FPlatformProcess::Sleep(0.001f);
+
+	const double sent = FPlatformTime::Seconds();
+	std::thread transmission(&A_pcl_client::toggle, client, true);
+	while (service.frames().size() < static_cast<size_t>(frame_count) && FPlatformTime::Seconds() - sent < 30.)
+		FPlatformProcess::Sleep(0.001f);
+	const double seconds = FPlatformTime::Seconds() - sent;
+
+	client->toggle(false);
+	transmission.join();
+	camera->stop_replay();
+	server->Shutdown();
+
+	const auto frames = service.frames();
+	int64 points = 0;
+	for (const auto& frame : frames)
+		points += frame.second;
+
+	AddInfo(FString::Printf(TEXT("%d frames, %lld points in %.2f s: %.1f frames/s, %.2f M points/s"),
+		static_cast<int32>(frames.size()), points, seconds, frames.size() / seconds, 1e-6 * points / seconds));
+	for (const F_pcl_stage_metrics& stage : client->get_pipeline_metrics())
+		AddInfo(FString::Printf(TEXT("%s: %lld processed, %.2f ms mean, %.2f ms max"),
+			*stage.stage, stage.processed, stage.mean_latency_ms, stage.max_latency_ms));
+
+	/**
+	 * the replay is lossless and sent by a single worker,
+	 * so the server sees every frame once in recorded order
+	 */
+	if (!TestEqual(TEXT("frames"), static_cast<int32>(frames.size()), frame_count))
+		return false;
+
+	for (int32 f = 0; f < frame_count; ++f)
+	{
+		TestEqual(TEXT("timestamp"), frames[f].first, int64(f + 1) * 450000);
+		TestEqual(TEXT("points"), frames[f].second, expected[f]);
+	}
+
+	return true;
+}
+
+#endif
@@ -0,0 +1,195 @@
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+#include "Misc/Paths.h"
+#include "Kismet/KismetMathLibrary.h"
+
+#include "point_cloud_filter.h"
+#include "recorded_frames.h"
+
+namespace
+{
+	constexpr int32 frame_count = 60;
+
+	/**
+	 * replays the frames of a fresh recording
+	 */
+	bool open_recording(const FString& name, depth_replay& replay)
+	{
+		const FString path = FPaths::Combine(FPaths::AutomationTransientDir(), name);
+		std::vector<int32> points;
+		return record_turning_headset(path, frame_count, points) && replay.open(path);
+	}
+
+	/**
+	 * crops point by point like A_pcl_client did before point_cloud_crop
+	 * @returns number of points kept at the front of points
+	 */
+	int32 crop_per_point(const FTransform& world, const F_obb& obb, TArray<FVector>& points)
+	{
+		int32 kept = 0;
+		for (const FVector& p : points)
+		{
+			const FVector in_world = world.TransformPosition(p);
+			if (UKismetMathLibrary::IsPointInBoxWithTransform(in_world,
+				FTransform(obb.rotation, obb.axis_box.GetCenter()), obb.axis_box.GetExtent()))
+				points[kept++] = in_world;
+		}
+		return kept;
+	}
+
+	/**
+	 * centroids of the occupied cells in order of their first point
+	 * a TMap keeps the order of insertion
+	 */
+	TArray<FVector> centroids(const point_buffer& points, double leaf_size)
+	{
+		TMap<FIntVector, TPair<FVector, int32>> cells;
+		for (int32 i = 0; i < points.Num(); ++i)
+		{
+			const FVector p = points.get(i);
+			const FIntVector index(
+				FMath::FloorToInt32(p.X / leaf_size),
+				FMath::FloorToInt32(p.Y / leaf_size),
+				FMath::FloorToInt32(p.Z / leaf_size));
+
+			TPair<FVector, int32>& c = cells.FindOrAdd(index, { FVector::ZeroVector, 0 });
+			c.Key += p;
+			++c.Value;
+		}
+
+		TArray<FVector> out;
+		out.Reserve(cells.Num());
+		for (const auto& [index, c] : cells)
+			out.Add(c.Key / c.Value);
+		return out;
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(F_point_cloud_crop_test, "ar_integration.point_cloud_filter.crop",
+	EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::PerfFilter)
+
+bool F_point_cloud_crop_test::RunTest(const FString& Parameters)
+{
+	depth_replay replay;
+	if (!TestTrue(TEXT("recording replayed"), open_recording(TEXT("point_cloud_crop.drec"), replay)))
+		return false;
+
+	/**
+	 * a turned box over the center of the first frame
+	 */
+	point_buffer points;
+	const FTransform first = unproject_frame(replay, 0, points);
+	FBox bounds(ForceInit);
+	for (int32 i = 0; i < points.Num(); ++i)
+		bounds += first.TransformPosition(points.get(i));
+
+	F_obb obb;
+	obb.axis_box = FBox::BuildAABB(bounds.GetCenter(), bounds.GetExtent() * 0.5);
+	obb.rotation = FQuat(FVector::UpVector, FMath::DegreesToRadians(30.));
+
+	double blocked_seconds = 0.;
+	double per_point_seconds = 0.;
+	int64 points_in = 0;
+	int64 points_kept = 0;
+	bool equal = true;
+
+	for (size_t f = 0; f < replay.frame_count(); ++f)
+	{
+		const FTransform world = unproject_frame(replay, f, points);
+		TArray<FVector> reference = points.to_array();
+		points_in += points.Num();
+
+		double start = FPlatformTime::Seconds();
+		const point_cloud_crop crop(world, &obb);
+		points.set_num(crop.apply(points));
+		blocked_seconds += FPlatformTime::Seconds() - start;
+
+		start = FPlatformTime::Seconds();
+		reference.SetNum(crop_per_point(world, obb, reference));
+		per_point_seconds += FPlatformTime::Seconds() - start;
+
+		points_kept += points.Num();
+
+		/**
+		 * float points may fall on the other side of a face
+		 */
+		equal &= FMath::Abs(points.Num() - reference.Num()) <= reference.Num() / 1000 + 1;
+	}
+
+	TestTrue(TEXT("same points kept"), equal);
+	TestTrue(TEXT("box crops"), points_kept > 0 && points_kept < points_in);
+
+	const double frames = static_cast<double>(replay.frame_count());
+	AddInfo(FString::Printf(TEXT("%d frames, %.0f of %.0f points kept per frame: point_cloud_crop %.1f us, per point %.1f us per frame"),
+		static_cast<int32>(frames), points_kept / frames, points_in / frames,
+		blocked_seconds * 1e6 / frames, per_point_seconds * 1e6 / frames));
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(F_voxel_grid_filter_test, "ar_integration.point_cloud_filter.voxel_grid",
+	EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::PerfFilter)
+
+bool F_voxel_grid_filter_test::RunTest(const FString& Parameters)
+{
+	depth_replay replay;
+	if (!TestTrue(TEXT("recording replayed"), open_recording(TEXT("voxel_grid_filter.drec"), replay)))
+		return false;
+
+	/**
+	 * world space frames as the filter gets them after the crop
+	 */
+	std::vector<point_buffer> frames(replay.frame_count());
+	for (size_t f = 0; f < frames.size(); ++f)
+	{
+		const FTransform world = unproject_frame(replay, f, frames[f]);
+		frames[f].set_num(point_cloud_crop(world, nullptr).apply(frames[f]));
+	}
+
+	for (const double leaf_size : { 0.5, 1., 2., 5. })
+	{
+		voxel_grid_filter filter(recorded_width * recorded_height);
+		double filter_seconds = 0.;
+		double map_seconds = 0.;
+		int64 points_in = 0;
+		int64 points_out = 0;
+		bool equal = true;
+
+		point_buffer points;
+		for (const point_buffer& frame : frames)
+		{
+			points = frame;
+			points_in += points.Num();
+
+			double start = FPlatformTime::Seconds();
+			points.set_num(filter.apply(points, leaf_size));
+			filter_seconds += FPlatformTime::Seconds() - start;
+			points_out += points.Num();
+
+			start = FPlatformTime::Seconds();
+			const TArray<FVector> reference = centroids(frame, leaf_size);
+			map_seconds += FPlatformTime::Seconds() - start;
+
+			if (reference.Num() != points.Num())
+			{
+				equal = false;
+				continue;
+			}
+
+			for (int32 i = 0; i < points.Num(); ++i)
+				equal &= points.get(i).Equals(reference[i], 1e-2);
+		}
+
+		TestTrue(FString::Printf(TEXT("centroids of %.1f cm cells"), leaf_size), equal);
+
+		const double count = static_cast<double>(frames.size());
+		AddInfo(FString::Printf(TEXT("%.1f cm cells: %.0f points in, %.0f out per frame, voxel_grid_filter %.1f us, TMap %.1f us per frame"),
+			leaf_size, points_in / count, points_out / count, filter_seconds * 1e6 / count, map_seconds * 1e6 / count));
+	}
+
+	return true;
+}
+
+#endif
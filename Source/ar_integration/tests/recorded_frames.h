@@ -0,0 +1,81 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+#include "depth_recording.h"
+#include "point_buffer.h"
+
+#include <memory>
+#include <vector>
+
+/**
+ * long throw resolution of the recorded frames
+ */
+constexpr uint32 recorded_width = 320;
+constexpr uint32 recorded_height = 288;
+
+inline const pinhole_intrinsics recorded_intrinsics{ 200.f, 200.f, 159.5f, 143.5f };
+
+/**
+ * records a headset turning in front of a slanted wall
+ * at the long throw resolution and frame rate
+ * @param points valid pixels of every frame
+ */
+inline bool record_turning_headset(const FString& path, int32 frame_count, std::vector<int32>& points)
+{
+	const auto rays = std::make_shared<const depth_unprojection>(recorded_width, recorded_height,
+		recorded_intrinsics, 0.1f);
+
+	depth_recorder recorder;
+	if (!recorder.open(path))
+		return false;
+
+	std::vector<uint16> depth(rays->pixel_count());
+	std::vector<uint8> sigma(rays->pixel_count());
+	for (int32 f = 0; f < frame_count; ++f)
+	{
+		int32 valid = 0;
+		for (uint32 row = 0, i = 0; row < recorded_height; ++row)
+		{
+			for (uint32 column = 0; column < recorded_width; ++column, ++i)
+			{
+				depth[i] = static_cast<uint16>(800 + 2 * column + 5 * f);
+				sigma[i] = (column + row + f) % 13 == 0 ? 0x80 : 0;
+				valid += !(sigma[i] & 0x80);
+			}
+		}
+		points.push_back(valid);
+
+		depth_frame_view frame;
+		frame.depth = depth.data();
+		frame.sigma = sigma.data();
+		frame.width = recorded_width;
+		frame.height = recorded_height;
+		frame.location = FTransform(FRotator(0., f, 0.), FVector(0., 0., 150.));
+		frame.abs_timestamp = (f + 1) * 450000;
+
+		if (!recorder.write(frame, rays, FTransform::Identity))
+			return false;
+	}
+
+	recorder.close();
+	return true;
+}
+
+/**
+ * unprojects a replayed frame into camera space like A_camera does
+ * @returns transformation of the points into world space
+ */
+inline FTransform unproject_frame(const depth_replay& replay, size_t index, point_buffer& out)
+{
+	const depth_frame_view frame = replay.frame(index);
+	const auto& rays = replay.rays(index);
+
+	out.set_num(static_cast<int32>(rays->pixel_count()));
+	out.set_num(static_cast<int32>(rays->unproject(frame.depth, frame.sigma, out.x(), out.y(), out.z())));
+
+	FTransform world;
+	const FTransform camera_view = replay.camera_view(index);
+	FTransform::Multiply(&world, &camera_view, &frame.location);
+	return world;
+}
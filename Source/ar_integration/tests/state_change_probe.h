@@ -0,0 +1,32 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/Object.h"
+
+#include "grpc_channel.h"
+
+#include "state_change_probe.generated.h"
+
+/**
+ * @class U_state_change_probe
+ * records the state changes of a @ref{U_grpc_channel}
+ * it is bound to, used by the automation tests
+ */
+UCLASS()
+class U_state_change_probe : public UObject
+{
+	GENERATED_BODY()
+public:
+
+	UFUNCTION()
+	void on_state_change(connection_state old_state, connection_state new_state)
+	{
+		last_state = new_state;
+		last_change = FPlatformTime::Seconds();
+		++changes;
+	}
+
+	connection_state last_state = connection_state::NO_CHANNEL;
+	double last_change = 0.;
+	int32 changes = 0;
+};
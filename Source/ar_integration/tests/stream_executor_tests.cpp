@@ -0,0 +1,220 @@
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+#include "stream_executor.h"
+#include "test_services.h"
+
+#include "grpc_include_begin.h"
+#include "grpcpp/create_channel.h"
+#include "grpc_include_end.h"
+
+#if PLATFORM_WINDOWS
+#include "Windows/AllowWindowsPlatformTypes.h"
+#include <TlHelp32.h>
+#include "Windows/HideWindowsPlatformTypes.h"
+#endif
+
+#include <atomic>
+#include <cstdlib>
+#include <fstream>
+#include <string>
+#include <thread>
+
+namespace
+{
+	constexpr int32 stream_count = 8;
+	constexpr double run_seconds = 2.;
+
+	struct process_counters
+	{
+		int64 threads = -1;
+		int64 context_switches = -1;
+		int64 cycles = -1;
+	};
+
+#if PLATFORM_WINDOWS
+	/**
+	 * threads from a toolhelp snapshot and the cpu cycles of the process,
+	 * windows exposes no context switch counter to applications
+	 */
+	process_counters read_counters()
+	{
+		process_counters out;
+		const HANDLE snapshot = CreateToolhelp32Snapshot(TH32CS_SNAPTHREAD, 0);
+		if (snapshot == INVALID_HANDLE_VALUE)
+			return out;
+
+		const DWORD process = GetCurrentProcessId();
+		THREADENTRY32 entry;
+		entry.dwSize = sizeof(entry);
+
+		out.threads = 0;
+		for (BOOL more = Thread32First(snapshot, &entry); more; more = Thread32Next(snapshot, &entry))
+			if (entry.th32OwnerProcessID == process)
+				++out.threads;
+		CloseHandle(snapshot);
+
+		/**
+		 * includes the cycles of threads which already exited
+		 * unlike summing QueryThreadCycleTime over the snapshot
+		 */
+		ULONG64 cycles = 0;
+		if (QueryProcessCycleTime(GetCurrentProcess(), &cycles))
+			out.cycles = static_cast<int64>(cycles);
+		return out;
+	}
+#else
+	/**
+	 * threads and voluntary plus involuntary context switches
+	 * of the process, -1 if the platform has no /proc
+	 */
+	process_counters read_counters()
+	{
+		process_counters out;
+		std::ifstream status("/proc/self/status");
+		if (!status)
+			return out;
+
+		out.context_switches = 0;
+		std::string line;
+		while (std::getline(status, line))
+		{
+			const size_t colon = line.find(':');
+			if (colon == std::string::npos)
+				continue;
+
+			const std::string key = line.substr(0, colon);
+			const int64 value = std::atoll(line.c_str() + colon + 1);
+			if (key == "Threads")
+				out.threads = value;
+			else if (key.ends_with("ctxt_switches"))
+				out.context_switches += value;
+		}
+		return out;
+	}
+#endif
+
+	struct stream_run
+	{
+		int64 added_threads = 0;
+		double switches_per_second = -1.;
+		double cycles_per_second = -1.;
+		std::atomic_int64_t messages = 0;
+	};
+
+	/**
+	 * samples the counters while the streams started by start run
+	 */
+	template<typename F>
+	void measure(stream_run& run, F&& start)
+	{
+		const process_counters before = read_counters();
+		auto stop = start();
+
+		FPlatformProcess::Sleep(0.2f);
+		const process_counters running = read_counters();
+		FPlatformProcess::Sleep(static_cast<float>(run_seconds));
+		const process_counters after = read_counters();
+
+		stop();
+
+		run.added_threads = running.threads - before.threads;
+		if (running.context_switches >= 0)
+			run.switches_per_second = (after.context_switches - running.context_switches) / run_seconds;
+		if (running.cycles >= 0)
+			run.cycles_per_second = (after.cycles - running.cycles) / run_seconds;
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(F_stream_executor_test, "ar_integration.stream_executor.threads",
+	EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::PerfFilter)
+
+bool F_stream_executor_test::RunTest(const FString& Parameters)
+{
+	if (read_counters().threads < 0)
+	{
+		AddWarning(TEXT("thread counters are only read from /proc or a toolhelp snapshot"));
+		return true;
+	}
+
+	/**
+	 * joint streams at 100 Hz like the franka clients
+	 */
+	joint_service joints(std::chrono::milliseconds(10));
+	int port = 0;
+	const std::unique_ptr<grpc::Server> server = start_test_server(port, joints);
+	if (!TestNotNull(TEXT("server"), server.get()))
+		return false;
+
+	const auto channel = grpc::CreateChannel(TCHAR_TO_UTF8(*test_server_target(port)), grpc::InsecureChannelCredentials());
+	const auto stub = generated::robot_com::NewStub(channel);
+	if (!TestTrue(TEXT("connected"), channel->WaitForConnected(std::chrono::system_clock::now() + std::chrono::seconds(2))))
+		return false;
+
+	stream_run executor;
+	measure(executor, [&]()
+		{
+			auto readers = std::make_shared<std::vector<std::unique_ptr<async_stream_reader<generated::Sync_Joints_Transmission>>>>();
+			for (int32 i = 0; i < stream_count; ++i)
+				readers->push_back(std::make_unique<async_stream_reader<generated::Sync_Joints_Transmission>>(
+					[&](grpc::ClientContext& ctx, grpc::CompletionQueue* cq)
+					{
+						return prepare_stream(channel.get(), "/generated.robot_com/transmit_sync_joints", ctx, google::protobuf::Empty(), cq);
+					},
+					[&](message_pool<generated::Sync_Joints_Transmission>::handle&)
+					{
+						executor.messages.fetch_add(1, std::memory_order_relaxed);
+					}));
+
+			return [readers]() { readers->clear(); };
+		});
+
+	/**
+	 * a blocked thread per stream as before the executor
+	 */
+	stream_run dedicated;
+	measure(dedicated, [&]()
+		{
+			auto contexts = std::make_shared<std::vector<std::unique_ptr<grpc::ClientContext>>>();
+			auto threads = std::make_shared<std::vector<std::thread>>();
+			for (int32 i = 0; i < stream_count; ++i)
+			{
+				grpc::ClientContext* ctx = contexts->emplace_back(std::make_unique<grpc::ClientContext>()).get();
+				threads->emplace_back([&, ctx]()
+					{
+						const auto reader = stub->transmit_sync_joints(ctx, google::protobuf::Empty());
+						generated::Sync_Joints_Transmission message;
+						while (reader->Read(&message))
+							dedicated.messages.fetch_add(1, std::memory_order_relaxed);
+						reader->Finish();
+					});
+			}
+
+			return [contexts, threads]()
+			{
+				for (const auto& ctx : *contexts)
+					ctx->TryCancel();
+				for (std::thread& thread : *threads)
+					thread.join();
+			};
+		});
+
+	for (const auto& [name, run] : { std::make_pair(TEXT("executor"), &executor), std::make_pair(TEXT("thread per stream"), &dedicated) })
+	{
+		FString activity;
+		if (run->switches_per_second >= 0.)
+			activity += FString::Printf(TEXT(", %.0f context switches/s"), run->switches_per_second);
+		if (run->cycles_per_second >= 0.)
+			activity += FString::Printf(TEXT(", %.3g cpu cycles/s"), run->cycles_per_second);
+
+		AddInfo(FString::Printf(TEXT("%d streams on %s: %lld threads added%s, %lld messages"),
+			stream_count, name, run->added_threads, *activity, run->messages.load()));
+		TestTrue(TEXT("messages received"), run->messages.load() > 0);
+	}
+
+	server->Shutdown();
+	return true;
+}
+
+#endif
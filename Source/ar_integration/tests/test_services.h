@@ -0,0 +1,66 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+#include "grpc_include_begin.h"
+#include "grpcpp/server_builder.h"
+#include "robot.grpc.pb.h"
+#include "grpc_include_end.h"
+
+#include <chrono>
+#include <memory>
+
+/**
+ * @class joint_service
+ * streams a joint state per period stamped with its send time,
+ * server and client share the clock in the same process
+ */
+class joint_service final : public generated::robot_com::Service
+{
+public:
+
+	explicit joint_service(std::chrono::microseconds period)
+		: period(period)
+	{}
+
+	grpc::Status transmit_sync_joints(grpc::ServerContext* ctx, const google::protobuf::Empty*,
+		grpc::ServerWriter<generated::Sync_Joints_Transmission>* writer) override
+	{
+		generated::Sync_Joints_Transmission message;
+		generated::Sync_Joints* joints = message.mutable_sync_joints_data()->add_sync_joints();
+		while (!ctx->IsCancelled())
+		{
+			joints->set_utc_timepoint(FPlatformTime::Seconds());
+			if (!writer->Write(message))
+				break;
+			FPlatformProcess::Sleep(period.count() * 1e-6f);
+		}
+		return grpc::Status::OK;
+	}
+
+private:
+
+	std::chrono::microseconds period;
+};
+
+/**
+ * starts a server on a free local port with services
+ * @returns nullptr if it could not be started
+ */
+template<typename... Services>
+std::unique_ptr<grpc::Server> start_test_server(int& port, Services&... services)
+{
+	grpc::ServerBuilder builder;
+	builder.AddListeningPort("127.0.0.1:0", grpc::InsecureServerCredentials(), &port);
+	(builder.RegisterService(&services), ...);
+
+	std::unique_ptr<grpc::Server> server = builder.BuildAndStart();
+	if (!server || port <= 0)
+		return nullptr;
+	return server;
+}
+
+inline FString test_server_target(int port)
+{
+	return FString::Printf(TEXT("ipv4:127.0.0.1:%d"), port);
+}
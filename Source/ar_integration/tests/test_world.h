@@ -0,0 +1,43 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/Engine.h"
+#include "Engine/World.h"
+
+/**
+ * @class test_world
+ * game world without a map for automation tests spawning actors,
+ * destroyed with the object
+ */
+class test_world final
+{
+public:
+
+	test_world()
+	{
+		world = UWorld::CreateWorld(EWorldType::Game, false);
+		GEngine->CreateNewWorldContext(EWorldType::Game).SetCurrentWorld(world);
+
+		world->InitializeActorsForPlay(FURL());
+		world->BeginPlay();
+	}
+
+	~test_world()
+	{
+		GEngine->DestroyWorldContext(world);
+		world->DestroyWorld(false);
+	}
+
+	test_world(const test_world&) = delete;
+	test_world& operator=(const test_world&) = delete;
+
+	template<typename T>
+	T* spawn()
+	{
+		return world->SpawnActor<T>();
+	}
+
+private:
+
+	UWorld* world;
+};
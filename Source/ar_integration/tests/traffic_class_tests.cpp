@@ -0,0 +1,147 @@
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+#include "grpc_channel.h"
+#include "test_services.h"
+
+#include "grpc_include_begin.h"
+#include "depth_image.grpc.pb.h"
+#include "grpc_include_end.h"
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+
+namespace
+{
+	/**
+	 * accepts point clouds as fast as they arrive
+	 */
+	class pcl_service final : public generated::pcl_com::Service
+	{
+	public:
+
+		grpc::Status transmit_pcl_data(grpc::ServerContext*,
+			grpc::ServerReader<generated::Pcl_Data_Meta>* reader, generated::ICP_Result*) override
+		{
+			generated::Pcl_Data_Meta message;
+			while (reader->Read(&message))
+			{}
+			return grpc::Status::OK;
+		}
+	};
+
+	struct joint_latency
+	{
+		double mean_ms = 0.;
+		double p99_ms = 0.;
+		int32 samples = 0;
+	};
+
+	/**
+	 * receives joints on joints_channel for seconds while point clouds
+	 * of 100k points are uploaded on upload_channel if set
+	 */
+	joint_latency measure(const std::shared_ptr<grpc::Channel>& joints_channel,
+		const std::shared_ptr<grpc::Channel>& upload_channel, double seconds)
+	{
+		std::atomic_bool uploading = true;
+		std::thread upload;
+		if (upload_channel)
+		{
+			upload = std::thread([&uploading, &upload_channel]()
+				{
+					generated::Pcl_Data_Meta message;
+					for (int32 i = 0; i < 100000; ++i)
+					{
+						generated::vertex_3d* v = message.mutable_pcl_data()->add_vertices();
+						v->set_x(i * 0.001f);
+						v->set_y(i * 0.002f);
+						v->set_z(i * 0.003f);
+					}
+
+					const auto stub = generated::pcl_com::NewStub(upload_channel);
+					grpc::ClientContext ctx;
+					generated::ICP_Result result;
+					const auto writer = stub->transmit_pcl_data(&ctx, &result);
+					while (uploading && writer->Write(message))
+					{}
+					writer->WritesDone();
+					writer->Finish();
+				});
+		}
+
+		/**
+		 * the upload fills the connection first
+		 */
+		FPlatformProcess::Sleep(0.2f);
+
+		const auto stub = generated::robot_com::NewStub(joints_channel);
+		grpc::ClientContext ctx;
+		const auto reader = stub->transmit_sync_joints(&ctx, google::protobuf::Empty());
+
+		std::vector<double> samples;
+		generated::Sync_Joints_Transmission message;
+		const double end = FPlatformTime::Seconds() + seconds;
+		while (FPlatformTime::Seconds() < end && reader->Read(&message))
+			samples.push_back(1e3 * (FPlatformTime::Seconds() - message.sync_joints_data().sync_joints(0).utc_timepoint()));
+
+		ctx.TryCancel();
+		reader->Finish();
+
+		uploading = false;
+		if (upload.joinable())
+			upload.join();
+
+		joint_latency out;
+		out.samples = static_cast<int32>(samples.size());
+		if (samples.empty())
+			return out;
+
+		std::sort(samples.begin(), samples.end());
+		for (const double sample : samples)
+			out.mean_ms += sample;
+		out.mean_ms /= samples.size();
+		out.p99_ms = samples[samples.size() * 99 / 100];
+		return out;
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(F_traffic_class_test, "ar_integration.grpc_channel.traffic_class",
+	EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::PerfFilter)
+
+bool F_traffic_class_test::RunTest(const FString& Parameters)
+{
+	joint_service joints(std::chrono::milliseconds(1));
+	pcl_service pcl;
+	int port = 0;
+	const std::unique_ptr<grpc::Server> server = start_test_server(port, joints, pcl);
+	if (!TestNotNull(TEXT("server"), server.get()))
+		return false;
+
+	const channel_pool pool = U_grpc_channel::connect(test_server_target(port), 2000);
+	if (!TestTrue(TEXT("connected"), pool[0] != nullptr))
+		return false;
+
+	const auto& realtime = pool[static_cast<size_t>(traffic_class::REALTIME)];
+	const auto& bulk = pool[static_cast<size_t>(traffic_class::BULK)];
+
+	const joint_latency idle = measure(realtime, nullptr, 2.);
+	const joint_latency shared = measure(bulk, bulk, 2.);
+	const joint_latency separate = measure(realtime, bulk, 2.);
+
+	for (const auto& [name, latency] : { std::make_pair(TEXT("idle"), idle),
+		std::make_pair(TEXT("upload on the same connection"), shared),
+		std::make_pair(TEXT("upload on the bulk connection"), separate) })
+	{
+		AddInfo(FString::Printf(TEXT("joints %s: %d samples, mean %.2f ms, p99 %.2f ms"),
+			name, latency.samples, latency.mean_ms, latency.p99_ms));
+		TestTrue(TEXT("joints received"), latency.samples > 0);
+	}
+
+	server->Shutdown();
+	return true;
+}
+
+#endif
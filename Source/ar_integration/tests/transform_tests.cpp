@@ -0,0 +1,198 @@
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+#include "TransformHelper.h"
+
+#include <array>
+#include <span>
+#include <vector>
+
+using namespace Transformation;
+
+namespace
+{
+	/**
+	 * out[row] = in[column] * multiplier * factor
+	 * looked up per element like the converter did before
+	 * the kernels were specialized
+	 */
+	struct generic_converter
+	{
+		SparseAssignments assignments;
+		float factor;
+
+		generic_converter(const TransformationMeta& origin, const TransformationMeta& target)
+			: factor(origin.scale.factor(target.scale))
+		{
+			const auto assign = [this](AxisAlignment from, AxisAlignment to)
+				{
+					assignments[static_cast<int8_t>(from.axis)] = {
+						static_cast<int8_t>(from.axis),
+						static_cast<int8_t>(to.axis),
+						static_cast<float>(from.direction) * static_cast<float>(to.direction)
+					};
+				};
+
+			assign(origin.right(), target.right());
+			assign(origin.forward(), target.forward());
+			assign(origin.up(), target.up());
+		}
+
+		FVector convert_point(const FVector& in) const
+		{
+			FVector out;
+			for (const auto& [column, row, multiplier] : assignments)
+				out[row] = in[column] * multiplier * factor;
+			return out;
+		}
+	};
+
+	/**
+	 * all 48 combinations of axis order and directions
+	 */
+	std::vector<TransformationMeta> all_metas()
+	{
+		constexpr std::array<std::array<Axis, 3>, 6> orders = { {
+			{ Axis::X, Axis::Y, Axis::Z }, { Axis::X, Axis::Z, Axis::Y },
+			{ Axis::Y, Axis::X, Axis::Z }, { Axis::Y, Axis::Z, Axis::X },
+			{ Axis::Z, Axis::X, Axis::Y }, { Axis::Z, Axis::Y, Axis::X }
+		} };
+
+		const auto direction = [](int signs, int bit)
+			{
+				return signs & (1 << bit) ? AxisDirection::NEGATIVE : AxisDirection::POSITIVE;
+			};
+
+		std::vector<TransformationMeta> metas;
+		for (const auto& order : orders)
+			for (int signs = 0; signs < 8; ++signs)
+				metas.emplace_back(
+					AxisAlignment{ order[0], direction(signs, 0) },
+					AxisAlignment{ order[1], direction(signs, 1) },
+					AxisAlignment{ order[2], direction(signs, 2) },
+					Ratio(1, 1));
+		return metas;
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(F_axis_kernel_test, "ar_integration.transformation.axis_kernels",
+	EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::PerfFilter)
+
+bool F_axis_kernel_test::RunTest(const FString& Parameters)
+{
+	std::vector<FVector> points(1 << 20);
+	for (size_t i = 0; i < points.size(); ++i)
+		points[i] = FVector(i * 0.25, -static_cast<double>(i % 977), (i % 31) * 3.);
+
+	for (const TransformationMeta& meta : all_metas())
+	{
+		const TransformationConverter specialized(meta, UnrealMeta);
+		const generic_converter generic(meta, UnrealMeta);
+
+		bool equal = true;
+		for (size_t i = 0; i < points.size(); i += 4099)
+			equal &= specialized.convert_point(points[i]).Equals(generic.convert_point(points[i]), 1e-6);
+		TestTrue(FString::Printf(TEXT("kernel of (%d, %d, %d)"),
+			static_cast<int32>(meta.right().axis) * static_cast<int32>(meta.right().direction),
+			static_cast<int32>(meta.forward().axis) * static_cast<int32>(meta.forward().direction),
+			static_cast<int32>(meta.up().axis) * static_cast<int32>(meta.up().direction)), equal);
+	}
+
+	/**
+	 * right handed, y up, meters as sent by the server
+	 */
+	const TransformationMeta server(
+		{ Axis::X, AxisDirection::POSITIVE },
+		{ Axis::Z, AxisDirection::NEGATIVE },
+		{ Axis::Y, AxisDirection::POSITIVE },
+		Ratio(1, 1));
+
+	const TransformationConverter specialized(server, UnrealMeta);
+	const generic_converter generic(server, UnrealMeta);
+
+	std::vector<FVector> out(points.size());
+	const auto points_per_second = [&](auto&& convert)
+		{
+			const double start = FPlatformTime::Seconds();
+			for (size_t i = 0; i < points.size(); ++i)
+				out[i] = convert(points[i]);
+			return points.size() / (FPlatformTime::Seconds() - start);
+		};
+
+	const double generic_rate = points_per_second([&](const FVector& in) { return generic.convert_point(in); });
+	const double specialized_rate = points_per_second([&](const FVector& in) { return specialized.convert_point(in); });
+
+	AddInfo(FString::Printf(TEXT("%d points: specialized %.1f M points/s, generic %.1f M points/s"),
+		static_cast<int32>(points.size()), specialized_rate * 1e-6, generic_rate * 1e-6));
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(F_span_conversion_test, "ar_integration.transformation.span_conversion",
+	EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::PerfFilter)
+
+bool F_span_conversion_test::RunTest(const FString& Parameters)
+{
+	const TransformationMeta server(
+		{ Axis::X, AxisDirection::POSITIVE },
+		{ Axis::Z, AxisDirection::NEGATIVE },
+		{ Axis::Y, AxisDirection::POSITIVE },
+		Ratio(1, 1));
+	const TransformationConverter cv(server, UnrealMeta);
+
+	for (const int32 count : { 10000, 100000, 1000000 })
+	{
+		/**
+		 * the vertices of a mesh as received
+		 */
+		google::protobuf::RepeatedPtrField<generated::vertex_3d> vertices;
+		vertices.Reserve(count);
+		for (int32 i = 0; i < count; ++i)
+		{
+			generated::vertex_3d* vertex = vertices.Add();
+			vertex->set_x(i * 0.001f);
+			vertex->set_y(-(i % 1013) * 0.01f);
+			vertex->set_z((i % 7) * 0.5f);
+		}
+		const std::span<const generated::vertex_3d* const> in(vertices.data(), vertices.size());
+
+		TArray<FVector> element_wise;
+		TArray<FVector> bulk;
+		TArray<float> interleaved;
+
+		double start = FPlatformTime::Seconds();
+		element_wise.Reserve(count);
+		for (const auto& vertex : vertices)
+			element_wise.Add(cv.convert_point_proto(vertex));
+		const double element_wise_seconds = FPlatformTime::Seconds() - start;
+
+		start = FPlatformTime::Seconds();
+		bulk.SetNumUninitialized(count);
+		cv.convert_proto_span(in, std::span<FVector>(bulk.GetData(), bulk.Num()));
+		const double bulk_seconds = FPlatformTime::Seconds() - start;
+
+		start = FPlatformTime::Seconds();
+		interleaved.SetNumUninitialized(3 * count);
+		cv.convert_proto_span(in, std::span<float>(interleaved.GetData(), interleaved.Num()));
+		const double interleaved_seconds = FPlatformTime::Seconds() - start;
+
+		/**
+		 * the interleaved floats round vertices up to 1 km in centimeters
+		 */
+		bool equal = true;
+		for (int32 i = 0; i < count; ++i)
+		{
+			equal &= bulk[i].Equals(element_wise[i], 1e-6);
+			equal &= FVector(interleaved[3 * i], interleaved[3 * i + 1], interleaved[3 * i + 2]).Equals(element_wise[i], 1e-2);
+		}
+		TestTrue(FString::Printf(TEXT("%d vertices equal"), count), equal);
+
+		AddInfo(FString::Printf(TEXT("%d vertices: element wise %.1f, span %.1f, interleaved %.1f M vertices/s"),
+			count, count / element_wise_seconds * 1e-6, count / bulk_seconds * 1e-6, count / interleaved_seconds * 1e-6));
+	}
+
+	return true;
+}
+
+#endif
@@ -0,0 +1,117 @@
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+#include "Algo/AllOf.h"
+#include "Async/Async.h"
+
+#include "sparse_voxel_map.h"
+
+namespace
+{
+	/**
+	 * 1M voxels of a 100x100x100 block, split into frames
+	 * of 10000 like the clouds of the pcl client
+	 */
+	TArray<TArray<FIntVector>> block_frames()
+	{
+		TArray<TArray<FIntVector>> frames;
+		for (int32 z = 0; z < 100; ++z)
+		{
+			TArray<FIntVector>& frame = frames.AddDefaulted_GetRef();
+			frame.Reserve(100 * 100);
+			for (int32 y = 0; y < 100; ++y)
+				for (int32 x = 0; x < 100; ++x)
+					frame.Emplace(x, y, z);
+		}
+		return frames;
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(F_voxel_map_budget_test, "ar_integration.voxel_map.budget",
+	EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::PerfFilter)
+
+bool F_voxel_map_budget_test::RunTest(const FString& Parameters)
+{
+	const TArray<TArray<FIntVector>> frames = block_frames();
+
+	for (const size_t budget_mb : { 4, 256 })
+	{
+		sharded_voxel_map map;
+		map.set_budget(budget_mb * 1024 * 1024, sparse_voxel_map::eviction::LEAST_RECENT);
+
+		const double start = FPlatformTime::Seconds();
+		for (const TArray<FIntVector>& frame : frames)
+		{
+			map.insert(frame);
+
+			sharded_voxel_map::release(map.take());
+		}
+		const double seconds = FPlatformTime::Seconds() - start;
+
+		const sparse_voxel_map_stats stats = map.stats();
+		AddInfo(FString::Printf(TEXT("budget %llu MB: %lld voxels in %lld bricks, %.1f MB (storage %.1f MB), %lld evicted, %.1f M voxels/s"),
+			static_cast<uint64>(budget_mb), stats.voxels, stats.bricks,
+			stats.bytes / (1024.0 * 1024.0), stats.storage_bytes / (1024.0 * 1024.0),
+			stats.evicted_bricks, 1e-6 * 100 * 100 * 100 / seconds));
+
+		TestTrue(TEXT("storage within budget"), static_cast<size_t>(stats.storage_bytes) <= budget_mb * 1024 * 1024);
+		if (budget_mb == 256)
+		{
+			TestEqual(TEXT("all voxels kept"), stats.voxels, int64(100 * 100 * 100));
+			TestEqual(TEXT("nothing evicted"), stats.evicted_bricks, int64(0));
+		}
+	}
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(F_voxel_map_contention_test, "ar_integration.voxel_map.contention",
+	EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::PerfFilter)
+
+bool F_voxel_map_contention_test::RunTest(const FString& Parameters)
+{
+	const TArray<TArray<FIntVector>> frames = block_frames();
+
+	for (int32 producers = 1; producers <= 4; ++producers)
+	{
+		sharded_voxel_map map;
+		std::atomic_int32_t next = 0;
+
+		/**
+		 * producers take frames from a shared counter
+		 * while the game thread drains the batches
+		 */
+		const double start = FPlatformTime::Seconds();
+		TArray<TFuture<void>> workers;
+		for (int32 i = 0; i < producers; ++i)
+			workers.Add(Async(EAsyncExecution::Thread, [&]()
+				{
+					for (int32 f = next++; f < frames.Num(); f = next++)
+						map.insert(frames[f]);
+				}));
+
+		int64 taken = 0;
+		bool done = false;
+		while (!done)
+		{
+			done = Algo::AllOf(workers, [](const TFuture<void>& w) { return w.IsReady(); });
+
+			sharded_voxel_map::batch* batches = map.take();
+			for (auto* it = batches; it; it = it->next)
+				taken += it->voxels.Num();
+			sharded_voxel_map::release(batches);
+		}
+		const double seconds = FPlatformTime::Seconds() - start;
+
+		AddInfo(FString::Printf(TEXT("%d producers: %.1f M voxels/s"),
+			producers, 1e-6 * 100 * 100 * 100 / seconds));
+
+		TestEqual(TEXT("every voxel handed over once"), taken, int64(100 * 100 * 100));
+		TestEqual(TEXT("all voxels kept"), map.stats().voxels, int64(100 * 100 * 100));
+	}
+
+	return true;
+}
+
+#endif
@@ -0,0 +1,115 @@
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+#include "Components/InstancedStaticMeshComponent.h"
+
+#include "test_world.h"
+#include "voxel.h"
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(F_voxel_tick_test, "ar_integration.voxel.tick",
+	EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::PerfFilter)
+
+bool F_voxel_tick_test::RunTest(const FString& Parameters)
+{
+	test_world world;
+	A_voxel* voxel = world.spawn<A_voxel>();
+	if (!TestNotNull(TEXT("voxel actor"), voxel))
+		return false;
+
+	voxel->set_voxel_size(1.f);
+
+	/**
+	 * every frame adds a new layer of 10000 voxels, the tick
+	 * cost has to stay flat while the total count grows
+	 */
+	TArray<FVector> frame;
+	frame.Reserve(100 * 100);
+	for (int32 z = 0; z < 100; ++z)
+	{
+		frame.Reset();
+		for (int32 y = 0; y < 100; ++y)
+			for (int32 x = 0; x < 100; ++x)
+				frame.Emplace(x, y, z);
+		voxel->insert(frame);
+
+		const double start = FPlatformTime::Seconds();
+		voxel->Tick(0.f);
+		const double ms = 1e3 * (FPlatformTime::Seconds() - start);
+
+		if ((z + 1) % 10 == 0)
+			AddInfo(FString::Printf(TEXT("%d voxels: tick %.2f ms"), (z + 1) * 100 * 100, ms));
+	}
+
+	TestEqual(TEXT("voxels"), voxel->get_map_metrics().voxels, int64(100 * 100 * 100));
+
+	/**
+	 * a tick without new voxels touches no instance
+	 */
+	const double start = FPlatformTime::Seconds();
+	voxel->Tick(0.f);
+	AddInfo(FString::Printf(TEXT("idle tick %.3f ms"), 1e3 * (FPlatformTime::Seconds() - start)));
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(F_voxel_eviction_test, "ar_integration.voxel.eviction",
+	EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::PerfFilter)
+
+bool F_voxel_eviction_test::RunTest(const FString& Parameters)
+{
+	test_world world;
+	A_voxel* voxel = world.spawn<A_voxel>();
+	if (!TestNotNull(TEXT("voxel actor"), voxel))
+		return false;
+
+	const UInstancedStaticMeshComponent* instanced = voxel->FindComponentByClass<UInstancedStaticMeshComponent>();
+	if (!TestNotNull(TEXT("instanced component"), instanced))
+		return false;
+
+	voxel->set_voxel_size(1.f);
+	voxel->memory_budget_mb = 4.f;
+
+	/**
+	 * the block does not fit into the budget, so the
+	 * later layers evict bricks of the earlier ones
+	 */
+	TArray<FVector> frame;
+	frame.Reserve(100 * 100);
+	double evicting_ms = 0.;
+	int32 evicting_ticks = 0;
+	int64 evicted = 0;
+	bool consistent = true;
+	for (int32 z = 0; z < 100; ++z)
+	{
+		frame.Reset();
+		for (int32 y = 0; y < 100; ++y)
+			for (int32 x = 0; x < 100; ++x)
+				frame.Emplace(x, y, z);
+		voxel->insert(frame);
+
+		const double start = FPlatformTime::Seconds();
+		voxel->Tick(0.f);
+		const double ms = 1e3 * (FPlatformTime::Seconds() - start);
+
+		const F_voxel_map_metrics metrics = voxel->get_map_metrics();
+		if (metrics.evicted_bricks != evicted)
+		{
+			evicting_ms += ms;
+			++evicting_ticks;
+			evicted = metrics.evicted_bricks;
+		}
+		consistent &= instanced->GetInstanceCount() == metrics.voxels;
+	}
+
+	TestTrue(TEXT("bricks evicted"), evicting_ticks > 0);
+	TestTrue(TEXT("one instance per voxel after every tick"), consistent);
+
+	const F_voxel_map_metrics metrics = voxel->get_map_metrics();
+	AddInfo(FString::Printf(TEXT("%lld voxels, %lld bricks evicted: %.2f ms per evicting tick over %d ticks"),
+		metrics.voxels, metrics.evicted_bricks, evicting_ticks > 0 ? evicting_ms / evicting_ticks : 0., evicting_ticks));
+
+	return true;
+}
+
+#endif
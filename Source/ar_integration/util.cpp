@@ -428,19 +428,24 @@ std::array<float, 3> convert(const FVector& in)
 template<>
 generated::quaternion convert(const FQuat& in)
 {
-	FQuat temp = in;
-	temp.Normalize();
-
 	generated::quaternion out;
-
-	out.set_x(temp.X);
-	out.set_y(temp.Y);
-	out.set_z(temp.Z);
-	out.set_w(temp.W);
+	convert_into(in, &out);
 
 	return out;
 }
 
+template<>
+void convert_into(const FQuat& in, generated::quaternion* out)
+{
+	FQuat temp = in;
+	temp.Normalize();
+
+	out->set_x(temp.X);
+	out->set_y(temp.Y);
+	out->set_z(temp.Z);
+	out->set_w(temp.W);
+}
+
 
 template<>
 generated::size_3d convert(const FVector& in)
@@ -457,13 +462,19 @@ template<>
 generated::vertex_3d convert(const FVector& in)
 {
 	generated::vertex_3d out;
-	out.set_x(in.X);
-	out.set_y(in.Y);
-	out.set_z(in.Z);
+	convert_into(in, &out);
 
 	return out;
 }
 
+template<>
+void convert_into(const FVector& in, generated::vertex_3d* out)
+{
+	out->set_x(in.X);
+	out->set_y(in.Y);
+	out->set_z(in.Z);
+}
+
 template<>
 generated::Matrix convert(const FMatrix& in)
 {
@@ -498,59 +509,34 @@ generated::Matrix convert(const FTransform& in)
 	return out;
 }
 
-/*
 template<>
-std::unique_ptr<draco::PointCloud> convert(const TArray<FVector>& in)
+generated::Pcl_Data convert(const F_point_cloud& pcl)
 {
-	TSet<size_t> not_nan;
-	for (size_t i = 0; i < in.Num(); ++i)
-	{
-		if (!in[i].ContainsNaN())
-			not_nan.Add(i);
-	}
-
-	draco::PointCloudBuilder builder;
-	builder.Start(not_nan.Num());
-
-	const int att_id = builder.AddAttribute(draco::GeometryAttribute::POSITION, 3, draco::DataType::DT_FLOAT32);
-	const auto data = convert_std_array<std::array<float, 3>, true>(in);
-
-	for (const auto& idx : not_nan)
-		builder.SetAttributeValueForPoint(att_id, draco::PointIndex(idx), data.data() + 3 * idx);
+	generated::Pcl_Data request;
+	convert_into(pcl, &request);
 
-	return builder.Finalize(false);
+	return request;
 }
 
 template<>
-generated::draco_data convert(const F_point_cloud& pcl)
+void convert_into(const F_point_cloud& pcl, generated::Pcl_Data* out)
 {
-	generated::draco_data request;
-
-	const auto draco_cloud = convert<std::unique_ptr<draco::PointCloud>>(pcl.data);
-
-	draco::EncoderBuffer buffer;
-	draco::PointCloudKdTreeEncoder encoder;
-	draco::EncoderOptions options = draco::EncoderOptions::CreateDefaultOptions();
-	options.SetSpeed(4, 1);
-	encoder.SetPointCloud(*draco_cloud);
-	encoder.Encode(options, &buffer);
-
-	request.set_data(buffer.data(), buffer.size());
-	request.set_timestamp(pcl.abs_timestamp);
-
-	return request;
-}*/
+	append_finite(pcl.points, out->mutable_vertices());
+	out->set_timestamp(pcl.abs_timestamp);
+}
 
 template<>
-generated::Pcl_Data convert(const F_point_cloud& pcl)
+void convert_into(const depth_unprojection& in, generated::Depth_Intrinsics* out)
 {
-	generated::Pcl_Data request;
-	request.mutable_vertices()->CopyFrom(
-		convert_array<generated::vertex_3d, true>(pcl.data));
-
-	request.set_timestamp(pcl.abs_timestamp);
+	out->set_width(in.get_width());
+	out->set_height(in.get_height());
 
-	return request;
+	const auto& x = in.ray(0);
+	const auto& y = in.ray(1);
+	const auto& z = in.ray(2);
+	out->mutable_ray_x()->Assign(x.begin(), x.end());
+	out->mutable_ray_y()->Assign(y.begin(), y.end());
+	out->mutable_ray_z()->Assign(z.begin(), z.end());
 }
 
 template<>
@@ -597,31 +583,36 @@ template<>
 generated::Hand_Data convert(const std::pair<FXRMotionControllerData, FDateTime>& in)
 {
 	generated::Hand_Data out;
+	convert_into(in, &out);
 
+	return out;
+}
+
+template<>
+void convert_into(const std::pair<FXRMotionControllerData, FDateTime>& in, generated::Hand_Data* out)
+{
 	const auto& hand_data = in.first;
 
-	out.set_valid(hand_data.bValid);
-	out.set_hand(static_cast<generated::hand_index>(hand_data.HandIndex));
-	out.set_tracking_stat(static_cast<generated::tracking_status>(hand_data.TrackingStatus));
+	out->set_valid(hand_data.bValid);
+	out->set_hand(static_cast<generated::hand_index>(hand_data.HandIndex));
+	out->set_tracking_stat(static_cast<generated::tracking_status>(hand_data.TrackingStatus));
 
 	if (hand_data.bValid)
 	{
-		*out.mutable_grip_position() = convert<generated::vertex_3d>(hand_data.GripPosition);
-		*out.mutable_grip_rotation() = convert<generated::quaternion>(hand_data.GripRotation);
-		*out.mutable_aim_position() = convert<generated::vertex_3d>(hand_data.AimPosition);
-		*out.mutable_aim_rotation() = convert<generated::quaternion>(hand_data.AimRotation);
-		*out.mutable_hand_key_positions() = convert_array<generated::vertex_3d>(hand_data.HandKeyPositions);
-		*out.mutable_hand_key_rotations() = convert_array<generated::quaternion>(hand_data.HandKeyRotations);
-
-		const auto mutable_radii = out.mutable_hand_key_radii();
+		convert_into(hand_data.GripPosition, out->mutable_grip_position());
+		convert_into(hand_data.GripRotation, out->mutable_grip_rotation());
+		convert_into(hand_data.AimPosition, out->mutable_aim_position());
+		convert_into(hand_data.AimRotation, out->mutable_aim_rotation());
+		convert_array_into(hand_data.HandKeyPositions, out->mutable_hand_key_positions());
+		convert_array_into(hand_data.HandKeyRotations, out->mutable_hand_key_rotations());
+
+		const auto mutable_radii = out->mutable_hand_key_radii();
 		mutable_radii->Reserve(hand_data.HandKeyRadii.Num());
 		for (const float& f : hand_data.HandKeyRadii)
 			mutable_radii->Add(f);
 	}
-	out.set_is_grasped(hand_data.bIsGrasped);
-	out.set_utc_timestamp(in.second.GetTicks());
-
-	return out;
+	out->set_is_grasped(hand_data.bIsGrasped);
+	out->set_utc_timestamp(in.second.GetTicks());
 }
 
 template<>
@@ -5,6 +5,10 @@
 #include "HeadMountedDisplayTypes.h"
 #include "Misc/DateTime.h"
 
+#include <bit>
+#include <span>
+#include <type_traits>
+
 #include "grpc_wrapper.h"
 #include "camera.h"
 
@@ -18,9 +22,6 @@
 #include "meta_data.pb.h"
 #include "grpc_include_end.h"
 
-//#include <draco/point_cloud/point_cloud_builder.h>
-//#include <draco/compression/point_cloud/point_cloud_kd_tree_encoder.h>
-
 //#include "Math/UnitConversion.h"
 
 #include "TransformHelper.h"
@@ -61,6 +62,14 @@ out convert(const in&);
 template<typename out, typename in>
 out convert_meta(const in&, TF_Conv_Wrapper& cv);
 
+/**
+ * fills an existing message instead of returning a new one
+ * e.g. one recycled by a @ref{message_pool}
+ * @attend expects a cleared message
+ */
+template<typename out, typename in>
+void convert_into(const in&, out*);
+
 template<typename out, typename in>
 out convert_meta(const in&, const Transformation::TransformationConverter* cv = nullptr);
 
@@ -79,10 +88,28 @@ TArray<inner_out> convert_array(const google::protobuf::RepeatedPtrField<inner_i
 	return out;
 }
 
+/**
+ * uses the bulk conversion of cv if there is one for the element types
+ */
 template<typename inner_out, typename inner_in>
 TArray<inner_out> convert_array_meta(const google::protobuf::RepeatedPtrField<inner_in>& in, const Transformation::TransformationConverter* cv = nullptr)
 {
 	TArray<inner_out> out;
+
+	if constexpr (requires(const Transformation::TransformationConverter& converter,
+		std::span<const inner_in* const> in_span, std::span<inner_out> out_span)
+		{ converter.convert_proto_span(in_span, out_span); })
+	{
+		if (cv)
+		{
+			out.SetNumUninitialized(in.size());
+			cv->convert_proto_span(
+				std::span<const inner_in* const>(in.data(), in.size()),
+				std::span<inner_out>(out.GetData(), out.Num()));
+			return out;
+		}
+	}
+
 	out.Reserve(in.size());
 
 	for (const auto& it : in)
@@ -103,26 +130,99 @@ std::vector<inner_out> convert_std_array(const TArray<inner_in>& in)
 	return out;
 }
 
+/**
+ * @returns true if no component is nan or infinite
+ * inspects the exponent bits so it stays correct under fast math
+ * and compiles without branches
+ */
+inline bool is_finite(const FVector& v)
+{
+	constexpr uint64 exponent = 0x7FF0000000000000ull;
+	return ((std::bit_cast<uint64>(static_cast<double>(v.X)) & exponent) != exponent)
+		& ((std::bit_cast<uint64>(static_cast<double>(v.Y)) & exponent) != exponent)
+		& ((std::bit_cast<uint64>(static_cast<double>(v.Z)) & exponent) != exponent);
+}
+
+/**
+ * @returns number of points passing @ref{is_finite}
+ */
+inline int32 count_finite(const TArray<FVector>& in)
+{
+	int32 count = 0;
+	for (const auto& it : in)
+		count += is_finite(it);
+	return count;
+}
+
+/**
+ * appends all finite points of in to out keeping their order
+ * out is reserved exactly once, so no intermediate container is needed
+ */
+template<typename inner_out>
+void append_finite(const TArray<FVector>& in, google::protobuf::RepeatedPtrField<inner_out>* out)
+{
+	out->Reserve(out->size() + count_finite(in));
+
+	for (const auto& it : in)
+	{
+		if (!is_finite(it))
+			continue;
+
+		if constexpr (std::is_same_v<inner_out, generated::vertex_3d>)
+			convert_into(it, out->Add());
+		else
+			*out->Add() = convert<inner_out, FVector>(it);
+	}
+}
+
+/**
+ * overload of @ref{append_finite} for the float32 structure of arrays
+ */
+template<typename inner_out>
+void append_finite(const point_buffer& in, google::protobuf::RepeatedPtrField<inner_out>* out)
+{
+	int32 count = 0;
+	for (int32 i = 0; i < in.Num(); ++i)
+		count += is_finite(in.get(i));
+	out->Reserve(out->size() + count);
+
+	for (int32 i = 0; i < in.Num(); ++i)
+	{
+		const FVector point = in.get(i);
+		if (!is_finite(point))
+			continue;
+
+		if constexpr (std::is_same_v<inner_out, generated::vertex_3d>)
+			convert_into(point, out->Add());
+		else
+			*out->Add() = convert<inner_out, FVector>(point);
+	}
+}
+
 template<typename inner_out, bool filter_nan>
 std::vector<inner_out> convert_std_array(const TArray<FVector>& in)
 {
 	std::vector<inner_out> out;
 	if constexpr (filter_nan)
 	{
-		TSet<size_t> not_nan;
-		for (size_t i = 0; i < in.Num(); ++i)
+		/**
+		 * writes every point and only advances past finite ones
+		 * the spare element takes the write of a trailing nan
+		 */
+		const int32 count = count_finite(in);
+		out.resize(count + 1);
+
+		size_t next = 0;
+		for (const auto& it : in)
 		{
-			if (!in[i].ContainsNaN())
-				not_nan.Add(i);
+			out[next] = convert<inner_out, FVector>(it);
+			next += is_finite(it);
 		}
-		out.reserve(not_nan.Num());
-
-		for (const auto& index : not_nan)
-			out.emplace_back(convert<inner_out, FVector>(in[index]));
+		out.resize(count);
 	}
 	else
 	{
-		out.Reserve(in.Num());
+		out.reserve(in.Num());
 
 		for (const auto& it : in)
 			out.emplace_back(convert<inner_out, FVector>(it));
@@ -130,7 +230,6 @@ std::vector<inner_out> convert_std_array(const TArray<FVector>& in)
 	return out;
 }
 
-
 template<typename inner_out, typename inner_in>
 google::protobuf::RepeatedPtrField<inner_out> convert_array(const TArray<inner_in>& in)
 {
@@ -149,18 +248,7 @@ google::protobuf::RepeatedPtrField<inner_out> convert_array(const TArray<FVector
 	google::protobuf::RepeatedPtrField<inner_out> out;
 
 	if constexpr (filter_nan)
-	{
-		TSet<size_t> not_nan;
-		for (size_t i = 0; i < in.Num(); ++i)
-		{
-			if (!in[i].ContainsNaN())
-				not_nan.Add(i);
-		}
-		out.Reserve(not_nan.Num());
-
-		for (const auto& index : not_nan)
-			out.Add(convert<inner_out, FVector>(in[index]));
-	}
+		append_finite(in, &out);
 	else
 	{
 		out.Reserve(in.Num());
@@ -171,6 +259,20 @@ google::protobuf::RepeatedPtrField<inner_out> convert_array(const TArray<FVector
 	return out;
 }
 
+/**
+ * refills out element wise, the elements kept
+ * by out after Clear are reused
+ */
+template<typename inner_out, typename inner_in>
+void convert_array_into(const TArray<inner_in>& in, google::protobuf::RepeatedPtrField<inner_out>* out)
+{
+	out->Clear();
+	out->Reserve(in.Num());
+
+	for (const auto& it : in)
+		convert_into(it, out->Add());
+}
+
 template<typename inner_out, typename inner_in>
 TArray<inner_out> convert_tarray(const google::protobuf::RepeatedPtrField<inner_in>& in)
 {
@@ -210,6 +312,9 @@ FQuat convert_meta(const generated::quaternion& in, const Transformation::Transf
 template<>
 generated::quaternion convert(const FQuat& in);
 
+template<>
+void convert_into(const FQuat& in, generated::quaternion* out);
+
 template<>
 FQuat convert_meta(const generated::Rotation_3d& in, const Transformation::TransformationConverter* cv);
 
@@ -249,6 +354,9 @@ generated::size_3d convert(const FVector& in);
 template<>
 generated::vertex_3d convert(const FVector& in);
 
+template<>
+void convert_into(const FVector& in, generated::vertex_3d* out);
+
 //TODO:: is this in use?
 template<>
 std::array<float, 3> convert(const FVector& in);
@@ -264,15 +372,14 @@ FTransform convert_meta(const generated::Matrix& in, const Transformation::Trans
 
 template<>
 generated::Matrix convert(const FTransform& in);
-/*
 template<>
-std::unique_ptr<draco::PointCloud> convert(const TArray<FVector>& in);
+generated::Pcl_Data convert(const F_point_cloud& pcl);
 
 template<>
-generated::draco_data convert(const F_point_cloud& pcl);
-*/
+void convert_into(const F_point_cloud& pcl, generated::Pcl_Data* out);
+
 template<>
-generated::Pcl_Data convert(const F_point_cloud& pcl);
+void convert_into(const depth_unprojection& in, generated::Depth_Intrinsics* out);
 
 template<>
 F_object_data convert_meta(const generated::Object_Data& in, const Transformation::TransformationConverter* cv);
@@ -310,6 +417,9 @@ generated::Obb convert(const F_obb& in);
 template<>
 generated::Hand_Data convert(const std::pair<FXRMotionControllerData, FDateTime>& in);
 
+template<>
+void convert_into(const std::pair<FXRMotionControllerData, FDateTime>& in, generated::Hand_Data* out);
+
 template<>
 F_voxel_data convert_meta(const generated::Voxels& in, const Transformation::TransformationConverter* cv);
 
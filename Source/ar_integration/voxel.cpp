@@ -39,20 +39,130 @@ void A_voxel::Tick(float DeltaSeconds)
 {
 	Super::Tick(DeltaSeconds);
 
+	sharded_voxel_map::batch* batches = voxels.take();
+
 	/**
-	 * consume to_spawn set
+	 * the component lost instances e.g. after being re-registered
 	 */
-	TArray<FTransform> swap_spawn;
+	const bool rebuild = instanced->GetInstanceCount() != instance_voxels.Num();
+
+	spawn_voxels.Reset();
+	evicted_bricks.Reset();
+	if (rebuild)
 	{
-		std::unique_lock lock(voxel_mtx);
-		swap_spawn = all_transforms;
-		//Swap(swap_spawn, to_spawn);
+		rebuilt = voxels.for_each([this](const FIntVector& voxel, uint16, uint32)
+			{
+				spawn_voxels.Add(voxel);
+			});
 	}
-	instanced->ClearInstances();
+	else
+	{
+		for (auto* it = batches; it; it = it->next)
+			it->for_each_newer(rebuilt, [this](TArrayView<const FIntVector> added, TArrayView<const FIntVector> evicted)
+				{
+					/**
+					 * voxels of earlier batches may not have been spawned yet,
+					 * later batches may occupy the evicted bricks again
+					 */
+					if (!evicted.IsEmpty())
+					{
+						const TSet<FIntVector> bricks(evicted);
+						spawn_voxels.RemoveAllSwap([&bricks](const FIntVector& voxel)
+							{
+								return bricks.Contains(sparse_voxel_map::brick_origin(voxel));
+							});
+						evicted_bricks.Append(bricks);
+					}
+
+					spawn_voxels.Append(added);
+				});
+	}
+	sharded_voxel_map::release(batches);
+
+	if (rebuild)
+	{
+		instanced->ClearInstances();
+		instance_voxels.Reset();
+	}
+
+	update_instances();
+}
+
+void A_voxel::update_instances()
+{
+	removed_slots.Reset();
+	if (!evicted_bricks.IsEmpty())
+		for (int32 slot = 0; slot < instance_voxels.Num(); ++slot)
+			if (evicted_bricks.Contains(sparse_voxel_map::brick_origin(instance_voxels[slot])))
+				removed_slots.Add(slot);
+
+	if (removed_slots.IsEmpty() && spawn_voxels.IsEmpty())
+		return;
+
+	int64 moved = 0;
+
+	/**
+	 * spawned voxels take over the slots of evicted ones
+	 */
+	const int32 reused = FMath::Min(removed_slots.Num(), spawn_voxels.Num());
+	for (int32 i = 0; i < reused; ++i)
+	{
+		const int32 slot = removed_slots[i];
+		instance_voxels[slot] = spawn_voxels[i];
+		instanced->UpdateInstanceTransform(slot, to_transform(spawn_voxels[i]), false, false, true);
+		++moved;
+	}
+
 	/**
-	 * spawn voxels as instance
+	 * swap remove the remaining slots from the back, so the
+	 * last instance is never one which is still to be removed
 	 */
-	instanced->AddInstances(swap_spawn, false);
+	const int32 previous_count = instance_voxels.Num();
+	for (int32 i = removed_slots.Num() - 1; i >= reused; --i)
+	{
+		const int32 slot = removed_slots[i];
+		const int32 last = instance_voxels.Num() - 1;
+
+		if (slot != last)
+		{
+			instance_voxels[slot] = instance_voxels[last];
+			instanced->UpdateInstanceTransform(slot, to_transform(instance_voxels[slot]), false, false, true);
+			++moved;
+		}
+		instance_voxels.Pop(EAllowShrinking::No);
+	}
+
+	const int32 removed = previous_count - instance_voxels.Num();
+	if (removed > 0)
+	{
+		/**
+		 * the tail is dropped at once
+		 */
+		TArray<int32> tail;
+		tail.Reserve(removed);
+		for (int32 slot = previous_count - 1; slot >= instance_voxels.Num(); --slot)
+			tail.Add(slot);
+		instanced->RemoveInstances(tail);
+	}
+
+	spawn_transforms.Reset();
+	for (int32 i = reused; i < spawn_voxels.Num(); ++i)
+	{
+		instance_voxels.Add(spawn_voxels[i]);
+		spawn_transforms.Add(to_transform(spawn_voxels[i]));
+	}
+
+	/**
+	 * spawn new voxels as instance
+	 */
+	if (!spawn_transforms.IsEmpty())
+		instanced->AddInstances(spawn_transforms, false);
+
+	/**
+	 * moved instances were updated without touching the render state
+	 */
+	if (moved > 0)
+		instanced->MarkRenderStateDirty();
 }
 
 void A_voxel::BeginDestroy()
@@ -64,34 +174,63 @@ void A_voxel::insert(const TArray<FVector>& points)
 {
 	init = false;
 	
-	//TSet<FIntVector> temp_new;
+	const auto start = std::chrono::steady_clock::now();
+
+	thread_local TArray<FIntVector> indices;
+	indices.Reset(points.Num());
+	for (const auto& p : points)
+		if (!p.ContainsNaN())
+			indices.Add(to_index(p));
+
+	insert_indices(indices, points.Num(), start);
+}
+
+void A_voxel::insert(const point_buffer& points)
+{
+	init = false;
+
+	const auto start = std::chrono::steady_clock::now();
+
+	thread_local TArray<FIntVector> indices;
+	indices.Reset(points.Num());
+	for (int32 i = 0; i < points.Num(); ++i)
 	{
-		std::unique_lock lock(voxel_mtx);
-		for (const auto& p : points)
-		{
-			if (p.ContainsNaN())
-				continue;
-			/**
-			 * calculate index vector of points
-			 * and insert if not present
-			 */
-			FIntVector index = FIntVector(
-				(p + p.GetSignVector() * voxel_size * 0.5f) / voxel_size
-			);
-			bool exists = false;
-			voxels.Add(index, &exists);
-			if (exists)
-				continue;
-
-			all_transforms.Add(FTransform(FQuat::Identity,
-				FVector(index) * voxel_size,
-				FVector(0.01 * voxel_size)));
-
-			//temp_new.Add(index);
-		}
+		const FVector p = points.get(i);
+		if (!p.ContainsNaN())
+			indices.Add(to_index(p));
 	}
-	//std::unique_lock lock(spawn_mtx);
-	//to_spawn.Append(temp_new);
+
+	insert_indices(indices, points.Num(), start);
+}
+
+FTransform A_voxel::to_transform(const FIntVector& voxel) const
+{
+	return FTransform(FQuat::Identity,
+		FVector(voxel) * voxel_size,
+		FVector(0.01 * voxel_size));
+}
+
+FIntVector A_voxel::to_index(const FVector& p) const
+{
+	/**
+	 * calculate index vector of points
+	 */
+	return FIntVector(
+		(p + p.GetSignVector() * voxel_size * 0.5f) / voxel_size
+	);
+}
+
+void A_voxel::insert_indices(TArrayView<const FIntVector> indices, int32 points, std::chrono::steady_clock::time_point start)
+{
+	voxels.set_budget(static_cast<size_t>(FMath::Max(memory_budget_mb, 1.f) * 1024.f * 1024.f),
+		eviction == voxel_eviction::LEAST_HIT
+			? sparse_voxel_map::eviction::LEAST_HIT
+			: sparse_voxel_map::eviction::LEAST_RECENT);
+	voxels.insert(indices);
+
+	inserted_points.fetch_add(points, std::memory_order_relaxed);
+	insert_ns.fetch_add(std::chrono::duration_cast<std::chrono::nanoseconds>(
+		std::chrono::steady_clock::now() - start).count(), std::memory_order_relaxed);
 }
 //
 //void A_voxel::insert_sync(const TArray<FVector>& points)
@@ -146,6 +285,24 @@ void A_voxel::insert(const TArray<FVector>& points)
 //	to_spawn.Add(index);
 //}
 
+F_voxel_map_metrics A_voxel::get_map_metrics()
+{
+	const sparse_voxel_map_stats stats = voxels.stats();
+
+	F_voxel_map_metrics out;
+	out.voxels = stats.voxels;
+	out.bricks = stats.bricks;
+	out.bytes = stats.bytes;
+	out.evicted_bricks = stats.evicted_bricks;
+	/**
+	 * time is summed over all producers, so this is the rate per producer
+	 */
+	const int64 ns = insert_ns.load(std::memory_order_relaxed);
+	if (ns > 0)
+		out.insert_rate = static_cast<float>(inserted_points.load(std::memory_order_relaxed) * 1e9 / ns);
+	return out;
+}
+
 void A_voxel::set_voxel_size(float size)
 {
 	size = std::abs(size);
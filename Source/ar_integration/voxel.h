@@ -4,11 +4,55 @@
 #include "Containers/Set.h"
 #include "Engine/StaticMeshActor.h"
 
+#include <atomic>
+#include <chrono>
 #include <mutex>
 #include <vector>
 
+#include "point_buffer.h"
+#include "sparse_voxel_map.h"
+
 #include "voxel.generated.h"
 
+/**
+ * @enum voxel_eviction
+ * voxels dropped first if the voxel map exceeds its memory budget
+ */
+UENUM(BlueprintType)
+enum class voxel_eviction : uint8
+{
+	LEAST_RECENT UMETA(DisplayName = "LEAST_RECENT"),
+	LEAST_HIT UMETA(DisplayName = "LEAST_HIT")
+};
+
+/**
+ * @struct F_voxel_map_metrics
+ * memory and throughput of the voxel map of an @ref{A_voxel}
+ */
+USTRUCT(BlueprintType)
+struct AR_INTEGRATION_API F_voxel_map_metrics
+{
+	GENERATED_BODY()
+
+	UPROPERTY(BlueprintReadOnly)
+	int64 voxels = 0;
+
+	UPROPERTY(BlueprintReadOnly)
+	int64 bricks = 0;
+
+	UPROPERTY(BlueprintReadOnly)
+	int64 bytes = 0;
+
+	UPROPERTY(BlueprintReadOnly)
+	int64 evicted_bricks = 0;
+
+	/**
+	 * points inserted per second while inserting
+	 */
+	UPROPERTY(BlueprintReadOnly)
+	float insert_rate = 0.f;
+};
+
 /**
  * @class for displaying of points as voxels with a pre-usage
  * defined resolution
@@ -30,6 +74,11 @@ public:
 	UFUNCTION(BlueprintCallable)
 	void insert(const TArray<FVector>& points);
 
+	/**
+	 * @ref{insert} for the point clouds of the camera
+	 */
+	void insert(const point_buffer& points);
+
 	//UFUNCTION(BlueprintCallable)
 	//void insert_sync(const TArray<FVector>& points);
 
@@ -50,9 +99,22 @@ public:
 	UFUNCTION(BlueprintCallable)
 	void set_voxel_size(float size);
 
+	UFUNCTION(BlueprintCallable)
+	F_voxel_map_metrics get_map_metrics();
+
 	//UFUNCTION(BlueprintCallable)
 	//void clear_all();
 
+	/**
+	 * memory in megabytes the voxel map may occupy
+	 * voxels are evicted according to @ref{eviction} beyond it
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Voxel", meta = (ClampMin = "1"))
+	float memory_budget_mb = 256.f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Voxel")
+	voxel_eviction eviction = voxel_eviction::LEAST_RECENT;
+
 private:
 
 	bool init = true;
@@ -60,6 +122,23 @@ private:
 
 	float dt = 0.f;
 
+	FIntVector to_index(const FVector& point) const;
+
+	FTransform to_transform(const FIntVector& voxel) const;
+
+	/**
+	 * removes the instances of evicted_bricks and adds spawn_voxels,
+	 * removed slots are refilled by added voxels or by the last
+	 * instance so the instances stay contiguous
+	 */
+	void update_instances();
+
+	/**
+	 * inserts into the voxel map and records the insert time
+	 * @param points number of points the indices were computed from
+	 */
+	void insert_indices(TArrayView<const FIntVector> indices, int32 points, std::chrono::steady_clock::time_point start);
+
 	/**
 	 * @var mesh global mesh of voxels
 	 */
@@ -78,7 +157,22 @@ private:
 	UPROPERTY()
 	UInstancedStaticMeshComponent* instanced;
 
-	TArray<FTransform> all_transforms;
+	/**
+	 * @var instance_voxels voxel of every instance of instanced
+	 * and scratch buffers, only used on the game thread
+	 */
+	TArray<FIntVector> instance_voxels;
+	TSet<FIntVector> evicted_bricks;
+	TArray<FIntVector> spawn_voxels;
+	TArray<int32> removed_slots;
+	TArray<FTransform> spawn_transforms;
+
+	/**
+	 * @var rebuilt generations of the shards read by the last rebuild,
+	 * a voxel inserted between taking the batches and reading the shards
+	 * is read by the rebuild and still arrives in the batches of the next tick
+	 */
+	sharded_voxel_map::generations rebuilt = {};
 
 	/**
 	 * @var set of voxels that have to be spawned
@@ -86,17 +180,16 @@ private:
 	TSet<FIntVector> to_spawn;
 
 	/**
-	 * @var voxels set of existing voxel indices
+	 * @var voxels map of existing voxel indices,
+	 * insertion is thread safe
 	 */
-	TSet<FIntVector> voxels;
+	sharded_voxel_map voxels;
+
+	std::atomic_int64_t inserted_points = 0;
+	std::atomic_int64_t insert_ns = 0;
 
 	/**
 	 * @var spawn_mtx mutex for produce/consume
 	 */
 	std::mutex spawn_mtx;
-
-	/**
-	 * @var voxel_mtx mutex protecting voxel comparision and insertion
-	 */
-	std::mutex voxel_mtx;	
 };
\ No newline at end of file
@@ -0,0 +1,140 @@
+#include "voxel_mesher.h"
+
+bool voxel_mesher::build(TArrayView<const FIntVector> voxels, float side_length, voxel_surface& out)
+{
+	out.reset();
+	if (voxels.IsEmpty())
+		return true;
+
+	FIntVector lower = voxels[0];
+	FIntVector upper = voxels[0];
+	for (const FIntVector& v : voxels)
+	{
+		lower = FIntVector(FMath::Min(lower.X, v.X), FMath::Min(lower.Y, v.Y), FMath::Min(lower.Z, v.Z));
+		upper = FIntVector(FMath::Max(upper.X, v.X), FMath::Max(upper.Y, v.Y), FMath::Max(upper.Z, v.Z));
+	}
+
+	/**
+	 * a free border lets every neighbour lookup stay inside the grid
+	 */
+	const FIntVector offset = lower - FIntVector(1);
+	size = upper - lower + FIntVector(3);
+
+	const int64 cells = static_cast<int64>(size.X) * size.Y * size.Z;
+	if (cells > max_cells)
+		return false;
+
+	occupancy.Reset();
+	occupancy.SetNumZeroed(static_cast<int32>((cells + 63) / 64));
+	for (const FIntVector& v : voxels)
+	{
+		const FIntVector local = v - offset;
+		const int64 cell = (static_cast<int64>(local.Z) * size.Y + local.Y) * size.X + local.X;
+		occupancy[cell >> 6] |= uint64(1) << (cell & 63);
+	}
+
+	for (int32 d = 0; d < 3; ++d)
+	{
+		const int32 u = (d + 1) % 3;
+		const int32 v = (d + 2) % 3;
+		const int32 width = size[u];
+		const int32 height = size[v];
+
+		mask.SetNumUninitialized(width * height);
+
+		for (const int32 sign : { 1, -1 })
+		{
+			FVector normal = FVector::ZeroVector;
+			normal[d] = sign;
+
+			for (int32 slice = 1; slice < size[d] - 1; ++slice)
+			{
+				/**
+				 * faces of occupied cells whose neighbour in
+				 * direction of the normal is free
+				 */
+				FIntVector cell;
+				cell[d] = slice;
+				for (int32 j = 0; j < height; ++j)
+				{
+					cell[v] = j;
+					for (int32 i = 0; i < width; ++i)
+					{
+						cell[u] = i;
+						FIntVector neighbour = cell;
+						neighbour[d] += sign;
+
+						mask[j * width + i] = occupied(cell.X, cell.Y, cell.Z)
+							&& !occupied(neighbour.X, neighbour.Y, neighbour.Z);
+					}
+				}
+
+				const double plane = (slice + offset[d] + 0.5 * sign) * side_length;
+
+				for (int32 j = 0; j < height; ++j)
+				{
+					for (int32 i = 0; i < width; )
+					{
+						if (!mask[j * width + i])
+						{
+							++i;
+							continue;
+						}
+
+						/**
+						 * grow the rectangle along u first, then along v
+						 * as long as the whole next row is covered
+						 */
+						int32 w = 1;
+						while (i + w < width && mask[j * width + i + w])
+							++w;
+
+						int32 h = 1;
+						for (; j + h < height; ++h)
+						{
+							bool row = true;
+							for (int32 k = 0; k < w && row; ++k)
+								row = mask[(j + h) * width + i + k];
+							if (!row)
+								break;
+						}
+
+						for (int32 y = 0; y < h; ++y)
+							for (int32 x = 0; x < w; ++x)
+								mask[(j + y) * width + i + x] = false;
+
+						const double u0 = (i + offset[u] - 0.5) * side_length;
+						const double u1 = (i + w + offset[u] - 0.5) * side_length;
+						const double v0 = (j + offset[v] - 0.5) * side_length;
+						const double v1 = (j + h + offset[v] - 0.5) * side_length;
+
+						const int32 base = out.vertices.Num();
+						const double corners[4][2] = { { u0, v0 }, { u1, v0 }, { u1, v1 }, { u0, v1 } };
+						for (const auto& c : corners)
+						{
+							FVector corner;
+							corner[d] = plane;
+							corner[u] = c[0];
+							corner[v] = c[1];
+							out.vertices.Add(corner);
+							out.normals.Add(normal);
+						}
+
+						/**
+						 * unreal treats clockwise triangles as front facing,
+						 * the corners run counter clockwise around +d
+						 */
+						if (sign > 0)
+							out.triangles.Append({ base, base + 2, base + 1, base, base + 3, base + 2 });
+						else
+							out.triangles.Append({ base, base + 1, base + 2, base, base + 2, base + 3 });
+
+						i += w;
+					}
+				}
+			}
+		}
+	}
+
+	return true;
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * @struct voxel_surface
+ * triangle mesh in the layout of UProceduralMeshComponent
+ */
+struct voxel_surface
+{
+	TArray<FVector> vertices;
+	TArray<int32> triangles;
+	TArray<FVector> normals;
+
+	void reset()
+	{
+		vertices.Reset();
+		triangles.Reset();
+		normals.Reset();
+	}
+};
+
+/**
+ * @class voxel_mesher
+ *
+ * surface of a voxel set as a single mesh, only faces between an occupied
+ * and a free voxel are kept and coplanar neighbouring faces are merged
+ * into rectangles by greedy meshing
+ *
+ * a voxel with index i is the cube of side_length centered at i * side_length
+ * like the instances of the cube mesh
+ */
+class voxel_mesher final
+{
+public:
+
+	/**
+	 * upper bound of the cells of the bounding box of the voxels
+	 */
+	inline static constexpr int64 max_cells = int64(1) << 27;
+
+	/**
+	 * @returns false if the bounding box of voxels exceeds @ref{max_cells}
+	 */
+	bool build(TArrayView<const FIntVector> voxels, float side_length, voxel_surface& out);
+
+private:
+
+	bool occupied(int32 x, int32 y, int32 z) const
+	{
+		const int64 cell = (static_cast<int64>(z) * size.Y + y) * size.X + x;
+		return (occupancy[cell >> 6] >> (cell & 63)) & 1;
+	}
+
+	/**
+	 * bit per cell of the bounding box grown by one free cell per side
+	 */
+	TArray<uint64> occupancy;
+	FIntVector size;
+
+	/**
+	 * faces of the current slice, merged faces are cleared
+	 */
+	TArray<bool> mask;
+};